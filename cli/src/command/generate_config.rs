@@ -173,6 +173,7 @@ impl ExonumCommand for GenerateConfig {
             mempool: MemoryPoolConfig::default(),
             database: DbOptions::default(),
             thread_pool_size: None,
+            pruning: None,
             connect_list: ConnectListConfig::default(),
             consensus_public_key: keys.consensus_pk(),
         };
@@ -14,12 +14,16 @@
 
 //! Standard Exonum CLI command used to perform different maintenance actions.
 
-use anyhow::Error;
-use exonum::merkledb::{migration::rollback_migration, Database, RocksDB};
+use anyhow::{ensure, Error};
+use exonum::blockchain::Schema;
+use exonum::merkledb::{migration::rollback_migration, Database, RocksDB, Snapshot, SystemSchema};
 use exonum::runtime::remove_local_migration_result;
 use exonum_node::helpers::clear_consensus_messages_cache;
 use serde_derive::{Deserialize, Serialize};
-use std::path::{Path, PathBuf};
+use std::{
+    fs,
+    path::{Path, PathBuf},
+};
 use structopt::StructOpt;
 
 use crate::{
@@ -59,6 +63,15 @@ pub enum MaintenanceAction {
         /// Name of the service for migration restart, e.g. "explorer" or "my-service".
         service_name: String,
     },
+
+    /// Create a checkpoint of the node database which can be used to bootstrap another node
+    /// without replaying the whole blockchain.
+    #[structopt(name = "create-checkpoint")]
+    CreateCheckpoint {
+        /// Path to a directory to store the checkpoint in. The directory must not exist.
+        /// The checkpoint is removed if its state does not match the latest block.
+        checkpoint_path: PathBuf,
+    },
 }
 
 impl MaintenanceAction {
@@ -91,6 +104,51 @@ impl MaintenanceAction {
 
         Ok(())
     }
+
+    fn create_checkpoint(
+        node_config: &Path,
+        db_path: &Path,
+        checkpoint_path: &Path,
+    ) -> Result<(), Error> {
+        let node_config: NodeConfig = load_config_file(node_config)?;
+        let db_options = &node_config.private_config.database;
+        RocksDB::open(db_path, db_options)?.create_checkpoint(checkpoint_path)?;
+
+        let checkpoint = RocksDB::open(checkpoint_path, db_options)?;
+        if let Err(err) = Self::verify_state_hash(checkpoint.snapshot().as_ref()) {
+            // An inconsistent checkpoint must not be used to bootstrap nodes.
+            drop(checkpoint);
+            fs::remove_dir_all(checkpoint_path)?;
+            return Err(err);
+        }
+        // Consensus messages are specific for the node the checkpoint was taken from.
+        let fork = checkpoint.fork();
+        clear_consensus_messages_cache(&fork);
+        checkpoint.merge_sync(fork.into_patch())?;
+        Ok(())
+    }
+
+    /// Checks that the aggregated state of the database matches the `state_hash`
+    /// of the latest committed block.
+    fn verify_state_hash(snapshot: &dyn Snapshot) -> Result<(), Error> {
+        let schema = Schema::new(snapshot);
+        if schema.block_hashes_by_height().is_empty() {
+            // The blockchain is not initialized yet, there is nothing to verify.
+            return Ok(());
+        }
+
+        let last_block = schema.last_block();
+        let state_hash = SystemSchema::new(snapshot).state_hash();
+        ensure!(
+            state_hash == last_block.state_hash,
+            "State hash of the checkpoint ({:?}) does not match the state hash of the block \
+             at height {} ({:?})",
+            state_hash,
+            last_block.height,
+            last_block.state_hash
+        );
+        Ok(())
+    }
 }
 
 impl ExonumCommand for Maintenance {
@@ -106,6 +164,13 @@ impl ExonumCommand for Maintenance {
                     service_name,
                 )?
             }
+            MaintenanceAction::CreateCheckpoint {
+                ref checkpoint_path,
+            } => MaintenanceAction::create_checkpoint(
+                &self.node_config,
+                &self.db_path,
+                checkpoint_path,
+            )?,
         }
 
         Ok(StandardResult::Maintenance {
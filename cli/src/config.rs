@@ -21,7 +21,7 @@ use exonum::{
 };
 use exonum_node::{
     ConnectListConfig, MemoryPoolConfig, NetworkConfiguration, NodeApiConfig,
-    NodeConfig as CoreNodeConfig,
+    NodeConfig as CoreNodeConfig, PruningConfig,
 };
 use exonum_supervisor::mode::Mode as SupervisorMode;
 use serde_derive::{Deserialize, Serialize};
@@ -74,6 +74,9 @@ pub struct NodePrivateConfig {
     pub database: DbOptions,
     /// Amount of threads used for transactions verification.
     pub thread_pool_size: Option<u8>,
+    /// Optional historical data pruning configuration.
+    #[serde(default)]
+    pub pruning: Option<PruningConfig>,
     /// Information about peers within network.
     pub connect_list: ConnectListConfig,
     /// Consensus public key of the node.
@@ -100,6 +103,7 @@ impl Into<CoreNodeConfig> for NodeConfig {
             mempool: self.private_config.mempool,
             connect_list: self.private_config.connect_list,
             thread_pool_size: self.private_config.thread_pool_size,
+            pruning: self.private_config.pruning,
         }
     }
 }
@@ -104,6 +104,7 @@ mod tests {
                 mempool: MemoryPoolConfig::default(),
                 database: DbOptions::default(),
                 thread_pool_size: None,
+                pruning: None,
                 connect_list: ConnectListConfig::default(),
                 consensus_public_key: KeyPair::random().public_key(),
             },
@@ -45,8 +45,9 @@
 //!
 //! - `run-dev` command automatically generates network configuration with a single node and runs
 //!   it. This command can be useful for fast testing of the services during development process.
-//! - `maintenance` command allows to clear node's consensus messages with `clear-cache`, and
-//!   restart node's service migration script with `restart-migration`.
+//! - `maintenance` command allows to clear node's consensus messages with `clear-cache`,
+//!   restart node's service migration script with `restart-migration`, and create
+//!   a verified checkpoint of the node database with `create-checkpoint`.
 //!
 //! ## How to Extend Parameters
 //!
@@ -150,7 +151,7 @@ use exonum_system_api::SystemApiPlugin;
 use structopt::StructOpt;
 use tempfile::TempDir;
 
-use std::{env, ffi::OsString, iter, path::PathBuf};
+use std::{env, ffi::OsString, iter, path::PathBuf, time::Instant};
 
 use crate::command::{Command, ExonumCommand, NodeRunConfig, StandardResult};
 
@@ -264,7 +265,9 @@ impl NodeBuilder {
 
             let genesis_config = Self::genesis_config(&run_config, self.genesis_config);
             let db_options = &run_config.node_config.private_config.database;
+            let start = Instant::now();
             let database = RocksDB::open(run_config.db_path, db_options)?;
+            let database_open_time = start.elapsed();
 
             let node_config_path = run_config.node_config_path.to_string_lossy();
             let config_manager = DefaultConfigManager::new(node_config_path.into_owned());
@@ -277,6 +280,7 @@ impl NodeBuilder {
                 .with_genesis_config(genesis_config)
                 .with_config_manager(config_manager)
                 .with_plugin(SystemApiPlugin)
+                .with_database_open_time(database_open_time)
                 .with_runtime_fn(|channel| rust_runtime.build(channel.endpoints_sender()));
             for runtime in self.external_runtimes {
                 node_builder = node_builder.with_runtime(runtime);
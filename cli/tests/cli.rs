@@ -14,7 +14,16 @@
 
 // This is a regression test for exonum configuration.
 
-use exonum::{blockchain::ValidatorKeys, crypto::KeyPair};
+use exonum::{
+    blockchain::{
+        config::GenesisConfigBuilder, ApiSender, BlockParams, Blockchain, BlockchainBuilder,
+        ConsensusConfig, Schema, ValidatorKeys,
+    },
+    crypto::KeyPair,
+    helpers::{Height, ValidatorId},
+    merkledb::{access::CopyAccessExt, Database, DbOptions, RocksDB},
+};
+use exonum_rust_runtime::RustRuntime;
 use exonum_supervisor::mode::Mode as SupervisorMode;
 use pretty_assertions::assert_eq;
 use structopt::StructOpt;
@@ -603,6 +612,85 @@ fn test_restart_migration() {
         .unwrap();
 }
 
+#[test]
+fn test_create_checkpoint() {
+    let env = ConfigSpec::new_without_pass();
+    let db_path = env.output_dir().join("db0");
+    let checkpoint_path = env.output_dir().join("checkpoint0");
+
+    env.command("maintenance")
+        .with_named_arg("--node-config", &env.expected_node_config_file(0))
+        .with_named_arg("--db-path", &db_path)
+        .with_named_arg("create-checkpoint", &checkpoint_path)
+        .run()
+        .unwrap();
+    assert!(checkpoint_path.exists());
+}
+
+/// Creates a database with the genesis block and the specified number of empty blocks.
+fn create_db_with_blocks(db_path: &Path, block_count: u64) {
+    let db = RocksDB::open(db_path, &DbOptions::default()).unwrap();
+    let (config, node_keys) = ConsensusConfig::for_tests(1);
+    let blockchain = Blockchain::new(db, node_keys.service, ApiSender::closed());
+    let genesis_config = GenesisConfigBuilder::with_consensus_config(config).build();
+    let mut blockchain = BlockchainBuilder::new(blockchain)
+        .with_genesis_config(genesis_config)
+        .with_runtime(RustRuntime::builder().build_for_tests())
+        .build();
+
+    for height in 1..=block_count {
+        let block_params = BlockParams::new(ValidatorId(0), Height(height), &[]);
+        let patch = blockchain.create_patch(block_params, &());
+        blockchain.commit(patch, vec![]).unwrap();
+    }
+}
+
+#[test]
+fn test_create_checkpoint_with_blocks() {
+    let env = ConfigSpec::new_without_pass();
+    let db_path = env.output_dir().join("db0");
+    let checkpoint_path = env.output_dir().join("checkpoint0");
+    create_db_with_blocks(&db_path, 3);
+
+    env.command("maintenance")
+        .with_named_arg("--node-config", &env.expected_node_config_file(0))
+        .with_named_arg("--db-path", &db_path)
+        .with_named_arg("create-checkpoint", &checkpoint_path)
+        .run()
+        .unwrap();
+
+    let checkpoint = RocksDB::open(&checkpoint_path, &DbOptions::default()).unwrap();
+    let snapshot = checkpoint.snapshot();
+    assert_eq!(Schema::new(snapshot.as_ref()).height(), Height(3));
+}
+
+#[test]
+fn test_create_checkpoint_with_mismatched_state_hash() {
+    let env = ConfigSpec::new_without_pass();
+    let db_path = env.output_dir().join("db0");
+    let checkpoint_path = env.output_dir().join("checkpoint0");
+    create_db_with_blocks(&db_path, 3);
+
+    // Change the aggregated state without committing a block.
+    let db = RocksDB::open(&db_path, &DbOptions::default()).unwrap();
+    let fork = db.fork();
+    fork.get_proof_entry("test.value").set(1_u64);
+    db.merge_sync(fork.into_patch()).unwrap();
+    drop(db);
+
+    let err = env
+        .command("maintenance")
+        .with_named_arg("--node-config", &env.expected_node_config_file(0))
+        .with_named_arg("--db-path", &db_path)
+        .with_named_arg("create-checkpoint", &checkpoint_path)
+        .run()
+        .unwrap_err();
+    assert!(err
+        .to_string()
+        .contains("does not match the state hash of the block at height 3"));
+    assert!(!checkpoint_path.exists());
+}
+
 #[test]
 fn run_node_with_simple_supervisor() {
     run_node_with_supervisor(&SupervisorMode::Simple).unwrap();
@@ -626,6 +714,7 @@ fn different_supervisor_modes_in_public_configs() -> anyhow::Result<()> {
         mempool: Default::default(),
         database: Default::default(),
         thread_pool_size: None,
+        pruning: None,
         connect_list: Default::default(),
         consensus_public_key: KeyPair::random().public_key(),
     };
@@ -77,38 +77,49 @@ pub struct BlockInfo {
     #[serde(skip_serializing_if = "Option::is_none")]
     pub precommits: Option<Vec<Verified<Precommit>>>,
 
-    /// Info of transactions in the block.
+    /// Info of transactions in the block. Not present if the block is pruned.
     #[serde(skip_serializing_if = "Option::is_none")]
     pub txs: Option<Vec<TxInfo>>,
 
     /// Median time from the block precommits.
     #[serde(skip_serializing_if = "Option::is_none")]
     pub time: Option<DateTime<Utc>>,
+
+    /// Whether transactions and precommits of the block have been pruned by the node.
+    #[serde(default, skip_serializing_if = "std::ops::Not::not")]
+    pub pruned: bool,
 }
 
 impl From<crate::BlockInfo<'_>> for BlockInfo {
     fn from(inner: crate::BlockInfo<'_>) -> Self {
+        let pruned = inner.is_pruned();
+        let txs = if pruned {
+            None
+        } else {
+            let txs = inner
+                .transaction_hashes()
+                .iter()
+                .enumerate()
+                .map(|(idx, &tx_hash)| TxInfo {
+                    tx_hash,
+                    call_info: inner
+                        .transaction(idx)
+                        .unwrap()
+                        .message()
+                        .payload()
+                        .call_info
+                        .clone(),
+                })
+                .collect();
+            Some(txs)
+        };
+
         Self {
             block: inner.header().clone(),
             precommits: Some(inner.precommits().to_vec()),
-            txs: Some(
-                inner
-                    .transaction_hashes()
-                    .iter()
-                    .enumerate()
-                    .map(|(idx, &tx_hash)| TxInfo {
-                        tx_hash,
-                        call_info: inner
-                            .transaction(idx)
-                            .unwrap()
-                            .message()
-                            .payload()
-                            .call_info
-                            .clone(),
-                    })
-                    .collect(),
-            ),
+            txs,
             time: Some(median_precommits_time(&inner.precommits())),
+            pruned,
         }
     }
 }
@@ -132,6 +143,7 @@ impl BlockInfo {
                 None
             },
 
+            pruned: block.is_pruned(),
             block: block.into_header(),
         }
     }
@@ -169,6 +181,22 @@ pub struct BlocksQuery {
     pub add_precommits: bool,
 }
 
+/// Parameters of the bulk export of blocks.
+#[derive(Debug, Clone, Serialize, Deserialize, PartialEq, Default)]
+#[non_exhaustive]
+pub struct BlocksExportQuery {
+    /// The minimum height of the exported blocks. The default value is `Height(0)`
+    /// (the genesis block). Blocks with the pruned transactions are never exported.
+    pub earliest: Option<Height>,
+    /// The maximum height of the exported blocks. The default value is the height
+    /// of the latest block in the blockchain.
+    pub latest: Option<Height>,
+    /// If true, then each exported transaction contains a proof of its inclusion
+    /// into the block. The default value is false.
+    #[serde(default)]
+    pub with_proofs: bool,
+}
+
 /// Block query parameters.
 #[derive(Debug, Clone, Serialize, Deserialize, PartialEq)]
 #[non_exhaustive]
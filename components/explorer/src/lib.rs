@@ -156,6 +156,12 @@ impl<'a> BlockInfo<'a> {
         self.len() == 0
     }
 
+    /// Checks if the transactions and precommits of this block have been pruned by the node.
+    /// Transaction hashes and call errors are retained for pruned blocks.
+    pub fn is_pruned(&self) -> bool {
+        self.explorer.is_pruned(self.header.height)
+    }
+
     /// Returns a list of precommits for this block.
     pub fn precommits(&self) -> Ref<'_, [Verified<Precommit>]> {
         if self.precommits.borrow().is_none() {
@@ -178,11 +184,12 @@ impl<'a> BlockInfo<'a> {
         Ref::map(self.txs.borrow(), |cache| cache.as_ref().unwrap().as_ref())
     }
 
-    /// Returns a transaction with the specified index in the block.
+    /// Returns a transaction with the specified index in the block, or `None` if there
+    /// is no such transaction or the block [is pruned](#method.is_pruned).
     pub fn transaction(&self, index: usize) -> Option<CommittedTransaction> {
         self.transaction_hashes()
             .get(index)
-            .map(|hash| self.explorer.committed_transaction(hash, None))
+            .and_then(|hash| self.explorer.committed_transaction(hash, None))
     }
 
     /// Returns the proof for the execution status of a call within this block.
@@ -208,20 +215,27 @@ impl<'a> BlockInfo<'a> {
         }
     }
 
-    /// Loads transactions, errors and precommits for the block.
+    /// Loads transactions, errors and precommits for the block. If the block
+    /// [is pruned](#method.is_pruned), the returned block has no transactions and
+    /// its `pruned` flag is set.
     pub fn with_transactions(self) -> BlockWithTransactions {
+        let pruned = self.is_pruned();
         let (explorer, header, precommits, transactions) =
             (self.explorer, self.header, self.precommits, self.txs);
 
         let precommits = precommits
             .into_inner()
             .unwrap_or_else(|| explorer.precommits(&header));
-        let transactions = transactions
-            .into_inner()
-            .unwrap_or_else(|| explorer.transaction_hashes(&header))
-            .iter()
-            .map(|tx_hash| explorer.committed_transaction(tx_hash, None))
-            .collect();
+        let transactions = if pruned {
+            vec![]
+        } else {
+            transactions
+                .into_inner()
+                .unwrap_or_else(|| explorer.transaction_hashes(&header))
+                .iter()
+                .map(|tx_hash| explorer.stored_transaction(tx_hash))
+                .collect()
+        };
         let errors = self
             .explorer
             .schema
@@ -237,6 +251,7 @@ impl<'a> BlockInfo<'a> {
             precommits,
             transactions,
             errors,
+            pruned,
         }
     }
 }
@@ -293,10 +308,47 @@ pub struct BlockWithTransactions {
     pub header: Block,
     /// Precommits.
     pub precommits: Vec<Verified<Precommit>>,
-    /// Transactions in the order they appear in the block.
+    /// Transactions in the order they appear in the block. Empty if the block is pruned.
     pub transactions: Vec<CommittedTransaction>,
-    /// Errors that have occurred within the block.
+    /// Errors that have occurred within the block. Errors are retained for pruned blocks;
+    /// their locations refer to the transaction hashes recorded in the block.
     pub errors: Vec<ErrorWithLocation>,
+    /// Whether transactions and precommits of the block have been pruned by the node.
+    #[serde(default, skip_serializing_if = "std::ops::Not::not")]
+    pub pruned: bool,
+}
+
+/// Block together with its transactions prepared for the bulk export of the blockchain.
+///
+/// Unlike [`BlockWithTransactions`], exported transactions do not contain their locations
+/// and commit time, which can be restored from the block, and proofs of their inclusion
+/// into the block are only built on request. This makes the export considerably cheaper.
+///
+/// [`BlockWithTransactions`]: struct.BlockWithTransactions.html
+#[derive(Debug, Serialize, Deserialize)]
+#[non_exhaustive]
+pub struct ExportedBlock {
+    /// Block header as recorded in the blockchain.
+    #[serde(rename = "block")]
+    pub header: Block,
+    /// Precommits.
+    pub precommits: Vec<Verified<Precommit>>,
+    /// Transactions in the order they appear in the block.
+    pub transactions: Vec<ExportedTransaction>,
+}
+
+/// Transaction exported together with its block.
+#[derive(Debug, Serialize, Deserialize)]
+#[non_exhaustive]
+pub struct ExportedTransaction {
+    /// Transaction message.
+    pub message: Verified<AnyTx>,
+    /// Status of the transaction execution.
+    pub status: ExecutionStatus,
+    /// Proof of the transaction inclusion into the block. Present only if proofs
+    /// were requested.
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub location_proof: Option<ListProof<Hash>>,
 }
 
 /// Execution error together with its location within the block.
@@ -627,7 +679,7 @@ impl<'a> BlockchainExplorer<'a> {
             return Some(TransactionInfo::InPool { message });
         }
 
-        let tx = self.committed_transaction(tx_hash, Some(message));
+        let tx = self.committed_transaction(tx_hash, Some(message))?;
         Some(TransactionInfo::Committed(tx))
     }
 
@@ -665,12 +717,17 @@ impl<'a> BlockchainExplorer<'a> {
         tx_hashes_table.iter().collect()
     }
 
-    /// Retrieves a transaction that is known to be committed.
+    /// Retrieves a transaction that is known to be committed. Returns `None` if the content
+    /// of the transaction has been pruned.
     fn committed_transaction(
         &self,
         tx_hash: &Hash,
         maybe_content: Option<Verified<AnyTx>>,
-    ) -> CommittedTransaction {
+    ) -> Option<CommittedTransaction> {
+        let message = match maybe_content {
+            Some(message) => message,
+            None => self.schema.transactions().get(tx_hash)?,
+        };
         let location = self
             .schema
             .transactions_locations()
@@ -691,18 +748,24 @@ impl<'a> BlockchainExplorer<'a> {
         // Unwrap is OK here, because we already know that transaction is committed.
         let status = self.schema.transaction_result(location).unwrap();
 
-        CommittedTransaction {
-            message: maybe_content.unwrap_or_else(|| {
-                self.schema
-                    .transactions()
-                    .get(tx_hash)
-                    .expect("BUG: Cannot find transaction in database")
-            }),
+        Some(CommittedTransaction {
+            message,
             location,
             location_proof,
             status: ExecutionStatus(status),
             time,
-        }
+        })
+    }
+
+    /// Retrieves a committed transaction of a block which is not pruned.
+    fn stored_transaction(&self, tx_hash: &Hash) -> CommittedTransaction {
+        self.committed_transaction(tx_hash, None)
+            .expect("BUG: Cannot find transaction in database")
+    }
+
+    /// Checks if transactions of the block at the specified height have been pruned.
+    fn is_pruned(&self, height: Height) -> bool {
+        height < self.schema.first_retained_height()
     }
 
     /// Return the height of the blockchain.
@@ -720,26 +783,90 @@ impl<'a> BlockchainExplorer<'a> {
     }
 
     /// Return a block together with its transactions at the specified height, or `None`
-    /// if there is no such block.
+    /// if there is no such block. If the block is pruned, the returned block has
+    /// no transactions and its `pruned` flag is set.
     pub fn block_with_txs(&self, height: Height) -> Option<BlockWithTransactions> {
         let txs_table = self.schema.block_transactions(height);
         let block_proof = self.schema.block_and_precommits(height)?;
         let errors = self.schema.call_records(height)?;
+        let pruned = self.is_pruned(height);
 
+        let transactions = if pruned {
+            vec![]
+        } else {
+            txs_table
+                .iter()
+                .map(|tx_hash| self.stored_transaction(&tx_hash))
+                .collect()
+        };
         Some(BlockWithTransactions {
             header: block_proof.block,
             precommits: block_proof.precommits,
-            transactions: txs_table
-                .iter()
-                .map(|tx_hash| self.committed_transaction(&tx_hash, None))
-                .collect(),
+            transactions,
             errors: errors
                 .errors()
                 .map(|(location, error)| ErrorWithLocation { location, error })
                 .collect(),
+            pruned,
         })
     }
 
+    /// Returns a block together with its transactions prepared for the bulk export,
+    /// or `None` if there is no such block or its transactions have been pruned.
+    /// Proofs of transaction inclusion into the block are built only if `with_proofs` is set.
+    pub fn export_block(&self, height: Height, with_proofs: bool) -> Option<ExportedBlock> {
+        if self.is_pruned(height) {
+            return None;
+        }
+        let block_proof = self.schema.block_and_precommits(height)?;
+        let call_records = self.schema.call_records(height)?;
+        let tx_hashes = self.schema.block_transactions(height);
+        let transactions = self.schema.transactions();
+
+        let transactions = tx_hashes
+            .iter()
+            .enumerate()
+            .map(|(position, tx_hash)| {
+                let location_proof = if with_proofs {
+                    Some(tx_hashes.get_proof(position as u64))
+                } else {
+                    None
+                };
+                let status = call_records.get(CallInBlock::transaction(position as u32));
+                ExportedTransaction {
+                    message: transactions
+                        .get(&tx_hash)
+                        .expect("BUG: Cannot find transaction in database"),
+                    status: ExecutionStatus(status),
+                    location_proof,
+                }
+            })
+            .collect();
+
+        Some(ExportedBlock {
+            header: block_proof.block,
+            precommits: block_proof.precommits,
+            transactions,
+        })
+    }
+
+    /// Iterates over blocks together with their transactions prepared for the bulk export.
+    /// See [`export_block`] for details.
+    ///
+    /// All blocks are read from the snapshot of the explorer, so the exported data
+    /// is consistent even if new blocks are committed during the export. Blocks with
+    /// the pruned transactions are skipped.
+    ///
+    /// [`export_block`]: #method.export_block
+    pub fn export_blocks<R: RangeBounds<Height>>(
+        &self,
+        heights: R,
+        with_proofs: bool,
+    ) -> impl Iterator<Item = ExportedBlock> + '_ {
+        self.blocks(heights)
+            .filter_map(move |block| self.export_block(block.height(), with_proofs))
+    }
+
     /// Iterates over blocks in the blockchain.
     pub fn blocks<R: RangeBounds<Height>>(&self, heights: R) -> Blocks<'_> {
         use std::cmp::max;
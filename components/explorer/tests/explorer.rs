@@ -23,7 +23,8 @@ use exonum::{
     runtime::{ErrorKind, SnapshotExt},
 };
 use exonum_explorer::{
-    BlockInfo, BlockWithTransactions, BlockchainExplorer, CommittedTransaction, TransactionInfo,
+    BlockInfo, BlockWithTransactions, BlockchainExplorer, CommittedTransaction, ExportedBlock,
+    TransactionInfo,
 };
 use serde_json::json;
 use std::iter;
@@ -492,3 +493,41 @@ fn test_block_with_transactions_roundtrip() {
     let block_copy: BlockWithTransactions = serde_json::from_value(block_json).unwrap();
     assert_eq!(block_copy[0].message(), block[0].message());
 }
+
+#[test]
+fn test_export_blocks() {
+    let mut blockchain = create_blockchain();
+    let mut tx_gen = tx_generator();
+    create_block(&mut blockchain, tx_gen.by_ref().take(3).collect());
+    create_block(&mut blockchain, vec![]);
+    create_block(&mut blockchain, tx_gen.take(2).collect());
+
+    let snapshot = blockchain.snapshot();
+    let explorer = BlockchainExplorer::new(snapshot.as_ref());
+    let blocks: Vec<_> = explorer.export_blocks(Height(1).., false).collect();
+    assert_eq!(blocks.len(), 3);
+    for exported in &blocks {
+        let block = explorer.block_with_txs(exported.header.height).unwrap();
+        assert_eq!(exported.header, block.header);
+        assert_eq!(exported.precommits, block.precommits);
+        assert_eq!(exported.transactions.len(), block.len());
+        for (exported_tx, tx) in exported.transactions.iter().zip(&block) {
+            assert_eq!(exported_tx.message, *tx.message());
+            assert_eq!(exported_tx.status.0.is_ok(), tx.status().is_ok());
+            assert!(exported_tx.location_proof.is_none());
+        }
+    }
+
+    let blocks: Vec<_> = explorer.export_blocks(Height(1)..Height(2), true).collect();
+    assert_eq!(blocks.len(), 1);
+    let block = explorer.block_with_txs(Height(1)).unwrap();
+    for (exported_tx, tx) in blocks[0].transactions.iter().zip(&block) {
+        assert_eq!(
+            exported_tx.location_proof.as_ref(),
+            Some(tx.location_proof())
+        );
+    }
+    let json = serde_json::to_value(&blocks[0]).unwrap();
+    let block_copy: ExportedBlock = serde_json::from_value(json).unwrap();
+    assert_eq!(block_copy.transactions.len(), 3);
+}
@@ -20,10 +20,16 @@ use criterion::{black_box, Bencher, Criterion};
 use rand::{rngs::StdRng, RngCore, SeedableRng};
 
 use exonum_crypto::{self, hash, Hash};
-use exonum_merkledb::{impl_object_hash_for_binary_value, BinaryKey, BinaryValue, ObjectHash};
+use exonum_merkledb::{
+    access::CopyAccessExt, impl_object_hash_for_binary_value, BinaryKey, BinaryValue, MapIndex,
+    ObjectHash,
+};
+
+use super::BenchDB;
 
 const CHUNK_SIZE: usize = 64;
 const SEED: [u8; 32] = [100; 32];
+const INDEX_SIZE: u32 = 1_000;
 
 #[derive(Debug, Clone, Copy, PartialEq)]
 struct SimpleData {
@@ -164,6 +170,13 @@ where
             );
         },
     );
+    c.bench_function(
+        &format!("encoding/{}/from_borrowed_bytes", name),
+        move |b: &mut Bencher<'_>| {
+            let bytes = f().to_bytes();
+            b.iter(|| black_box(V::from_bytes(Cow::Borrowed(&bytes)).unwrap()));
+        },
+    );
     c.bench_function(
         &format!("encoding/{}/hash", name),
         move |b: &mut Bencher<'_>| {
@@ -191,10 +204,50 @@ fn bench_binary_key_concat(b: &mut Bencher<'_>) {
     );
 }
 
+/// Compares reading values from the fork changes and from the database. Values are decoded
+/// from the borrowed bytes unless the value type needs to own them.
+fn bench_index_reads<F, V>(c: &mut Criterion, name: &str, f: F)
+where
+    F: Fn() -> V,
+    V: BinaryValue,
+{
+    let db = BenchDB::default();
+    let fork = db.fork();
+    {
+        let mut map = fork.get_map(name);
+        for i in 0..INDEX_SIZE {
+            map.put(&i, f());
+        }
+    }
+
+    let map: MapIndex<_, u32, V> = fork.get_map(name);
+    c.bench_function(&format!("encoding/{}/fork_get", name), |b| {
+        let mut i = 0;
+        b.iter(|| {
+            i = (i + 1) % INDEX_SIZE;
+            black_box(map.get(&i))
+        });
+    });
+    drop(map);
+    db.merge(fork.into_patch()).unwrap();
+
+    let snapshot = db.snapshot();
+    let map: MapIndex<_, u32, V> = snapshot.get_map(name);
+    c.bench_function(&format!("encoding/{}/snapshot_get", name), |b| {
+        let mut i = 0;
+        b.iter(|| {
+            i = (i + 1) % INDEX_SIZE;
+            black_box(map.get(&i))
+        });
+    });
+}
+
 pub fn bench_encoding(c: &mut Criterion) {
     exonum_crypto::init();
     bench_binary_value(c, "bytes", gen_bytes_data);
     bench_binary_value(c, "simple", gen_sample_data);
     bench_binary_value(c, "cursor", gen_cursor_data);
     c.bench_function("encoding/storage_key/concat", bench_binary_key_concat);
+    bench_index_reads(c, "bytes", gen_bytes_data);
+    bench_index_reads(c, "simple", gen_sample_data);
 }
@@ -0,0 +1,88 @@
+// Copyright 2020 The Exonum Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Benchmarks of hashing Merkle tree nodes. `HashTag` methods concatenate hashed parts
+//! on stack and hash them in one go; the `stream` benchmarks feed the same parts
+//! to `HashStream` one by one for comparison.
+
+use criterion::{black_box, BenchmarkId, Criterion, Throughput};
+use exonum_crypto::{hash, Hash, HashStream};
+use exonum_merkledb::HashTag;
+
+/// Sizes of hashed leaf values. The largest one does not fit into the stack buffer.
+const LEAF_SIZES: &[usize] = &[32, 128, 512];
+
+fn hash_stream(chunks: &[&[u8]]) -> Hash {
+    chunks
+        .iter()
+        .fold(HashStream::new(), |stream, chunk| stream.update(chunk))
+        .hash()
+}
+
+fn bench_node_hashing(c: &mut Criterion) {
+    let left = hash(&[1]);
+    let right = hash(&[2]);
+    let tag = [HashTag::ListBranchNode as u8];
+
+    let mut group = c.benchmark_group("hashing/node");
+    group.bench_function("one_shot", |b| {
+        b.iter(|| HashTag::hash_node(black_box(&left), black_box(&right)))
+    });
+    group.bench_function("stream", |b| {
+        b.iter(|| hash_stream(&[&tag, black_box(&left).as_ref(), black_box(&right).as_ref()]))
+    });
+    group.finish();
+}
+
+fn bench_list_node_hashing(c: &mut Criterion) {
+    let root = hash(&[1]);
+    let tag = [HashTag::ListNode as u8];
+    let len = 1_000_u64;
+
+    let mut group = c.benchmark_group("hashing/list_node");
+    group.bench_function("one_shot", |b| {
+        b.iter(|| HashTag::hash_list_node(black_box(len), black_box(root)))
+    });
+    group.bench_function("stream", |b| {
+        b.iter(|| {
+            let len_bytes = black_box(len).to_le_bytes();
+            hash_stream(&[&tag, &len_bytes, black_box(&root).as_ref()])
+        })
+    });
+    group.finish();
+}
+
+fn bench_leaf_hashing(c: &mut Criterion) {
+    let tag = [HashTag::Blob as u8];
+
+    let mut group = c.benchmark_group("hashing/leaf");
+    for &size in LEAF_SIZES {
+        let value = vec![1_u8; size];
+        group.throughput(Throughput::Bytes(size as u64));
+        group.bench_with_input(BenchmarkId::new("one_shot", size), &value, |b, value| {
+            b.iter(|| HashTag::hash_leaf(black_box(value)))
+        });
+        group.bench_with_input(BenchmarkId::new("stream", size), &value, |b, value| {
+            b.iter(|| hash_stream(&[&tag, black_box(value)]))
+        });
+    }
+    group.finish();
+}
+
+pub fn bench_hashing(c: &mut Criterion) {
+    exonum_crypto::init();
+    bench_node_hashing(c);
+    bench_list_node_hashing(c);
+    bench_leaf_hashing(c);
+}
@@ -16,6 +16,7 @@ use exonum_merkledb::{Database, DbOptions, Fork, Patch, Result, RocksDB, Snapsho
 use tempfile::{tempdir, TempDir};
 
 pub mod encoding;
+pub mod hashing;
 pub mod schema_patterns;
 pub mod storage;
 pub mod transactions;
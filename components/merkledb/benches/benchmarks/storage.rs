@@ -157,6 +157,45 @@ fn plain_map_index_with_family_iter(b: &mut Bencher<'_>, len: usize) {
     );
 }
 
+fn plain_map_index_dirty_fork_iter(b: &mut Bencher<'_>, len: usize) {
+    let data = generate_random_kv(len);
+    let db = BenchDB::default();
+    let fork = db.fork();
+
+    {
+        let mut table = fork.get_map(NAME);
+        for (key, value) in &data {
+            table.put(key, value.clone());
+        }
+    }
+    db.merge_sync(fork.into_patch()).unwrap();
+
+    // Every tenth stored entry is removed, and every tenth one is replaced in the fork.
+    b.iter_with_setup(
+        || {
+            let fork = db.fork();
+            {
+                let mut table = fork.get_map(NAME);
+                for (i, (key, value)) in data.iter().enumerate() {
+                    match i % 10 {
+                        0 => table.remove(key),
+                        5 => table.put(key, value[1..].to_vec()),
+                        _ => {}
+                    }
+                }
+            }
+            fork
+        },
+        |fork| {
+            let index: MapIndex<_, Hash, Vec<u8>> = fork.get_map(NAME);
+            for (key, value) in &index {
+                black_box(key);
+                black_box(value);
+            }
+        },
+    );
+}
+
 fn plain_map_index_read(b: &mut Bencher<'_>, len: usize) {
     let data = generate_random_kv(len);
     let db = BenchDB::default();
@@ -447,6 +486,11 @@ pub fn bench_storage(c: &mut Criterion) {
         "storage/plain_map_with_family/iter",
         plain_map_index_with_family_iter,
     );
+    bench_fn(
+        c,
+        "storage/plain_map/dirty_fork_iter",
+        plain_map_index_dirty_fork_iter,
+    );
     bench_fn(c, "storage/plain_map/read", plain_map_index_read);
     bench_fn(
         c,
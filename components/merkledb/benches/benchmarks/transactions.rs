@@ -115,6 +115,9 @@ const ITEM_COUNTS: &[BenchParams] = &[
 #[cfg(not(feature = "long_benchmarks"))]
 const TOTAL_TX_COUNT: u64 = 10_000;
 
+const STAGING_USERS: usize = 1_000;
+const STAGING_TX_COUNTS: &[usize] = &[100, 1_000, 10_000];
+
 #[derive(Clone, Copy, Debug)]
 struct BenchParams {
     users: usize,
@@ -273,6 +276,25 @@ fn do_bench(bencher: &mut Bencher<'_>, params: BenchParams, isolate: bool) {
     });
 }
 
+/// Executes a block, flushing the fork after each transaction as the core does, and converts
+/// the fork into a patch. The patch is not merged, so that only the staging of changes
+/// in the fork is measured.
+fn do_staging_bench(bencher: &mut Bencher<'_>, txs_in_block: usize) {
+    let blocks = gen_random_blocks(1, txs_in_block, STAGING_USERS);
+    let block = &blocks[0];
+
+    bencher.iter_with_setup(BenchDB::default, |db| {
+        let mut fork = db.fork();
+        for transaction in &block.transactions {
+            transaction.execute(&fork);
+            fork.flush();
+        }
+        Schema::new(&fork).blocks.push(block.object_hash());
+        let patch = fork.into_patch();
+        drop(patch);
+    });
+}
+
 pub fn bench_transactions(c: &mut Criterion) {
     exonum_crypto::init();
 
@@ -301,4 +323,15 @@ pub fn bench_transactions(c: &mut Criterion) {
         });
     }
     group.finish();
+
+    let mut group = c.benchmark_group("fork_staging");
+    group.sample_size(SAMPLE_SIZE);
+    for &txs_in_block in STAGING_TX_COUNTS {
+        group
+            .throughput(Throughput::Elements(txs_in_block as u64))
+            .bench_function(format!("txs = {}", txs_in_block), |bencher| {
+                do_staging_bench(bencher, txs_in_block);
+            });
+    }
+    group.finish();
 }
@@ -15,8 +15,8 @@
 use criterion::{criterion_group, criterion_main};
 
 use crate::benchmarks::{
-    encoding::bench_encoding, schema_patterns::bench_schema_patterns, storage::bench_storage,
-    transactions::bench_transactions,
+    encoding::bench_encoding, hashing::bench_hashing, schema_patterns::bench_schema_patterns,
+    storage::bench_storage, transactions::bench_transactions,
 };
 
 mod benchmarks;
@@ -25,6 +25,7 @@ criterion_group!(
     benches,
     bench_storage,
     bench_encoding,
+    bench_hashing,
     bench_schema_patterns,
     bench_transactions
 );
@@ -12,5 +12,6 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+mod read_cache;
 pub mod rocksdb;
 pub mod temporarydb;
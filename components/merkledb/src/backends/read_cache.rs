@@ -0,0 +1,336 @@
+// Copyright 2020 The Exonum Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Versioned cache of point reads shared by all snapshots of a database.
+
+use std::{
+    collections::HashMap,
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Mutex, MutexGuard,
+    },
+};
+
+use crate::ResolvedAddress;
+
+/// Approximate memory overhead of a single cache entry in addition to its key and value.
+const ENTRY_OVERHEAD: usize = 48;
+
+/// Statistics of the read cache.
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+#[non_exhaustive]
+pub struct ReadCacheStats {
+    /// Number of reads served from the cache.
+    pub hits: u64,
+    /// Number of reads served by the database.
+    pub misses: u64,
+    /// Approximate size of the cached data in bytes.
+    pub size: usize,
+}
+
+/// Cache of the values read from the database.
+///
+/// Each database state is identified by a version. A cache entry remembers the version
+/// since which its value is actual; merging a patch removes entries for all changed keys.
+/// Thus, an entry can be safely used by a snapshot if the snapshot version is not less
+/// than the entry version.
+///
+/// The cache is not locked while a patch is written to the database. Instead, the changed
+/// keys are invalidated and the version is incremented both before and after the write,
+/// and no values are cached while a write is in progress. As a result, values read
+/// by the snapshots created during the write are never cached.
+///
+/// If the cache is full, the least recently used entries are evicted.
+#[derive(Debug)]
+pub(crate) struct ReadCache {
+    inner: Mutex<ReadCacheInner>,
+    hits: AtomicU64,
+    misses: AtomicU64,
+}
+
+#[derive(Debug)]
+struct ReadCacheInner {
+    version: u64,
+    pending_writes: usize,
+    capacity: usize,
+    size: usize,
+    // Logical time of the last access to the cache, which is used to evict
+    // the least recently used entries.
+    tick: u64,
+    entries: HashMap<ResolvedAddress, HashMap<Vec<u8>, CacheEntry>>,
+}
+
+#[derive(Debug)]
+struct CacheEntry {
+    since_version: u64,
+    last_used: u64,
+    value: Option<Vec<u8>>,
+}
+
+impl CacheEntry {
+    fn size(&self, key: &[u8]) -> usize {
+        ENTRY_OVERHEAD + key.len() + self.value.as_ref().map_or(0, Vec::len)
+    }
+}
+
+impl ReadCache {
+    /// Creates a cache with the specified capacity in bytes.
+    pub fn new(capacity: usize) -> Self {
+        Self {
+            inner: Mutex::new(ReadCacheInner {
+                version: 0,
+                pending_writes: 0,
+                capacity,
+                size: 0,
+                tick: 0,
+                entries: HashMap::new(),
+            }),
+            hits: AtomicU64::new(0),
+            misses: AtomicU64::new(0),
+        }
+    }
+
+    fn lock(&self) -> MutexGuard<'_, ReadCacheInner> {
+        self.inner.lock().expect("Read cache lock is poisoned")
+    }
+
+    /// Returns the cached value for a snapshot with the specified version, or `None`
+    /// if the value is not cached.
+    #[allow(clippy::option_option)]
+    pub fn get(
+        &self,
+        version: u64,
+        address: &ResolvedAddress,
+        key: &[u8],
+    ) -> Option<Option<Vec<u8>>> {
+        let value = self.lock().get(version, address, key);
+        let counter = if value.is_some() {
+            &self.hits
+        } else {
+            &self.misses
+        };
+        counter.fetch_add(1, Ordering::Relaxed);
+        value
+    }
+
+    /// Caches a value read by a snapshot with the specified version. The value is ignored
+    /// if the database was changed after the snapshot was created.
+    pub fn insert(
+        &self,
+        version: u64,
+        address: &ResolvedAddress,
+        key: &[u8],
+        value: Option<Vec<u8>>,
+    ) {
+        self.lock().insert(version, address, key, value);
+    }
+
+    /// Returns the current database version.
+    pub fn version(&self) -> u64 {
+        self.lock().version
+    }
+
+    /// Invalidates entries for the changed keys before writing them to the database.
+    /// `finish_write()` must be called once the write is completed, successfully or not.
+    pub fn start_write(&self, changes: Vec<(ResolvedAddress, bool, Vec<Vec<u8>>)>) {
+        let mut inner = self.lock();
+        inner.invalidate(changes);
+        inner.pending_writes += 1;
+        inner.version += 1;
+    }
+
+    /// Marks a write started with `start_write()` as completed. The version is incremented
+    /// once more, so that values read by the snapshots created during the write are not cached.
+    pub fn finish_write(&self) {
+        let mut inner = self.lock();
+        inner.pending_writes -= 1;
+        inner.version += 1;
+    }
+
+    pub fn stats(&self) -> ReadCacheStats {
+        ReadCacheStats {
+            hits: self.hits.load(Ordering::Relaxed),
+            misses: self.misses.load(Ordering::Relaxed),
+            size: self.lock().size,
+        }
+    }
+}
+
+impl ReadCacheInner {
+    /// Removes entries for the changed keys.
+    fn invalidate(&mut self, changes: Vec<(ResolvedAddress, bool, Vec<Vec<u8>>)>) {
+        for (address, is_cleared, keys) in changes {
+            if is_cleared {
+                if let Some(entries) = self.entries.remove(&address) {
+                    self.size -= entries
+                        .iter()
+                        .map(|(key, entry)| entry.size(key))
+                        .sum::<usize>();
+                }
+            } else if let Some(entries) = self.entries.get_mut(&address) {
+                for key in keys {
+                    if let Some(entry) = entries.remove(&key) {
+                        self.size -= entry.size(&key);
+                    }
+                }
+            }
+        }
+    }
+
+    #[allow(clippy::option_option)]
+    fn get(
+        &mut self,
+        version: u64,
+        address: &ResolvedAddress,
+        key: &[u8],
+    ) -> Option<Option<Vec<u8>>> {
+        let entry = self.entries.get_mut(address)?.get_mut(key)?;
+        if entry.since_version <= version {
+            self.tick += 1;
+            entry.last_used = self.tick;
+            Some(entry.value.clone())
+        } else {
+            None
+        }
+    }
+
+    fn insert(
+        &mut self,
+        version: u64,
+        address: &ResolvedAddress,
+        key: &[u8],
+        value: Option<Vec<u8>>,
+    ) {
+        if version != self.version || self.pending_writes > 0 {
+            return;
+        }
+
+        self.tick += 1;
+        let entry = CacheEntry {
+            since_version: version,
+            last_used: self.tick,
+            value,
+        };
+        let entry_size = entry.size(key);
+        if entry_size > self.capacity / 4 {
+            return;
+        }
+        if self.size + entry_size > self.capacity {
+            self.evict();
+        }
+
+        let entries = self.entries.entry(address.to_owned()).or_default();
+        if let Some(old_entry) = entries.insert(key.to_vec(), entry) {
+            self.size -= old_entry.size(key);
+        }
+        self.size += entry_size;
+    }
+
+    /// Evicts the least recently used entries until a quarter of the cache capacity is freed.
+    fn evict(&mut self) {
+        let target_size = self.capacity / 4 * 3;
+        let mut usage: Vec<_> = self
+            .entries
+            .values()
+            .flat_map(HashMap::iter)
+            .map(|(key, entry)| (entry.last_used, entry.size(key)))
+            .collect();
+        usage.sort_unstable();
+
+        // Access ticks are unique, so exactly the entries used before `threshold` are evicted.
+        let mut size = self.size;
+        let mut threshold = 0;
+        for (last_used, entry_size) in usage {
+            if size <= target_size {
+                break;
+            }
+            size -= entry_size;
+            threshold = last_used + 1;
+        }
+
+        for entries in self.entries.values_mut() {
+            entries.retain(|_, entry| entry.last_used >= threshold);
+        }
+        self.entries.retain(|_, entries| !entries.is_empty());
+        self.size = size;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn entries_are_invalidated_on_merge() {
+        let cache = ReadCache::new(1_024);
+        let address = ResolvedAddress::system("foo");
+        cache.insert(0, &address, b"key", Some(vec![1]));
+        assert_eq!(cache.get(0, &address, b"key"), Some(Some(vec![1])));
+
+        // Unchanged entries are still valid for the newer versions.
+        cache.start_write(vec![(address.clone(), false, vec![b"other".to_vec()])]);
+        cache.finish_write();
+        assert_eq!(cache.version(), 2);
+        assert_eq!(cache.get(2, &address, b"key"), Some(Some(vec![1])));
+
+        cache.start_write(vec![(address.clone(), false, vec![b"key".to_vec()])]);
+        assert_eq!(cache.get(3, &address, b"key"), None);
+        // Values are not cached while the write is in progress, since it is unknown
+        // whether the reading snapshot includes the written changes.
+        cache.insert(3, &address, b"key", Some(vec![1]));
+        assert_eq!(cache.get(3, &address, b"key"), None);
+        cache.finish_write();
+        // Values read by outdated snapshots are not cached.
+        cache.insert(3, &address, b"key", Some(vec![1]));
+        assert_eq!(cache.get(4, &address, b"key"), None);
+
+        cache.insert(4, &address, b"key", Some(vec![2]));
+        // Older snapshots do not use values cached by newer ones.
+        assert_eq!(cache.get(3, &address, b"key"), None);
+        assert_eq!(cache.get(4, &address, b"key"), Some(Some(vec![2])));
+
+        cache.start_write(vec![(address.clone(), true, vec![])]);
+        cache.finish_write();
+        assert_eq!(cache.get(6, &address, b"key"), None);
+        assert_eq!(cache.stats().size, 0);
+        assert_eq!(cache.stats().hits, 3);
+    }
+
+    #[test]
+    fn cache_size_is_bounded() {
+        let cache = ReadCache::new(1_024);
+        let address = ResolvedAddress::system("foo");
+        for i in 0_u32..100 {
+            cache.insert(0, &address, &i.to_be_bytes(), Some(vec![0; 32]));
+            assert!(cache.stats().size <= 1_024);
+        }
+        // Values larger than a quarter of the cache are not cached.
+        cache.insert(0, &address, b"big", Some(vec![0; 512]));
+        assert_eq!(cache.get(0, &address, b"big"), None);
+    }
+
+    #[test]
+    fn least_recently_used_entries_are_evicted() {
+        let cache = ReadCache::new(1_024);
+        let address = ResolvedAddress::system("foo");
+        cache.insert(0, &address, b"hot", Some(vec![0; 32]));
+        for i in 0_u32..100 {
+            cache.insert(0, &address, &i.to_be_bytes(), Some(vec![0; 32]));
+            assert!(cache.get(0, &address, b"hot").is_some());
+        }
+        // The recently inserted entries are retained as well.
+        assert!(cache.get(0, &address, &99_u32.to_be_bytes()).is_some());
+        assert!(cache.get(0, &address, &0_u32.to_be_bytes()).is_none());
+    }
+}
@@ -16,13 +16,17 @@
 
 pub use rocksdb::{BlockBasedOptions as RocksBlockOptions, WriteOptions as RocksDBWriteOptions};
 
+pub use super::read_cache::ReadCacheStats;
+
 use crossbeam::sync::{ShardedLock, ShardedLockReadGuard};
 use rocksdb::{
-    self, checkpoint::Checkpoint, ColumnFamily, DBIterator, Options as RocksDbOptions, WriteBatch,
+    self, checkpoint::Checkpoint, ColumnFamily, ColumnFamilyDescriptor, DBRawIterator,
+    Options as RocksDbOptions, ReadOptions, WriteBatch,
 };
 use smallvec::SmallVec;
-use std::{fmt, iter::Peekable, mem, path::Path, sync::Arc};
+use std::{borrow::Cow, fmt, mem, path::Path, sync::Arc};
 
+use super::read_cache::ReadCache;
 use crate::{
     db::{check_database, Change},
     Database, DbOptions, Iter, Iterator, Patch, ResolvedAddress, Snapshot,
@@ -40,7 +44,10 @@ pub const ID_SIZE: usize = mem::size_of::<u64>();
 /// use different databases.
 pub struct RocksDB {
     db: Arc<ShardedLock<rocksdb::DB>>,
-    options: DbOptions,
+    // Options shared by all column families. The options are created once, so that
+    // the column families share the block cache.
+    options: RocksDbOptions,
+    read_cache: Option<Arc<ReadCache>>,
 }
 
 impl From<DbOptions> for RocksDbOptions {
@@ -56,6 +63,23 @@ impl From<&DbOptions> for RocksDbOptions {
         defaults.set_compression_type(opts.compression_type.into());
         defaults.set_max_open_files(opts.max_open_files.unwrap_or(-1));
         defaults.set_max_total_wal_size(opts.max_total_wal_size.unwrap_or(0));
+        if let Some(size) = opts.write_buffer_size {
+            defaults.set_write_buffer_size(size);
+        }
+        if let Some(style) = opts.compaction_style {
+            defaults.set_compaction_style(style.into());
+        }
+
+        if opts.block_cache_size.is_some() || opts.bloom_filter_bits.is_some() {
+            let mut block_opts = RocksBlockOptions::default();
+            if let Some(size) = opts.block_cache_size {
+                block_opts.set_lru_cache(size);
+            }
+            if let Some(bits) = opts.bloom_filter_bits {
+                block_opts.set_bloom_filter(bits, false);
+            }
+            defaults.set_block_based_table_factory(&block_opts);
+        }
         defaults
     }
 }
@@ -64,15 +88,19 @@ impl From<&DbOptions> for RocksDbOptions {
 pub struct RocksDBSnapshot {
     snapshot: rocksdb::Snapshot<'static>,
     db: Arc<ShardedLock<rocksdb::DB>>,
+    // Read cache together with the database version this snapshot corresponds to.
+    read_cache: Option<(Arc<ReadCache>, u64)>,
 }
 
 /// An iterator over the entries of a `RocksDB`.
+///
+/// The iterator reads keys and values directly from the `RocksDB` iterator without copying them.
+/// To keep the entry returned by `next()` valid until the following call, advancing
+/// the underlying iterator is deferred until the next entry is requested.
 struct RocksDBIterator<'a> {
-    iter: Peekable<DBIterator<'a>>,
-    key: Option<Box<[u8]>>,
-    value: Option<Box<[u8]>>,
-    prefix: Option<[u8; ID_SIZE]>,
-    ended: bool,
+    iter: Option<DBRawIterator<'a>>,
+    prefix_len: usize,
+    advance: bool,
 }
 
 impl RocksDB {
@@ -82,17 +110,25 @@ impl RocksDB {
     /// `create_if_missing` is switched on in `DbOptions`, a new database will
     /// be created at the indicated path.
     pub fn open<P: AsRef<Path>>(path: P, options: &DbOptions) -> crate::Result<Self> {
+        let rocksdb_options = RocksDbOptions::from(options);
         let inner = {
             if let Ok(names) = rocksdb::DB::list_cf(&RocksDbOptions::default(), &path) {
-                let cf_names = names.iter().map(String::as_str).collect::<Vec<_>>();
-                rocksdb::DB::open_cf(&options.into(), path, cf_names)?
+                // Existing column families are opened with the same options as the new ones;
+                // otherwise, RocksDB would use the default options for them.
+                let descriptors = names
+                    .into_iter()
+                    .map(|name| ColumnFamilyDescriptor::new(name, rocksdb_options.clone()));
+                rocksdb::DB::open_cf_descriptors(&rocksdb_options, path, descriptors)?
             } else {
-                rocksdb::DB::open(&options.into(), path)?
+                rocksdb::DB::open(&rocksdb_options, path)?
             }
         };
         let mut db = Self {
             db: Arc::new(ShardedLock::new(inner)),
-            options: *options,
+            options: rocksdb_options,
+            read_cache: options
+                .read_cache_size
+                .map(|size| Arc::new(ReadCache::new(size))),
         };
         check_database(&mut db)?;
         Ok(db)
@@ -110,6 +146,12 @@ impl RocksDB {
         Ok(())
     }
 
+    /// Returns statistics of the read cache, or `None` if the cache is disabled
+    /// (see `DbOptions::read_cache_size`).
+    pub fn read_cache_stats(&self) -> Option<ReadCacheStats> {
+        self.read_cache.as_ref().map(|cache| cache.stats())
+    }
+
     fn cf_exists(&self, cf_name: &str) -> bool {
         self.get_lock_guard().cf_handle(cf_name).is_some()
     }
@@ -118,7 +160,7 @@ impl RocksDB {
         self.db
             .write()
             .expect("Couldn't get write lock to DB")
-            .create_cf(cf_name, &self.options.into())
+            .create_cf(cf_name, &self.options)
             .map_err(Into::into)
     }
 
@@ -153,6 +195,7 @@ impl RocksDB {
 
     fn do_merge(&self, patch: Patch, w_opts: &RocksDBWriteOptions) -> crate::Result<()> {
         let mut batch = WriteBatch::default();
+        let mut changed_keys = vec![];
         for (resolved, changes) in patch.into_changes() {
             if !self.cf_exists(&resolved.name) {
                 self.create_cf(&resolved.name)?;
@@ -165,6 +208,11 @@ impl RocksDB {
                 self.clear_prefix(&mut batch, cf, &resolved);
             }
 
+            if self.read_cache.is_some() {
+                let keys = changes.keys().cloned().collect();
+                changed_keys.push((resolved.clone(), changes.is_cleared(), keys));
+            }
+
             if let Some(id_bytes) = resolved.id_to_bytes() {
                 // Write changes to the column family with each key prefixed by the ID of the
                 // resolved address.
@@ -193,9 +241,18 @@ impl RocksDB {
             }
         }
 
-        self.get_lock_guard()
-            .write_opt(batch, w_opts)
-            .map_err(Into::into)
+        if let Some(ref read_cache) = self.read_cache {
+            // The cache is not locked during the write; instead, values read by snapshots
+            // are not cached until the write is finished.
+            read_cache.start_write(changed_keys);
+            let res = self.get_lock_guard().write_opt(batch, w_opts);
+            read_cache.finish_write();
+            res.map_err(Into::into)
+        } else {
+            self.get_lock_guard()
+                .write_opt(batch, w_opts)
+                .map_err(Into::into)
+        }
     }
 
     /// Removes all keys with the specified prefix from a column family.
@@ -211,6 +268,14 @@ impl RocksDB {
     #[allow(unsafe_code)]
     #[allow(clippy::useless_transmute)]
     pub(super) fn rocksdb_snapshot(&self) -> RocksDBSnapshot {
+        // The cache version must be retrieved before the snapshot is created: the snapshot
+        // may include changes written after this point, but the values cached since then
+        // have a greater version and are not used by the snapshot.
+        let read_cache = self
+            .read_cache
+            .as_ref()
+            .map(|cache| (Arc::clone(cache), cache.version()));
+
         RocksDBSnapshot {
             // SAFETY:
             // The snapshot carries an `Arc` to the database to make sure that database
@@ -221,6 +286,7 @@ impl RocksDB {
             // FIXME: Investigate changing `rocksdb::Snapshot` / `DB` to remove `unsafe` (ECR-4273).
             snapshot: unsafe { mem::transmute(self.get_lock_guard().snapshot()) },
             db: Arc::clone(&self.db),
+            read_cache,
         }
     }
 }
@@ -231,21 +297,27 @@ impl RocksDBSnapshot {
     }
 
     fn rocksdb_iter(&self, name: &ResolvedAddress, from: &[u8]) -> RocksDBIterator<'_> {
-        use rocksdb::{Direction, IteratorMode};
-
-        let from = name.keyed(from);
-        let iter = match self.get_lock_guard().cf_handle(&name.name) {
-            Some(cf) => self
-                .snapshot
-                .iterator_cf(cf, IteratorMode::From(from.as_ref(), Direction::Forward)),
-            None => self.snapshot.iterator(IteratorMode::Start),
-        };
+        let prefix = name.id_to_bytes();
+        let iter = self.get_lock_guard().cf_handle(&name.name).map(|cf| {
+            let mut read_opts = ReadOptions::default();
+            // Limit the iterator by the index prefix, so that `RocksDB` does not read
+            // (and skip tombstones of) the entries belonging to the following indexes.
+            // All keys following the maximum prefix belong to the same index, so it
+            // needs no bound.
+            if let Some(id_bytes) = prefix {
+                if id_bytes != [u8::max_value(); ID_SIZE] {
+                    read_opts.set_iterate_upper_bound(next_id_bytes(id_bytes).to_vec());
+                }
+            }
+            let mut iter = self.snapshot.raw_iterator_cf_opt(cf, read_opts);
+            iter.seek(name.keyed(from));
+            iter
+        });
+
         RocksDBIterator {
-            iter: iter.peekable(),
-            prefix: name.id_to_bytes(),
-            key: None,
-            value: None,
-            ended: false,
+            iter,
+            prefix_len: if prefix.is_some() { ID_SIZE } else { 0 },
+            advance: false,
         }
     }
 }
@@ -269,6 +341,52 @@ impl Database for RocksDB {
 
 impl Snapshot for RocksDBSnapshot {
     fn get(&self, resolved_addr: &ResolvedAddress, key: &[u8]) -> Option<Vec<u8>> {
+        if let Some((ref read_cache, version)) = self.read_cache {
+            if let Some(value) = read_cache.get(version, resolved_addr, key) {
+                return value;
+            }
+            let value = self.get_uncached(resolved_addr, key);
+            read_cache.insert(version, resolved_addr, key, value.clone());
+            value
+        } else {
+            self.get_uncached(resolved_addr, key)
+        }
+    }
+
+    fn read_value(
+        &self,
+        resolved_addr: &ResolvedAddress,
+        key: &[u8],
+        f: &mut dyn FnMut(Cow<'_, [u8]>),
+    ) {
+        if self.read_cache.is_some() {
+            // Cached values are owned, so there is nothing to gain from pinning.
+            if let Some(value) = self.get(resolved_addr, key) {
+                f(Cow::Owned(value));
+            }
+            return;
+        }
+
+        let db = self.get_lock_guard();
+        if let Some(cf) = db.cf_handle(&resolved_addr.name) {
+            let mut read_options = ReadOptions::default();
+            read_options.set_snapshot(&self.snapshot);
+            // The pinned value is read directly from the block cache or memtable.
+            match db.get_pinned_cf_opt(cf, resolved_addr.keyed(key), &read_options) {
+                Ok(Some(value)) => f(Cow::Borrowed(&*value)),
+                Ok(None) => {}
+                Err(e) => panic!("{}", e),
+            }
+        }
+    }
+
+    fn iter(&self, name: &ResolvedAddress, from: &[u8]) -> Iter<'_> {
+        Box::new(self.rocksdb_iter(name, from))
+    }
+}
+
+impl RocksDBSnapshot {
+    fn get_uncached(&self, resolved_addr: &ResolvedAddress, key: &[u8]) -> Option<Vec<u8>> {
         if let Some(cf) = self.get_lock_guard().cf_handle(&resolved_addr.name) {
             match self.snapshot.get_cf(cf, resolved_addr.keyed(key)) {
                 Ok(value) => value.map(|v| v.to_vec()),
@@ -278,52 +396,40 @@ impl Snapshot for RocksDBSnapshot {
             None
         }
     }
-
-    fn iter(&self, name: &ResolvedAddress, from: &[u8]) -> Iter<'_> {
-        Box::new(self.rocksdb_iter(name, from))
-    }
 }
 
-impl<'a> Iterator for RocksDBIterator<'a> {
-    fn next(&mut self) -> Option<(&[u8], &[u8])> {
-        if self.ended {
+impl RocksDBIterator<'_> {
+    fn current(&self) -> Option<(&[u8], &[u8])> {
+        let iter = self.iter.as_ref()?;
+        if !iter.valid() {
             return None;
         }
+        // The upper bound guarantees that the entry belongs to the iterated index.
+        let key = iter.key()?;
+        Some((&key[self.prefix_len..], iter.value()?))
+    }
 
-        let (key, value) = self.iter.next()?;
-        if let Some(ref prefix) = self.prefix {
-            if &key[..ID_SIZE] != prefix {
-                self.ended = true;
-                return None;
+    fn advance_if_needed(&mut self) {
+        if mem::replace(&mut self.advance, false) {
+            if let Some(iter) = self.iter.as_mut() {
+                if iter.valid() {
+                    iter.next();
+                }
             }
         }
+    }
+}
 
-        self.key = Some(key);
-        let key = if self.prefix.is_some() {
-            &self.key.as_ref()?[ID_SIZE..]
-        } else {
-            &self.key.as_ref()?[..]
-        };
-        self.value = Some(value);
-        Some((key, self.value.as_ref()?))
+impl<'a> Iterator for RocksDBIterator<'a> {
+    fn next(&mut self) -> Option<(&[u8], &[u8])> {
+        self.advance_if_needed();
+        self.advance = true;
+        self.current()
     }
 
     fn peek(&mut self) -> Option<(&[u8], &[u8])> {
-        if self.ended {
-            return None;
-        }
-
-        let (key, value) = self.iter.peek()?;
-        let key = if let Some(prefix) = self.prefix {
-            if key[..ID_SIZE] != prefix {
-                self.ended = true;
-                return None;
-            }
-            &key[ID_SIZE..]
-        } else {
-            &key[..]
-        };
-        Some((key, &value[..]))
+        self.advance_if_needed();
+        self.current()
     }
 }
 
@@ -17,28 +17,38 @@
 use crossbeam::sync::ShardedLock;
 use smallvec::SmallVec;
 use std::{
+    borrow::Cow,
     collections::{btree_map::Range, BTreeMap, HashMap},
     iter::{Iterator, Peekable},
     sync::Arc,
 };
 
 use crate::{
-    backends::rocksdb::{next_id_bytes, ID_SIZE},
+    backends::rocksdb::ID_SIZE,
     db::{check_database, Change, Iterator as DbIterator},
     Database, Iter, Patch, ResolvedAddress, Result, Snapshot,
 };
 
-type MemoryDB = HashMap<ResolvedAddress, BTreeMap<Vec<u8>, Vec<u8>>>;
-
-/// This in-memory database is only used for testing and experimenting; is not designed to
-/// operate under load in production.
+/// Contents of a single index. Collections are shared among the database and its snapshots
+/// and are copied on write only if they are still referenced by a snapshot.
+type Collection = Arc<BTreeMap<Vec<u8>, Vec<u8>>>;
+type MemoryDB = HashMap<ResolvedAddress, Collection>;
+
+/// In-memory database with cheap snapshots.
+///
+/// Data of each index is stored in a separate ordered map shared by the database and
+/// its snapshots. Taking a snapshot is a constant-time operation, and merging a patch copies
+/// only the indexes that are modified by the patch and are still referenced by live snapshots.
+///
+/// This database is mainly used for testing and experimenting; it can also be used by nodes
+/// which do not need to persist their state. It is not designed to store large amounts of data.
 #[derive(Debug)]
 pub struct TemporaryDB {
-    inner: Arc<ShardedLock<MemoryDB>>,
+    inner: Arc<ShardedLock<Arc<MemoryDB>>>,
 }
 
 struct TemporarySnapshot {
-    snapshot: MemoryDB,
+    snapshot: Arc<MemoryDB>,
 }
 
 struct TemporaryDBIterator<'a> {
@@ -52,8 +62,8 @@ impl TemporaryDB {
     pub fn new() -> Self {
         let mut db = HashMap::new();
 
-        db.insert(ResolvedAddress::system("default"), BTreeMap::new());
-        let inner = Arc::new(ShardedLock::new(db));
+        db.insert(ResolvedAddress::system("default"), Collection::default());
+        let inner = Arc::new(ShardedLock::new(Arc::new(db)));
         let mut db = Self { inner };
         check_database(&mut db).unwrap();
         db
@@ -63,8 +73,10 @@ impl TemporaryDB {
     pub fn clear(&self) -> crate::Result<()> {
         let mut rw_lock = self.inner.write().expect("Couldn't get read-write lock");
 
-        for collection in rw_lock.values_mut() {
-            collection.clear();
+        // Collections are replaced rather than cleared in place, so that the data
+        // still referenced by snapshots is not copied.
+        for collection in Arc::make_mut(&mut *rw_lock).values_mut() {
+            *collection = Collection::default();
         }
 
         Ok(())
@@ -72,7 +84,7 @@ impl TemporaryDB {
 
     fn temporary_snapshot(&self) -> TemporarySnapshot {
         TemporarySnapshot {
-            snapshot: self.inner.read().expect("Couldn't get read lock").clone(),
+            snapshot: Arc::clone(&*self.inner.read().expect("Couldn't get read lock")),
         }
     }
 }
@@ -84,24 +96,25 @@ impl Database for TemporaryDB {
 
     fn merge(&self, patch: Patch) -> Result<()> {
         let mut inner = self.inner.write().expect("Couldn't get write lock");
-        for (resolved, changes) in patch.into_changes() {
-            if !inner.contains_key(&resolved) {
-                inner.insert(resolved.clone(), BTreeMap::new());
-            }
+        // Copies the map of collections if it is referenced by a snapshot. This is cheap,
+        // since collections themselves are shared.
+        let inner = Arc::make_mut(&mut *inner);
 
-            let collection: &mut BTreeMap<Vec<u8>, Vec<u8>> = inner.get_mut(&resolved).unwrap();
+        for (resolved, changes) in patch.into_changes() {
+            let collection = inner.entry(resolved.clone()).or_default();
 
             if changes.is_cleared() {
-                if let Some(id_bytes) = resolved.id_to_bytes() {
-                    let next_bytes = next_id_bytes(id_bytes);
-                    let mut middle_and_tail = collection.split_off(id_bytes.as_ref());
-                    let mut tail = middle_and_tail.split_off(next_bytes.as_ref());
-                    collection.append(&mut tail);
-                } else {
-                    collection.clear();
-                }
+                // Each collection only contains keys of a single index, so the entire
+                // collection can be dropped.
+                *collection = Collection::default();
             }
 
+            let changes = changes.into_data();
+            if changes.is_empty() {
+                continue;
+            }
+            let collection = Arc::make_mut(collection);
+
             if let Some(id_bytes) = resolved.id_to_bytes() {
                 // Write changes to the column family with each key prefixed by the ID of the
                 // resolved address.
@@ -111,7 +124,7 @@ impl Database for TemporaryDB {
                 let mut buffer: SmallVec<[u8; 1_024]> = SmallVec::new();
                 buffer.extend_from_slice(&id_bytes);
 
-                for (key, change) in changes.into_data() {
+                for (key, change) in changes {
                     buffer.truncate(ID_SIZE);
                     buffer.extend_from_slice(&key);
 
@@ -122,7 +135,7 @@ impl Database for TemporaryDB {
                 }
             } else {
                 // Write changes to the column family as-is.
-                for (key, change) in changes.into_data() {
+                for (key, change) in changes {
                     match change {
                         Change::Put(value) => collection.insert(key, value),
                         Change::Delete => collection.remove(&key),
@@ -188,6 +201,16 @@ impl Snapshot for TemporarySnapshot {
         collection.get(name.keyed(key).as_ref()).cloned()
     }
 
+    fn read_value(&self, name: &ResolvedAddress, key: &[u8], f: &mut dyn FnMut(Cow<'_, [u8]>)) {
+        let value = self
+            .snapshot
+            .get(name)
+            .and_then(|collection| collection.get(name.keyed(key).as_ref()));
+        if let Some(value) = value {
+            f(Cow::Borrowed(value));
+        }
+    }
+
     fn iter(&self, name: &ResolvedAddress, from: &[u8]) -> Iter<'_> {
         let collection = self
             .snapshot
@@ -245,3 +268,65 @@ fn clearing_database() {
     assert_eq!(list.len(), 3);
     assert_eq!(list.iter().collect::<Vec<_>>(), vec![4, 5, 6]);
 }
+
+#[test]
+fn snapshots_are_not_affected_by_merges() {
+    use crate::access::CopyAccessExt;
+
+    let db = TemporaryDB::new();
+    let fork = db.fork();
+    fork.get_list("foo").extend(vec![1_u32, 2, 3]);
+    fork.get_entry("bar").set(1_u32);
+    db.merge(fork.into_patch()).unwrap();
+
+    let old_snapshot = db.temporary_snapshot();
+    let fork = db.fork();
+    fork.get_list("foo").push(4_u32);
+    db.merge(fork.into_patch()).unwrap();
+    db.clear().unwrap();
+    let fork = db.fork();
+    fork.get_list("foo").push(5_u32);
+    db.merge(fork.into_patch()).unwrap();
+
+    let old_access: &dyn Snapshot = &old_snapshot;
+    let list = old_access.get_list::<_, u32>("foo");
+    assert_eq!(list.iter().collect::<Vec<_>>(), vec![1, 2, 3]);
+    assert_eq!(old_access.get_entry::<_, u32>("bar").get(), Some(1));
+
+    let snapshot = db.snapshot();
+    let list = snapshot.get_list::<_, u32>("foo");
+    assert_eq!(list.iter().collect::<Vec<_>>(), vec![5]);
+    assert!(!snapshot.get_entry::<_, u32>("bar").exists());
+}
+
+#[test]
+fn unchanged_indexes_are_shared_with_snapshots() {
+    use crate::access::CopyAccessExt;
+
+    let db = TemporaryDB::new();
+    let fork = db.fork();
+    fork.get_list("foo").extend(vec![1_u32, 2, 3]);
+    fork.get_entry("bar").set(1_u32);
+    db.merge(fork.into_patch()).unwrap();
+
+    let old_snapshot = db.temporary_snapshot();
+    let fork = db.fork();
+    fork.get_list("foo").push(4_u32);
+    db.merge(fork.into_patch()).unwrap();
+    let new_snapshot = db.temporary_snapshot();
+
+    let shared_count = new_snapshot
+        .snapshot
+        .iter()
+        .filter(|(address, collection)| {
+            old_snapshot
+                .snapshot
+                .get(address)
+                .map_or(false, |old_collection| {
+                    Arc::ptr_eq(old_collection, collection)
+                })
+        })
+        .count();
+    assert!(shared_count > 0);
+    assert!(shared_count < new_snapshot.snapshot.len());
+}
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 use std::{
+    borrow::Cow,
     cell::RefCell,
     collections::{BTreeMap, HashMap, HashSet},
     fmt,
@@ -68,16 +69,42 @@ impl ViewChanges {
         self.namespace = namespace;
     }
 
+    /// Extends changes with newer `data`, which overrides the existing changes.
+    ///
+    /// Instead of re-inserting each newer change, the smaller of two maps is inserted
+    /// into the larger one, so that changes staged by a single transaction are moved
+    /// without rebuilding the tree when the view has no older changes.
+    fn merge_data(&mut self, mut data: BTreeMap<Vec<u8>, Change>) {
+        if data.len() > self.data.len() {
+            mem::swap(&mut self.data, &mut data);
+            // `data` now contains older changes, which must not override newer ones.
+            for (key, change) in data {
+                self.data.entry(key).or_insert(change);
+            }
+        } else {
+            self.data.extend(data);
+        }
+    }
+
     pub(crate) fn into_data(self) -> BTreeMap<Vec<u8>, Change> {
         self.data
     }
 
+    pub(crate) fn keys(&self) -> impl StdIterator<Item = &Vec<u8>> {
+        self.data.keys()
+    }
+
     /// Returns a value for the specified key, or an `Err(_)` if the value should be determined
     /// by the underlying snapshot.
     pub fn get(&self, key: &[u8]) -> StdResult<Option<Vec<u8>>, ()> {
+        self.get_ref(key).map(|value| value.map(<[u8]>::to_vec))
+    }
+
+    /// Same as [`get`](#method.get), but returns a reference to the value instead of copying it.
+    pub(crate) fn get_ref(&self, key: &[u8]) -> StdResult<Option<&[u8]>, ()> {
         if let Some(change) = self.data.get(key) {
             return Ok(match *change {
-                Change::Put(ref v) => Some(v.clone()),
+                Change::Put(ref v) => Some(v),
                 Change::Delete => None,
             });
         }
@@ -246,9 +273,11 @@ impl WorkingPatch {
             .clone()
     }
 
+    /// Moves all changes from this working patch into `patch`. The working patch is left
+    /// empty, but retains its allocated capacity.
     // TODO: verify that this method updates `Change`s already in the `Patch` [ECR-2834]
-    fn merge_into(self, patch: &mut Patch) {
-        for (address, changes) in self.changes.into_inner() {
+    fn merge_into(&mut self, patch: &mut Patch) {
+        for (address, changes) in self.changes.get_mut().drain() {
             // Check that changes are not borrowed mutably (in this case, the corresponding
             // `ChangesCell` is `None`).
             //
@@ -288,10 +317,15 @@ impl WorkingPatch {
             if changes.is_cleared() {
                 *patch_changes = changes;
             } else {
-                patch_changes.data.extend(changes.data);
+                patch_changes.merge_data(changes.data);
             }
         }
     }
+
+    /// Removes all changes from this working patch, retaining its allocated capacity.
+    fn clear(&mut self) {
+        self.changes.get_mut().clear();
+    }
 }
 
 /// A generalized iterator over the storage views.
@@ -697,6 +731,18 @@ pub trait Snapshot: Send + Sync + 'static {
         self.get(name, key).is_some()
     }
 
+    /// Passes a value corresponding to the specified address and key to `f`. The closure
+    /// is not called if the value does not exist.
+    ///
+    /// Unlike [`get`](#tymethod.get), the value may be borrowed from the storage, which
+    /// allows to decode values without copying them into a vector first. The default
+    /// implementation passes the value returned by `get`.
+    fn read_value(&self, name: &ResolvedAddress, key: &[u8], f: &mut dyn FnMut(Cow<'_, [u8]>)) {
+        if let Some(value) = self.get(name, key) {
+            f(Cow::Owned(value));
+        }
+    }
+
     /// Returns an iterator over the entries of the snapshot in ascending order starting from
     /// the specified key. The iterator element type is `(&[u8], &[u8])`.
     fn iter(&self, name: &ResolvedAddress, from: &[u8]) -> Iter<'_>;
@@ -737,6 +783,15 @@ impl Snapshot for Patch {
             .unwrap_or_else(|()| self.snapshot.contains(name, key))
     }
 
+    fn read_value(&self, name: &ResolvedAddress, key: &[u8], f: &mut dyn FnMut(Cow<'_, [u8]>)) {
+        match self.changes.get(name).map(|changes| changes.get_ref(key)) {
+            Some(Ok(Some(value))) => f(Cow::Borrowed(value)),
+            Some(Ok(None)) => {}
+            // The value needs to be retrieved from the snapshot.
+            None | Some(Err(())) => self.snapshot.read_value(name, key, f),
+        }
+    }
+
     fn iter(&self, name: &ResolvedAddress, from: &[u8]) -> Iter<'_> {
         let maybe_changes = self.changes.get(name);
         let changes_iter = maybe_changes.map(|changes| {
@@ -778,8 +833,7 @@ impl Fork {
     /// If no `flush` method had been called before, finalizes all changes that were
     /// made after creation of `Fork`.
     pub fn flush(&mut self) {
-        let working_patch = mem::replace(&mut self.working_patch, WorkingPatch::new());
-        working_patch.merge_into(&mut self.patch);
+        self.working_patch.merge_into(&mut self.patch);
     }
 
     /// Finishes a migration of indexes with the specified prefix.
@@ -813,7 +867,7 @@ impl Fork {
     /// Rolls back all changes that were made after the latest execution
     /// of the `flush` method.
     pub fn rollback(&mut self) {
-        self.working_patch = WorkingPatch::new();
+        self.working_patch.clear();
     }
 
     /// Rolls back the migration with the specified name. This will remove all indexes
@@ -1055,6 +1109,10 @@ impl Snapshot for Box<dyn Snapshot> {
         self.as_ref().contains(name, key)
     }
 
+    fn read_value(&self, name: &ResolvedAddress, key: &[u8], f: &mut dyn FnMut(Cow<'_, [u8]>)) {
+        self.as_ref().read_value(name, key, f)
+    }
+
     fn iter(&self, name: &ResolvedAddress, from: &[u8]) -> Iter<'_> {
         self.as_ref().iter(name, from)
     }
@@ -1071,40 +1129,39 @@ where
         }
     }
 
-    #[allow(clippy::option_if_let_else)]
     fn step(&mut self) -> NextIterValue {
         use std::cmp::Ordering::{Equal, Greater, Less};
 
-        if let Some(ref mut changes) = self.changes {
-            match changes.peek() {
-                Some(&(k, change)) => match self.snapshot.peek() {
-                    Some((key, ..)) => match *change {
-                        Change::Put(..) => match k[..].cmp(key) {
-                            Equal => NextIterValue::Replaced,
-                            Less => NextIterValue::Inserted,
-                            Greater => NextIterValue::Stored,
-                        },
-                        Change::Delete => match k[..].cmp(key) {
-                            Equal => NextIterValue::Deleted,
-                            Less => NextIterValue::MissDeleted,
-                            Greater => NextIterValue::Stored,
-                        },
-                    },
-                    None => match *change {
-                        Change::Put(..) => NextIterValue::Inserted,
-                        Change::Delete => NextIterValue::MissDeleted,
-                    },
-                },
-                None => match self.snapshot.peek() {
+        let (k, change) = match self.changes.as_mut().and_then(Peekable::peek) {
+            Some(&(k, change)) => (k, change),
+            None => {
+                // Drop exhausted changes, so that the following calls are forwarded
+                // directly to the snapshot iterator.
+                self.changes = None;
+                return match self.snapshot.peek() {
                     Some(..) => NextIterValue::Stored,
                     None => NextIterValue::Finished,
-                },
-            }
-        } else {
-            match self.snapshot.peek() {
-                Some(..) => NextIterValue::Stored,
-                None => NextIterValue::Finished,
+                };
             }
+        };
+
+        match self.snapshot.peek() {
+            Some((key, ..)) => match *change {
+                Change::Put(..) => match k[..].cmp(key) {
+                    Equal => NextIterValue::Replaced,
+                    Less => NextIterValue::Inserted,
+                    Greater => NextIterValue::Stored,
+                },
+                Change::Delete => match k[..].cmp(key) {
+                    Equal => NextIterValue::Deleted,
+                    Less => NextIterValue::MissDeleted,
+                    Greater => NextIterValue::Stored,
+                },
+            },
+            None => match *change {
+                Change::Put(..) => NextIterValue::Inserted,
+                Change::Delete => NextIterValue::MissDeleted,
+            },
         }
     }
 }
@@ -1114,6 +1171,10 @@ where
     T: StdIterator<Item = (&'a Vec<u8>, &'a Change)>,
 {
     fn next(&mut self) -> Option<(&[u8], &[u8])> {
+        if self.changes.is_none() {
+            return self.snapshot.next();
+        }
+
         loop {
             match self.step() {
                 NextIterValue::Stored => return self.snapshot.next(),
@@ -1153,6 +1214,10 @@ where
     }
 
     fn peek(&mut self) -> Option<(&[u8], &[u8])> {
+        if self.changes.is_none() {
+            return self.snapshot.peek();
+        }
+
         loop {
             match self.step() {
                 NextIterValue::Stored => return self.snapshot.peek(),
@@ -1531,4 +1596,38 @@ mod tests {
         // Since the index is already created, this should lead to a panic.
         let _readonly_entry = fork.readonly().get_entry::<_, u32>("entry");
     }
+
+    #[test]
+    fn flushed_changes_override_older_ones() {
+        let db = TemporaryDB::new();
+        let mut fork = db.fork();
+        fork.get_map("small").put(&1_u8, 1_u8);
+        let mut large = fork.get_map("large");
+        for i in 0_u8..10 {
+            large.put(&i, i);
+        }
+        drop(large);
+        fork.flush();
+
+        // Newer changes for `small` outnumber the older ones, and vice versa for `large`.
+        let mut small = fork.get_map("small");
+        for i in 0_u8..10 {
+            small.put(&i, i + 10);
+        }
+        drop(small);
+        fork.get_map("large").put(&1_u8, 11_u8);
+        fork.get_map::<_, u8, u8>("large").remove(&2_u8);
+        fork.flush();
+        fork.get_map("large").put(&3_u8, 13_u8);
+        fork.rollback();
+
+        let patch = fork.into_patch();
+        let small = patch.get_map::<_, u8, u8>("small");
+        let expected_values: Vec<_> = (10..20).collect();
+        assert_eq!(small.values().collect::<Vec<_>>(), expected_values);
+        let large = patch.get_map::<_, u8, u8>("large");
+        let expected_values = vec![0, 11, 3, 4, 5, 6, 7, 8, 9];
+        assert_eq!(large.values().collect::<Vec<_>>(), expected_values);
+        assert!(!large.contains(&2));
+    }
 }
@@ -20,6 +20,9 @@ use std::error::Error as StdError;
 
 use crate::{proof_map::ProofPath, BinaryValue};
 
+/// Maximum size of the hashed data that is buffered on stack in `hash_chunks`.
+const HASH_BUFFER_SIZE: usize = 192;
+
 // "c6c0aa07f27493d2f2e5cff56c890a353a20086d6c25ec825128e12ae752b2d9" in hex.
 const EMPTY_LIST_HASH: [u8; HASH_SIZE] = [
     198, 192, 170, 7, 242, 116, 147, 210, 242, 229, 207, 245, 108, 137, 10, 53, 58, 32, 8, 109,
@@ -66,32 +69,47 @@ pub enum HashTag {
     MapBranchNode = 4,
 }
 
-impl HashTag {
-    ///`HashStream` object with the corresponding hash prefix.
-    pub(crate) fn hash_stream(self) -> HashStream {
-        HashStream::new().update(&[self as u8])
+/// Computes the hash of the concatenation of `chunks`.
+///
+/// Hashed values in Merkelized indexes are short and consist of several parts (a tag, hashes
+/// of child nodes, etc.). Such values are concatenated on stack and hashed in one go,
+/// which is considerably faster than feeding the parts to `HashStream` one by one.
+fn hash_chunks(chunks: &[&[u8]]) -> Hash {
+    let len = chunks.iter().map(|chunk| chunk.len()).sum::<usize>();
+    if len > HASH_BUFFER_SIZE {
+        return chunks
+            .iter()
+            .fold(HashStream::new(), |stream, chunk| stream.update(chunk))
+            .hash();
     }
 
+    let mut buffer = [0_u8; HASH_BUFFER_SIZE];
+    let mut pos = 0;
+    for chunk in chunks {
+        buffer[pos..pos + chunk.len()].copy_from_slice(chunk);
+        pos += chunk.len();
+    }
+    hash(&buffer[..len])
+}
+
+impl HashTag {
     /// Obtains a hashed value of a leaf in a Merkle tree.
     pub fn hash_leaf(value: &[u8]) -> Hash {
-        Self::Blob.hash_stream().update(value).hash()
+        hash_chunks(&[&[Self::Blob as u8], value])
     }
 
     /// Obtains a hashed value of a branch in a Merkle tree.
     pub fn hash_node(left_hash: &Hash, right_hash: &Hash) -> Hash {
-        Self::ListBranchNode
-            .hash_stream()
-            .update(left_hash.as_ref())
-            .update(right_hash.as_ref())
-            .hash()
+        hash_chunks(&[
+            &[Self::ListBranchNode as u8],
+            left_hash.as_ref(),
+            right_hash.as_ref(),
+        ])
     }
 
     /// Obtains a hashed value of a Merkle tree branch with one child.
     pub fn hash_single_node(hash: &Hash) -> Hash {
-        Self::ListBranchNode
-            .hash_stream()
-            .update(hash.as_ref())
-            .hash()
+        hash_chunks(&[&[Self::ListBranchNode as u8], hash.as_ref()])
     }
 
     /// Obtains hash of a Merkelized list. `len` is the length of the list, and `root` is
@@ -104,11 +122,7 @@ impl HashTag {
         let mut len_bytes = [0; 8];
         LittleEndian::write_u64(&mut len_bytes, len);
 
-        HashStream::new()
-            .update(&[Self::ListNode as u8])
-            .update(&len_bytes)
-            .update(root.as_ref())
-            .hash()
+        hash_chunks(&[&[Self::ListNode as u8], &len_bytes, root.as_ref()])
     }
 
     /// Obtains hash of an empty Merkelized list.
@@ -132,10 +146,7 @@ impl HashTag {
     /// h = sha256( HashTag::MapNode || merkle_root )
     /// ```
     pub fn hash_map_node(root: Hash) -> Hash {
-        HashStream::new()
-            .update(&[Self::MapNode as u8])
-            .update(root.as_ref())
-            .hash()
+        hash_chunks(&[&[Self::MapNode as u8], root.as_ref()])
     }
 
     /// Obtains hash of a branch node in a Merkle Patricia tree.
@@ -149,10 +160,7 @@ impl HashTag {
     ///
     /// [`ProofMapIndex`]: indexes/proof_map/struct.ProofMapIndex.html#impl-ObjectHash
     pub fn hash_map_branch(branch_node: &[u8]) -> Hash {
-        HashStream::new()
-            .update(&[Self::MapBranchNode as u8])
-            .update(branch_node)
-            .hash()
+        hash_chunks(&[&[Self::MapBranchNode as u8], branch_node])
     }
 
     /// Obtains hash of a Merkelized map with a single entry.
@@ -170,11 +178,11 @@ impl HashTag {
         let mut path_buffer = [0; HASH_SIZE + 2];
         path.write_compressed(&mut path_buffer);
 
-        HashStream::new()
-            .update(&[Self::MapBranchNode as u8])
-            .update(&path_buffer[..])
-            .update(child_hash.as_ref())
-            .hash()
+        hash_chunks(&[
+            &[Self::MapBranchNode as u8],
+            &path_buffer[..],
+            child_hash.as_ref(),
+        ])
     }
 
     /// Obtains hash of an empty Merkelized map.
@@ -276,7 +284,7 @@ pub enum ValidationError<E: StdError + 'static> {
 mod tests {
     use exonum_crypto::{Hash, HashStream};
 
-    use super::{hash, HashTag, ProofPath, HASH_SIZE};
+    use super::{hash, HashTag, ProofPath, HASH_BUFFER_SIZE, HASH_SIZE};
 
     #[test]
     fn empty_list_hash() {
@@ -304,6 +312,29 @@ mod tests {
         assert_eq!(empty_map_hash, HashTag::empty_map_hash());
     }
 
+    #[test]
+    fn buffered_hashes_match_streamed_ones() {
+        let left = hash(b"left");
+        let right = hash(b"right");
+        let expected_hash = HashStream::new()
+            .update(&[HashTag::ListBranchNode as u8])
+            .update(left.as_ref())
+            .update(right.as_ref())
+            .hash();
+        assert_eq!(HashTag::hash_node(&left, &right), expected_hash);
+
+        // Check values shorter and longer than the stack buffer.
+        const N: usize = HASH_BUFFER_SIZE;
+        for &len in &[0, 1, N - 2, N - 1, N, 1_000] {
+            let value = vec![7_u8; len];
+            let expected_hash = HashStream::new()
+                .update(&[HashTag::Blob as u8])
+                .update(&value)
+                .hash();
+            assert_eq!(HashTag::hash_leaf(&value), expected_hash);
+        }
+    }
+
     #[test]
     fn single_entry_map_hash() {
         let path = ProofPath::from_bytes([0; HASH_SIZE]);
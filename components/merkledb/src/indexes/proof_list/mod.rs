@@ -39,6 +39,45 @@ mod proof_builder;
 #[cfg(test)]
 mod tests;
 
+/// Minimum number of hashes on a tree level for which `hash_level` hashes the level in parallel.
+const PARALLEL_HASHING_THRESHOLD: usize = 1 << 14;
+/// Number of threads used by `hash_level` for large levels.
+const PARALLEL_HASHING_THREADS: usize = 4;
+
+/// Computes the next level of the tree from the `level` hashes, the first of which has
+/// an even index on its level, and the last of which is the last hash on its level.
+fn hash_level(level: &[Hash]) -> Vec<Hash> {
+    fn hash_pairs(level: &[Hash]) -> Vec<Hash> {
+        level
+            .chunks(2)
+            .map(|pair| match pair {
+                [left, right] => HashTag::hash_node(left, right),
+                [single] => HashTag::hash_single_node(single),
+                _ => unreachable!(),
+            })
+            .collect()
+    }
+
+    if level.len() < PARALLEL_HASHING_THRESHOLD {
+        return hash_pairs(level);
+    }
+
+    // Chunks must have even length, so that pairs are not split among chunks.
+    let chunk_size = ((level.len() / PARALLEL_HASHING_THREADS) | 1) + 1;
+    crossbeam::thread::scope(|scope| {
+        let handles: Vec<_> = level
+            .chunks(chunk_size)
+            .map(|chunk| scope.spawn(move |_| hash_pairs(chunk)))
+            .collect();
+        let mut hashes = Vec::with_capacity((level.len() + 1) / 2);
+        for handle in handles {
+            hashes.extend(handle.join().expect("Hashing thread panicked"));
+        }
+        hashes
+    })
+    .expect("Hashing thread panicked")
+}
+
 fn tree_height_by_length(len: u64) -> u8 {
     if len == 0 {
         0
@@ -421,6 +460,79 @@ where
         debug_assert_eq!(last_index_on_height, 0);
     }
 
+    /// Writes levels of the tree with heights `2..` after the values starting from `first_index`
+    /// were appended to the list. `hashes` are hashes of the appended values (i.e., tree branches
+    /// on level 1).
+    ///
+    /// Unlike `update_range`, new branches are computed in memory, so that only the left
+    /// neighbor of the first updated branch on each level is read from the database.
+    ///
+    /// # Invariants
+    ///
+    /// - `self.len()` / `self.height()` is assumed to be correctly set.
+    /// - `hashes` are assumed to be the last branches on level 1.
+    fn append_hashes(&mut self, mut first_index: u64, mut hashes: Vec<Hash>) {
+        for height in 1..self.height() {
+            if first_index % 2 == 1 {
+                let key = ProofListKey::new(height, first_index - 1);
+                hashes.insert(0, self.get_branch_unchecked(key));
+                first_index -= 1;
+            }
+
+            first_index /= 2;
+            hashes = hash_level(&hashes);
+            for (i, hash) in hashes.iter().enumerate() {
+                self.base.put(
+                    &ProofListKey::new(height + 1, first_index + i as u64),
+                    *hash,
+                );
+            }
+        }
+
+        debug_assert_eq!(first_index, 0);
+        debug_assert_eq!(hashes.len(), 1);
+    }
+
+    /// Updates levels of the tree with heights `2..` after the values at the specified
+    /// `indexes` were updated. Each branch is recomputed once, regardless of the number
+    /// of updated values below it.
+    ///
+    /// # Invariants
+    ///
+    /// - `self.len()` / `self.height()` is assumed to be correctly set.
+    /// - Value hashes (i.e., tree branches on level 1) are assumed to be updated.
+    /// - `indexes` are assumed to be sorted and deduplicated.
+    fn update_indexes(&mut self, mut indexes: Vec<u64>) {
+        // Index of the last element on the current `height` of the tree.
+        let mut last_index_on_height = self.len() - 1;
+
+        for height in 1..self.height() {
+            // Indexes of the updated branches on the next level of the tree.
+            let mut parent_indexes = Vec::with_capacity(indexes.len());
+            for &index in &indexes {
+                let parent_index = index / 2;
+                if parent_indexes.last() == Some(&parent_index) {
+                    continue;
+                }
+
+                let key = ProofListKey::new(height, parent_index * 2);
+                let branch_hash = if key.index() < last_index_on_height {
+                    HashTag::hash_node(
+                        &self.get_branch_unchecked(key),
+                        &self.get_branch_unchecked(key.as_right()),
+                    )
+                } else {
+                    HashTag::hash_single_node(&self.get_branch_unchecked(key))
+                };
+                self.base.put(&key.parent(), branch_hash);
+                parent_indexes.push(parent_index);
+            }
+
+            indexes = parent_indexes;
+            last_index_on_height /= 2;
+        }
+    }
+
     /// Removes the extra elements in the tree on heights `1..` and updates elements
     /// where it is necessary.
     ///
@@ -511,13 +623,15 @@ where
     {
         let old_list_len = self.len();
         let mut new_list_len = old_list_len;
+        let iter = iter.into_iter();
+        let mut hashes = Vec::with_capacity(iter.size_hint().0);
 
         for value in iter {
-            self.base.put(
-                &ProofListKey::new(1, new_list_len),
-                HashTag::hash_leaf(&value.to_bytes()),
-            );
+            let value = value.into_bytes();
+            let hash = HashTag::hash_leaf(&value);
+            self.base.put(&ProofListKey::new(1, new_list_len), hash);
             self.base.put(&ProofListKey::leaf(new_list_len), value);
+            hashes.push(hash);
             new_list_len += 1;
         }
 
@@ -540,7 +654,7 @@ where
         );
 
         self.set_len(new_list_len);
-        self.update_range(old_list_len, new_list_len - 1);
+        self.append_hashes(old_list_len, hashes);
     }
 
     /// Changes a value at the specified position.
@@ -580,6 +694,60 @@ where
         self.update_range(index, index);
     }
 
+    /// Changes values at the specified positions.
+    ///
+    /// This method is equivalent to calling [`set`] for each of the values, but it recomputes
+    /// hashes of the tree branches only once. Thus, it is significantly faster when updating
+    /// a large number of values.
+    ///
+    /// [`set`]: #method.set
+    ///
+    /// # Panics
+    ///
+    /// Panics if any of the indexes is equal or greater than the current state of the proof list.
+    ///
+    /// # Examples
+    ///
+    /// ```
+    /// use exonum_merkledb::{access::CopyAccessExt, TemporaryDB, Database, ProofListIndex};
+    ///
+    /// let db = TemporaryDB::new();
+    /// let fork = db.fork();
+    /// let mut index = fork.get_proof_list("name");
+    ///
+    /// index.extend([1, 2, 3].iter().cloned());
+    /// index.set_many(vec![(0, 10), (2, 30)]);
+    /// assert!(index.iter().eq(vec![10, 2, 30]));
+    /// ```
+    pub fn set_many<I>(&mut self, values: I)
+    where
+        I: IntoIterator<Item = (u64, V)>,
+    {
+        let len = self.len();
+        let mut indexes = vec![];
+        for (index, value) in values {
+            if index >= len {
+                panic!(
+                    "Index out of bounds: the len is {} but the index is {}",
+                    len, index
+                );
+            }
+            self.base.put(
+                &ProofListKey::new(1, index),
+                HashTag::hash_leaf(&value.to_bytes()),
+            );
+            self.base.put(&ProofListKey::leaf(index), value);
+            indexes.push(index);
+        }
+
+        if indexes.is_empty() {
+            return;
+        }
+        indexes.sort_unstable();
+        indexes.dedup();
+        self.update_indexes(indexes);
+    }
+
     /// Shortens the list, keeping the indicated number of first `len` elements
     /// and dropping the rest.
     ///
@@ -149,6 +149,30 @@ fn extend_is_equivalent_to_sequential_pushes() {
     }
 }
 
+#[test]
+fn extending_large_list() {
+    // The number of values is large enough for the tree levels to be hashed in parallel.
+    const LEN: u64 = 40_000;
+
+    let db = TemporaryDB::new();
+    let fork = db.fork();
+    let mut index = fork.get_proof_list(IDX_NAME);
+    let mut other_index = fork.get_proof_list("other");
+    for i in 0..LEN {
+        index.push(i);
+    }
+
+    other_index.extend(0..3);
+    other_index.extend(3..LEN - 1);
+    other_index.push(LEN - 1);
+    assert_eq!(other_index.object_hash(), index.object_hash());
+    for i in (0..LEN).step_by(1_001) {
+        let proof = other_index.get_proof(i);
+        let proof = proof.check_against_hash(index.object_hash()).unwrap();
+        assert_eq!(proof.entries(), [(i, i)]);
+    }
+}
+
 #[test]
 fn tree_height() {
     let db = TemporaryDB::new();
@@ -739,6 +763,47 @@ fn setting_elements_leads_to_correct_list_hash() {
     assert_eq!(hash1, hash2);
 }
 
+#[test]
+fn set_many_is_equivalent_to_sequential_sets() {
+    let db = TemporaryDB::new();
+    let fork = db.fork();
+    let mut rng = thread_rng();
+
+    for &len in &[1_u64, 2, 5, 16, 33, 100] {
+        let mut list = fork.get_proof_list(IDX_NAME);
+        list.clear();
+        list.extend((0..len).map(|i| i.to_string()));
+
+        let updates: Vec<_> = (0..len / 2 + 1)
+            .map(|_| {
+                let index = rng.gen_range(0..len);
+                (index, rng.gen::<u64>().to_string())
+            })
+            .collect();
+        for (index, value) in updates.clone() {
+            list.set(index, value);
+        }
+        let hash_after_sets = list.object_hash();
+        let values_after_sets: Vec<_> = list.iter().collect();
+
+        list.clear();
+        list.extend((0..len).map(|i| i.to_string()));
+        list.set_many(updates);
+        assert_eq!(list.object_hash(), hash_after_sets);
+        assert_eq!(list.iter().collect::<Vec<_>>(), values_after_sets);
+    }
+}
+
+#[test]
+#[should_panic(expected = "Index out of bounds")]
+fn set_many_with_out_of_bounds_index() {
+    let db = TemporaryDB::new();
+    let fork = db.fork();
+    let mut list = fork.get_proof_list(IDX_NAME);
+    list.extend(vec![1_u8, 2, 3]);
+    list.set_many(vec![(1, 5), (3, 6)]);
+}
+
 #[test]
 fn setting_elements_leads_to_correct_list_hash_randomized() {
     const LIST_LEN: usize = 32;
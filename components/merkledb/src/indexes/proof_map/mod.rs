@@ -22,7 +22,7 @@ pub use self::{
 
 use exonum_crypto::Hash;
 
-use std::{fmt, io, marker::PhantomData};
+use std::{borrow::Borrow, cmp::Ordering, fmt, io, marker::PhantomData};
 
 use self::{
     key::{ChildKind, VALUE_KEY_PREFIX},
@@ -92,6 +92,68 @@ enum RemoveAction {
     UpdateHash(Hash),
 }
 
+/// Minimum number of leaves in a subtree for which `build_subtree` builds child subtrees
+/// in parallel.
+const PARALLEL_BUILD_THRESHOLD: usize = 1 << 14;
+/// Maximum recursion depth at which `build_subtree` spawns threads, i.e., `build_subtree`
+/// uses up to `2^PARALLEL_BUILD_DEPTH` threads.
+const PARALLEL_BUILD_DEPTH: u8 = 2;
+
+/// Builds a Merkle Patricia tree bottom-up from the `leaves` sorted by their paths. Branch nodes
+/// of the tree are appended to `nodes`. Returns the path and the hash of the subtree root.
+///
+/// Large subtrees are built in parallel; the order of nodes in the output is not specified.
+fn build_subtree(
+    leaves: &[(ProofPath, Hash)],
+    nodes: &mut Vec<(ProofPath, BranchNode)>,
+    depth: u8,
+) -> (ProofPath, Hash) {
+    debug_assert!(!leaves.is_empty());
+    if leaves.len() == 1 {
+        return leaves[0];
+    }
+
+    // Since the leaves are sorted, their common prefix is the common prefix of the first
+    // and the last leaf. The next bit splits the leaves into two non-empty subtrees.
+    let first_path = leaves[0].0;
+    let prefix_len = first_path.common_prefix_len(&leaves[leaves.len() - 1].0);
+    let mid = leaves
+        .binary_search_by(|(path, _)| match path.bit(prefix_len) {
+            ChildKind::Left => Ordering::Less,
+            ChildKind::Right => Ordering::Greater,
+        })
+        .unwrap_err();
+    let (left_leaves, right_leaves) = leaves.split_at(mid);
+
+    let (left, right) = if leaves.len() >= PARALLEL_BUILD_THRESHOLD && depth < PARALLEL_BUILD_DEPTH
+    {
+        crossbeam::thread::scope(|scope| {
+            let left = scope.spawn(|_| {
+                let mut left_nodes = vec![];
+                let root = build_subtree(left_leaves, &mut left_nodes, depth + 1);
+                (root, left_nodes)
+            });
+            let right = build_subtree(right_leaves, nodes, depth + 1);
+            let (left, left_nodes) = left.join().expect("Building subtree panicked");
+            nodes.extend(left_nodes);
+            (left, right)
+        })
+        .expect("Building subtree panicked")
+    } else {
+        let left = build_subtree(left_leaves, nodes, depth + 1);
+        let right = build_subtree(right_leaves, nodes, depth + 1);
+        (left, right)
+    };
+
+    let mut branch = BranchNode::empty();
+    branch.set_child(ChildKind::Left, &left.0.suffix(prefix_len), &left.1);
+    branch.set_child(ChildKind::Right, &right.0.suffix(prefix_len), &right.1);
+    let hash = branch.object_hash();
+    let path = first_path.prefix(prefix_len);
+    nodes.push((path, branch));
+    (path, hash)
+}
+
 /// The internal key representation that uses to address values.
 ///
 /// Represents the original key bytes with the `VALUE_KEY_PREFIX` prefix.
@@ -623,6 +685,78 @@ where
         self.update_root_path(root_path);
     }
 
+    /// Inserts multiple key-value pairs into the proof map. If several pairs have the same key,
+    /// the last value is retained.
+    ///
+    /// If the map is empty, the Merkle Patricia tree is built bottom-up after all pairs are
+    /// collected and sorted by their paths in the tree; thus, each tree node is computed
+    /// and written exactly once, and large subtrees are hashed in parallel. This is much faster
+    /// than inserting pairs one by one, which is the fallback for a non-empty map. The pairs
+    /// do not need to be sorted.
+    ///
+    /// # Examples
+    ///
+    /// ```
+    /// use exonum_merkledb::{access::CopyAccessExt, TemporaryDB, Database, ObjectHash};
+    ///
+    /// let db = TemporaryDB::new();
+    /// let fork = db.fork();
+    /// let mut index = fork.get_proof_map::<_, u64, String>("name");
+    /// index.put_all((0_u64..100).map(|i| (i, i.to_string())));
+    /// assert_eq!(index.get(&42), Some("42".to_owned()));
+    ///
+    /// let mut other_index = fork.get_proof_map::<_, u64, String>("other");
+    /// for i in (0_u64..100).rev() {
+    ///     other_index.put(&i, i.to_string());
+    /// }
+    /// assert_eq!(index.object_hash(), other_index.object_hash());
+    /// ```
+    pub fn put_all<I, Q>(&mut self, entries: I)
+    where
+        I: IntoIterator<Item = (Q, V)>,
+        Q: Borrow<K>,
+    {
+        if self.get_root_path().is_some() {
+            for (key, value) in entries {
+                self.put(key.borrow(), value);
+            }
+            return;
+        }
+
+        let mut leaves: Vec<_> = entries
+            .into_iter()
+            .map(|(key, value)| {
+                let key = key.borrow();
+                let value = value.into_bytes();
+                let hash = HashTag::hash_leaf(&value);
+                self.base.put(&key.to_value_path(), value);
+                (KeyMode::transform_key(key), hash)
+            })
+            .collect();
+        if leaves.is_empty() {
+            return;
+        }
+
+        // Sorting is stable, so after the reversal the last value for each key comes first
+        // among the leaves with the same path, and is retained by `dedup_by`.
+        leaves.reverse();
+        leaves.sort_by(|(path, _), (other_path, _)| {
+            path.partial_cmp(other_path)
+                .expect("Leaf paths are always comparable")
+        });
+        leaves.dedup_by(|(path, _), (other_path, _)| path == other_path);
+        for (path, hash) in &leaves {
+            self.base.put(path, *hash);
+        }
+
+        let mut nodes = Vec::with_capacity(leaves.len() - 1);
+        let (root_path, _) = build_subtree(&leaves, &mut nodes, 0);
+        for (path, branch) in nodes {
+            self.base.put(&path, branch);
+        }
+        self.update_root_path(root_path);
+    }
+
     /// Removes a key from the proof map.
     ///
     /// # Examples
@@ -374,6 +374,51 @@ where
         assert_eq!(index2.object_hash(), index1.object_hash());
     }
 
+    fn test_put_all() {
+        // The number of entries is large enough for the tree to be built in parallel.
+        const LEN: usize = 20_000;
+
+        let db = TemporaryDB::default();
+        let fork = db.fork();
+        let data = generate_random_data(LEN);
+        let mut index1 = fork.get_generic_proof_map::<_, _, _, S>("index1");
+        for (key, value) in &data {
+            index1.put(key, value.clone());
+        }
+
+        let mut index2 = fork.get_generic_proof_map::<_, _, _, S>("index2");
+        index2.put_all(Vec::<([u8; 32], Vec<u8>)>::new());
+        assert_eq!(index2.object_hash(), HashTag::empty_map_hash());
+        // If keys repeat, the last value should be retained.
+        let outdated_entries = data.iter().step_by(7).map(|(key, _)| (*key, vec![0]));
+        index2.put_all(outdated_entries.chain(data.iter().cloned()));
+        assert_eq!(index2.object_hash(), index1.object_hash());
+
+        let map_hash = index1.object_hash();
+        for (key, value) in data.iter().step_by(97) {
+            assert_eq!(index2.get(key).as_ref(), Some(value));
+            let proof = index2.get_proof(*key);
+            let proof = proof.check_against_hash(map_hash).unwrap();
+            assert_eq!(proof.entries().collect::<Vec<_>>(), vec![(key, value)]);
+        }
+
+        // The tree built in bulk can be updated, including with `put_all` on a non-empty map.
+        for (key, _) in data.iter().step_by(3) {
+            index1.remove(key);
+            index2.remove(key);
+        }
+        index1.put(&[1; 32], vec![1]);
+        index1.put(&[2; 32], vec![2]);
+        index2.put_all(vec![([2; 32], vec![2]), ([1; 32], vec![1])]);
+        assert_eq!(index2.object_hash(), index1.object_hash());
+
+        let mut index3 = fork.get_generic_proof_map::<_, _, _, S>("index3");
+        index3.put_all(vec![([1; 32], vec![1])]);
+        let mut index4 = fork.get_generic_proof_map::<_, _, _, S>("index4");
+        index4.put(&[1; 32], vec![1]);
+        assert_eq!(index3.object_hash(), index4.object_hash());
+    }
+
     fn test_build_proof_in_empty_tree() {
         let db = TemporaryDB::default();
         let fork = db.fork();
@@ -1019,6 +1064,16 @@ fn test_insert_simple_hashed() {
     ProofMapTester::<Hashed>::test_insert_simple()
 }
 
+#[test]
+fn test_put_all_raw() {
+    ProofMapTester::<Raw>::test_put_all()
+}
+
+#[test]
+fn test_put_all_hashed() {
+    ProofMapTester::<Hashed>::test_put_all()
+}
+
 #[test]
 fn test_insert_reverse_raw() {
     ProofMapTester::<Raw>::test_insert_reverse()
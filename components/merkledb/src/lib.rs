@@ -182,7 +182,7 @@ pub use self::{
     hash::{root_hash, HashTag, ObjectHash, ValidationError},
     keys::BinaryKey,
     lazy::Lazy,
-    options::DbOptions,
+    options::{CompactionStyle, CompressionType, DbOptions},
     values::BinaryValue,
     views::{AsReadonly, IndexAddress, IndexType, ResolvedAddress, SystemSchema},
 };
@@ -125,7 +125,10 @@
 //! # }
 //! ```
 
-pub use self::persistent_iter::{PersistentIter, PersistentIters, PersistentKeys};
+pub use self::{
+    partitioned::KeyPartitions,
+    persistent_iter::{PersistentIter, PersistentIters, PersistentKeys},
+};
 
 use exonum_crypto::Hash;
 use thiserror::Error;
@@ -148,6 +151,7 @@ use crate::{
     BinaryKey, Database, Fork, ObjectHash, ProofMapIndex, ReadonlyFork,
 };
 
+mod partitioned;
 mod persistent_iter;
 
 /// Name of the column family used to store `Scratchpad`s.
@@ -443,7 +447,42 @@ impl<T: RawAccess> Access for Scratchpad<T> {
 /// # }
 /// ```
 ///
+/// ## Partitioned migrations
+///
+/// Large indexes can be migrated into a `ProofMapIndex` using several threads
+/// with the [`migrate_partitioned`](#method.migrate_partitioned) method. The key space
+/// of the index is split into [partitions]; each partition is processed by a separate
+/// persistent iterator, so the migration can still be resumed after a restart.
+///
+/// ```
+/// # use exonum_crypto::Hash;
+/// # use exonum_merkledb::{access::{AccessExt, CopyAccessExt}, Database, ObjectHash, TemporaryDB};
+/// # use exonum_merkledb::migration::{KeyPartitions, MigrationHelper, MigrationError};
+/// # fn main() -> Result<(), MigrationError> {
+/// let db = TemporaryDB::new();
+/// let fork = db.fork();
+/// let mut wallets = fork.get_map::<_, Hash, u64>("test.wallets");
+/// for i in 0_u64..1_000 {
+///     wallets.put(&i.object_hash(), i);
+/// }
+/// db.merge(fork.into_patch()).unwrap();
+///
+/// let mut helper = MigrationHelper::new(db, "test");
+/// let partitions = KeyPartitions::uniform(4).chunk_size(100);
+/// helper.migrate_partitioned(
+///     &partitions,
+///     |old_data| old_data.get_map::<_, Hash, u64>("wallets"),
+///     "wallets",
+///     |_, balance| Some(balance * 2),
+/// )?;
+/// let new_wallets = helper.new_data().get_proof_map::<_, Hash, u64>("wallets");
+/// assert_eq!(new_wallets.get(&5_u64.object_hash()), Some(10));
+/// # Ok(())
+/// # }
+/// ```
+///
 /// [persistent iterators]: struct.PersistentIter.html
+/// [partitions]: struct.KeyPartitions.html
 pub struct MigrationHelper {
     db: Arc<dyn Database>,
     abort_handle: Box<dyn AbortMigration>,
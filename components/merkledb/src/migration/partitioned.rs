@@ -0,0 +1,479 @@
+// Copyright 2020 The Exonum Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Partitioned migration of large indexes using several threads.
+
+use exonum_crypto::{Hash, HASH_SIZE};
+
+use std::{
+    borrow::Borrow,
+    fmt,
+    marker::PhantomData,
+    panic,
+    sync::{
+        atomic::{AtomicUsize, Ordering},
+        mpsc, Arc,
+    },
+};
+
+use super::{MigrationError, MigrationHelper, PersistentIter, Scratchpad};
+use crate::{
+    access::{AccessExt, Prefixed},
+    indexes::IndexIterator,
+    BinaryKey, BinaryValue, Database, ObjectHash, Patch, Snapshot,
+};
+
+/// Number of entries processed by a worker thread per database merge by default.
+const DEFAULT_CHUNK_SIZE: usize = 10_000;
+
+/// Partitioning of the key space of a migrated index into consecutive ranges.
+///
+/// Partitions are defined by their boundaries: `n` boundaries split the key space into
+/// `n + 1` ranges, the first of which is unbounded from below, and the last is unbounded
+/// from above. Keys are compared by their binary serialization, i.e., in the order
+/// the keys are stored in the database.
+///
+/// Partitioning should not be changed between restarts of the same migration.
+pub struct KeyPartitions<K: BinaryKey + ?Sized> {
+    boundaries: Vec<Vec<u8>>,
+    threads: usize,
+    chunk_size: usize,
+    _key: PhantomData<fn(&K)>,
+}
+
+impl<K: BinaryKey + ?Sized> fmt::Debug for KeyPartitions<K> {
+    fn fmt(&self, formatter: &mut fmt::Formatter<'_>) -> fmt::Result {
+        formatter
+            .debug_struct("KeyPartitions")
+            .field("partitions", &self.len())
+            .field("threads", &self.threads)
+            .field("chunk_size", &self.chunk_size)
+            .finish()
+    }
+}
+
+impl<K: BinaryKey + ?Sized> KeyPartitions<K> {
+    /// Creates partitions with the specified boundaries. By default, partitions are processed
+    /// with one thread per partition.
+    ///
+    /// # Panics
+    ///
+    /// Panics if the boundaries are not strictly increasing.
+    pub fn new<B>(boundaries: impl IntoIterator<Item = B>) -> Self
+    where
+        B: Borrow<K>,
+    {
+        let boundaries: Vec<_> = boundaries
+            .into_iter()
+            .map(|key| {
+                let key = key.borrow();
+                let mut buffer = vec![0; key.size()];
+                key.write(&mut buffer);
+                buffer
+            })
+            .collect();
+        assert!(
+            boundaries.windows(2).all(|pair| pair[0] < pair[1]),
+            "Partition boundaries should be strictly increasing"
+        );
+
+        Self {
+            threads: boundaries.len() + 1,
+            boundaries,
+            chunk_size: DEFAULT_CHUNK_SIZE,
+            _key: PhantomData,
+        }
+    }
+
+    /// Sets the maximum number of worker threads.
+    pub fn threads(mut self, threads: usize) -> Self {
+        assert!(threads > 0, "Number of threads should be positive");
+        self.threads = threads;
+        self
+    }
+
+    /// Sets the number of entries processed by a worker per database merge.
+    pub fn chunk_size(mut self, chunk_size: usize) -> Self {
+        assert!(chunk_size > 0, "Chunk size should be positive");
+        self.chunk_size = chunk_size;
+        self
+    }
+
+    /// Returns the number of partitions.
+    pub fn len(&self) -> usize {
+        self.boundaries.len() + 1
+    }
+
+    /// Always returns `false`: there is at least one partition.
+    pub fn is_empty(&self) -> bool {
+        false
+    }
+
+    /// Returns the bounds of the partition with the specified index.
+    fn bounds(&self, partition: usize) -> (Option<K::Owned>, Option<&[u8]>) {
+        let start = partition
+            .checked_sub(1)
+            .map(|i| K::read(&self.boundaries[i]));
+        let end = self.boundaries.get(partition).map(Vec::as_slice);
+        (start, end)
+    }
+}
+
+impl KeyPartitions<Hash> {
+    /// Splits the space of hashes into `count` ranges of approximately equal size. This is
+    /// appropriate for indexes with hash-like keys, such as hashes or public keys.
+    pub fn uniform(count: u16) -> Self {
+        assert!(count > 0, "Number of partitions should be positive");
+        let step = (1_u32 << 16) / u32::from(count);
+        Self::new((1..u32::from(count)).map(|i| {
+            let prefix = (i * step) as u16;
+            let mut bytes = [0; HASH_SIZE];
+            bytes[..2].copy_from_slice(&prefix.to_be_bytes());
+            Hash::new(bytes)
+        }))
+    }
+}
+
+/// Message sent by a migration worker to the thread merging changes.
+type WorkerMessage = (Patch, mpsc::SyncSender<bool>);
+
+#[derive(Debug)]
+struct PartitionNames {
+    staging: String,
+    build_cursor: String,
+}
+
+impl PartitionNames {
+    fn new(destination: &str) -> Self {
+        Self {
+            staging: format!("{}__staging", destination),
+            build_cursor: format!("{}__build", destination),
+        }
+    }
+
+    fn cursor(destination: &str, partition: usize) -> String {
+        format!("{}__cursor_{}", destination, partition)
+    }
+}
+
+impl MigrationHelper {
+    /// Migrates an index into a `ProofMapIndex` using several threads.
+    ///
+    /// The key space of the source index is split into `partitions`, which are processed
+    /// by a pool of worker threads. Each partition is traversed with a [persistent iterator],
+    /// and the transformed entries are written to a non-Merkelized staging map
+    /// in the scratchpad, so that workers do not contend for the Merkle tree.
+    /// Changes are merged to the database every `chunk_size` entries of a partition;
+    /// thus, if the migration is restarted, it resumes from the last merged positions.
+    /// Once all partitions are processed, the destination map at `destination` in the new
+    /// data is filled from the staging map with a single `ProofMapIndex::put_all` call, which
+    /// builds the Merkle tree bottom-up. This is the only phase that computes Merkle hashes.
+    ///
+    /// `source` creates the source index from the old data. It is called once per chunk
+    /// of work, so it should be lightweight (e.g., `|old| old.get_map("name")`).
+    /// `transform` converts source entries; entries for which it returns `None` are skipped.
+    /// Keys are retained.
+    ///
+    /// Any pending changes in the helper are merged before the migration starts.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `source` or `transform` panic in any worker.
+    ///
+    /// [persistent iterator]: struct.PersistentIter.html
+    pub fn migrate_partitioned<I, U>(
+        &mut self,
+        partitions: &KeyPartitions<I::Key>,
+        source: impl Fn(Prefixed<Arc<dyn Snapshot>>) -> I + Sync,
+        destination: &str,
+        transform: impl Fn(&I::Key, I::Value) -> Option<U> + Sync,
+    ) -> Result<(), MigrationError>
+    where
+        I: IndexIterator,
+        I::Key: ObjectHash,
+        U: BinaryValue,
+    {
+        let names = PartitionNames::new(destination);
+        let cursors: Vec<_> = (0..partitions.len())
+            .map(|i| PartitionNames::cursor(destination, i))
+            .collect();
+
+        // Create all indexes used by the workers in advance, so that concurrent forks
+        // do not allocate index metadata.
+        {
+            let scratchpad = self.scratchpad();
+            scratchpad.get_map::<_, I::Key, U>(names.staging.as_str());
+            for cursor in &cursors {
+                scratchpad.get_entry::<_, Vec<u8>>(cursor.as_str());
+            }
+        }
+        self.merge()?;
+
+        let db = Arc::clone(&self.db);
+        let namespace = self.namespace.as_str();
+        let snapshot: Arc<dyn Snapshot> = Arc::from(db.snapshot());
+        let next_partition = AtomicUsize::new(0);
+        let threads = partitions.threads.min(partitions.len());
+        let (tx, rx) = mpsc::sync_channel::<WorkerMessage>(threads);
+
+        let worker = |tx: mpsc::SyncSender<WorkerMessage>| {
+            let (ack_tx, ack_rx) = mpsc::sync_channel(1);
+            loop {
+                let partition = next_partition.fetch_add(1, Ordering::SeqCst);
+                if partition >= partitions.len() {
+                    return;
+                }
+                let (start, end) = partitions.bounds(partition);
+                let end = end.map(<I::Key as BinaryKey>::read);
+
+                loop {
+                    let fork = db.fork();
+                    let is_ended = {
+                        let scratchpad = Scratchpad::new(namespace, &fork);
+                        let source = source(Prefixed::new(namespace, Arc::clone(&snapshot)));
+                        let mut staging =
+                            scratchpad.get_map::<_, I::Key, U>(names.staging.as_str());
+                        let mut iter = PersistentIter::with_range(
+                            &scratchpad,
+                            &cursors[partition],
+                            &source,
+                            start.as_ref().map(Borrow::borrow),
+                            end.as_ref().map(Borrow::borrow),
+                        );
+                        for (key, value) in iter.by_ref().take(partitions.chunk_size) {
+                            if let Some(value) = transform(key.borrow(), value) {
+                                staging.put(key.borrow(), value);
+                            }
+                        }
+                        iter.is_ended()
+                    };
+
+                    let message = (fork.into_patch(), ack_tx.clone());
+                    let is_merged = tx.send(message).is_ok() && ack_rx.recv().unwrap_or(false);
+                    if !is_merged {
+                        return;
+                    }
+                    if is_ended {
+                        break;
+                    }
+                }
+            }
+        };
+
+        let res = crossbeam::thread::scope(|scope| {
+            for _ in 0..threads {
+                let tx = tx.clone();
+                scope.spawn(|_| worker(tx));
+            }
+            drop(tx);
+
+            let mut res = Ok(());
+            for (patch, ack) in rx {
+                if res.is_ok() {
+                    res = if self.is_aborted() {
+                        Err(MigrationError::Aborted)
+                    } else {
+                        db.merge(patch).map_err(MigrationError::Merge)
+                    };
+                }
+                ack.send(res.is_ok()).ok();
+            }
+            res
+        })
+        .unwrap_or_else(|err| panic::resume_unwind(err));
+        // The workers have merged their changes directly; start from a fresh fork.
+        self.fork = Some(self.db.fork());
+        res?;
+
+        // The destination map is filled in one pass: `put_all` builds the tree bottom-up
+        // only if the map is empty, and inserts entries one by one otherwise.
+        self.iter_loop(|helper, iters| {
+            let staging = helper
+                .scratchpad()
+                .get_map::<_, I::Key, U>(names.staging.as_str());
+            let mut destination = helper.new_data().get_proof_map::<_, I::Key, U>(destination);
+            destination.put_all(iters.create(&names.build_cursor, &staging));
+        })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{access::CopyAccessExt, migration::Migration, TemporaryDB};
+
+    use std::panic::AssertUnwindSafe;
+
+    fn create_db(count: u64) -> Arc<TemporaryDB> {
+        let db = TemporaryDB::new();
+        let fork = db.fork();
+        let mut map = fork.get_map::<_, Hash, u64>("test.map");
+        for i in 0..count {
+            map.put(&i.object_hash(), i);
+        }
+        db.merge(fork.into_patch()).unwrap();
+        Arc::new(db)
+    }
+
+    fn expected_hash(count: u64) -> Hash {
+        let db = TemporaryDB::new();
+        let fork = db.fork();
+        let mut map = fork.get_proof_map::<_, Hash, u64>("map");
+        for i in (0..count).filter(|i| i % 3 != 0) {
+            map.put(&i.object_hash(), i * 2);
+        }
+        map.object_hash()
+    }
+
+    fn transform(_: &Hash, value: u64) -> Option<u64> {
+        if value % 3 == 0 {
+            None
+        } else {
+            Some(value * 2)
+        }
+    }
+
+    #[test]
+    fn uniform_hash_partitions() {
+        let partitions = KeyPartitions::uniform(4);
+        assert_eq!(partitions.len(), 4);
+        let (start, end) = partitions.bounds(0);
+        assert!(start.is_none());
+        assert_eq!(end.unwrap()[..2], [0x40, 0]);
+        let (start, end) = partitions.bounds(3);
+        assert_eq!(start.unwrap().as_ref()[..2], [0xc0, 0]);
+        assert!(end.is_none());
+
+        assert_eq!(KeyPartitions::uniform(1).len(), 1);
+    }
+
+    #[test]
+    fn partitioned_migration() {
+        const COUNT: u64 = 500;
+
+        let db = create_db(COUNT);
+        let mut helper = MigrationHelper::new(Arc::clone(&db) as Arc<dyn Database>, "test");
+        let partitions = KeyPartitions::uniform(7).threads(3).chunk_size(16);
+        helper
+            .migrate_partitioned(
+                &partitions,
+                |old_data| old_data.get_map::<_, Hash, u64>("map"),
+                "map",
+                transform,
+            )
+            .unwrap();
+        helper.finish().unwrap();
+
+        let snapshot = db.snapshot();
+        let migration = Migration::new("test", &snapshot);
+        let map = migration.get_proof_map::<_, Hash, u64>("map");
+        assert_eq!(map.object_hash(), expected_hash(COUNT));
+    }
+
+    #[test]
+    fn partitioned_migration_with_more_entries_than_chunk_size() {
+        const COUNT: u64 = DEFAULT_CHUNK_SIZE as u64 * 3 / 2;
+
+        let db = create_db(COUNT);
+        let mut helper = MigrationHelper::new(Arc::clone(&db) as Arc<dyn Database>, "test");
+        helper
+            .migrate_partitioned(
+                &KeyPartitions::uniform(2),
+                |old_data| old_data.get_map::<_, Hash, u64>("map"),
+                "map",
+                transform,
+            )
+            .unwrap();
+
+        let map = helper.new_data().get_proof_map::<_, Hash, u64>("map");
+        assert_eq!(map.object_hash(), expected_hash(COUNT));
+        let expected_len = (0..COUNT).filter(|i| i % 3 != 0).count();
+        assert_eq!(map.keys().count(), expected_len);
+        for i in 0..COUNT {
+            assert_eq!(map.get(&i.object_hash()), transform(&Hash::zero(), i));
+        }
+    }
+
+    #[test]
+    fn partitioned_migration_with_unsized_keys() {
+        let db = TemporaryDB::new();
+        let fork = db.fork();
+        let mut map = fork.get_map::<_, str, u64>("test.words");
+        let words = ["How", "many", "letters", "are", "in", "this", "word", "?"];
+        for &word in &words {
+            map.put(word, word.len() as u64);
+        }
+        db.merge(fork.into_patch()).unwrap();
+
+        let mut helper = MigrationHelper::new(db, "test");
+        let partitions = KeyPartitions::<str>::new(vec!["are", "many"]).chunk_size(2);
+        helper
+            .migrate_partitioned(
+                &partitions,
+                |old_data| old_data.get_map::<_, str, u64>("words"),
+                "words",
+                |_, len| Some(len),
+            )
+            .unwrap();
+
+        let map = helper.new_data().get_proof_map::<_, str, u64>("words");
+        assert_eq!(map.keys().count(), words.len());
+        for &word in &words {
+            assert_eq!(map.get(word), Some(word.len() as u64));
+        }
+    }
+
+    #[test]
+    fn partitioned_migration_is_resumed_after_failure() {
+        const COUNT: u64 = 300;
+
+        let db = create_db(COUNT);
+        let partitions = KeyPartitions::uniform(4).threads(2).chunk_size(10);
+        let calls = AtomicUsize::new(0);
+        let res = panic::catch_unwind(AssertUnwindSafe(|| {
+            let mut helper = MigrationHelper::new(Arc::clone(&db) as Arc<dyn Database>, "test");
+            helper.migrate_partitioned(
+                &partitions,
+                |old_data| old_data.get_map::<_, Hash, u64>("map"),
+                "map",
+                |key, value| {
+                    if calls.fetch_add(1, Ordering::SeqCst) == 100 {
+                        panic!("Worker failure");
+                    }
+                    transform(key, value)
+                },
+            )
+        }));
+        assert!(res.is_err());
+
+        let calls = AtomicUsize::new(0);
+        let mut helper = MigrationHelper::new(Arc::clone(&db) as Arc<dyn Database>, "test");
+        helper
+            .migrate_partitioned(
+                &partitions,
+                |old_data| old_data.get_map::<_, Hash, u64>("map"),
+                "map",
+                |key, value| {
+                    calls.fetch_add(1, Ordering::SeqCst);
+                    transform(key, value)
+                },
+            )
+            .unwrap();
+        // Chunks merged before the failure are not processed again.
+        assert!(calls.load(Ordering::SeqCst) < COUNT as usize);
+
+        let map = helper.new_data().get_proof_map::<_, Hash, u64>("map");
+        assert_eq!(map.object_hash(), expected_hash(COUNT));
+    }
+}
@@ -159,6 +159,8 @@ enum Inner<'a, T: RawAccess, I: IndexIterator> {
     Active {
         iter: Peekable<Entries<'a, I::Key, I::Value>>,
         position_entry: Entry<T, IteratorPosition<I::Key>>,
+        /// Serialized exclusive upper bound of the iterated keys.
+        end: Option<Vec<u8>>,
     },
     /// The iterator has ended.
     Ended,
@@ -188,13 +190,32 @@ where
 {
     /// Creates a new persistent iterator.
     pub fn new<A>(access: &A, name: &str, index: &'a I) -> Self
+    where
+        A: Access<Base = T>,
+    {
+        Self::with_range(access, name, index, None, None)
+    }
+
+    /// Creates a new persistent iterator over keys in the `[start, end)` range, where `None`
+    /// bounds are unlimited. Keys are compared by their binary serialization, i.e., in the order
+    /// the keys are stored in the database.
+    ///
+    /// The range is only used when the iterator is created for the first time; a resumed
+    /// iterator continues from its persisted position, but still stops at `end`.
+    pub fn with_range<A>(
+        access: &A,
+        name: &str,
+        index: &'a I,
+        start: Option<&I::Key>,
+        end: Option<&I::Key>,
+    ) -> Self
     where
         A: Access<Base = T>,
     {
         let position_entry: Entry<_, IteratorPosition<I::Key>> = access.get_entry(name);
         let position = position_entry.get();
 
-        let start_key = match position {
+        let next_key = match position {
             None => None,
             Some(IteratorPosition::NextKey(key)) => Some(key),
             Some(IteratorPosition::Ended) => {
@@ -203,17 +224,27 @@ where
                 };
             }
         };
+        let start_key = next_key.as_ref().map(Borrow::borrow).or(start);
 
         Self {
             inner: Inner::Active {
-                iter: index
-                    .index_iter(start_key.as_ref().map(Borrow::borrow))
-                    .peekable(),
+                iter: index.index_iter(start_key).peekable(),
                 position_entry,
+                end: end.map(serialize_key),
             },
         }
     }
 
+    /// Checks if the iterator has ended, i.e., will not yield any more items.
+    pub(crate) fn is_ended(&self) -> bool {
+        match self.inner {
+            Inner::Active {
+                ref position_entry, ..
+            } => matches!(position_entry.get(), Some(IteratorPosition::Ended)),
+            Inner::Ended => true,
+        }
+    }
+
     /// Skips values in the iterator output without parsing them.
     pub fn skip_values(self) -> PersistentKeys<'a, T, I> {
         PersistentKeys { base_iter: self }
@@ -231,15 +262,19 @@ where
         if let Inner::Active {
             ref mut iter,
             ref mut position_entry,
+            ref end,
         } = self.inner
         {
-            let next = iter.next();
+            let next = iter
+                .next()
+                .filter(|(key, _)| is_before_end(key.borrow(), end));
             if next.is_some() {
-                position_entry.set(if let Some((key, _)) = iter.peek() {
-                    // Slightly clumsy way to clone the key.
-                    IteratorPosition::NextKey(key.borrow().to_owned())
-                } else {
-                    IteratorPosition::Ended
+                position_entry.set(match iter.peek() {
+                    Some((key, _)) if is_before_end(key.borrow(), end) => {
+                        // Slightly clumsy way to clone the key.
+                        IteratorPosition::NextKey(key.borrow().to_owned())
+                    }
+                    _ => IteratorPosition::Ended,
                 });
             } else {
                 position_entry.set(IteratorPosition::Ended);
@@ -252,6 +287,17 @@ where
     }
 }
 
+fn serialize_key<K: BinaryKey + ?Sized>(key: &K) -> Vec<u8> {
+    let mut buffer = vec![0; key.size()];
+    key.write(&mut buffer);
+    buffer
+}
+
+fn is_before_end<K: BinaryKey + ?Sized>(key: &K, end: &Option<Vec<u8>>) -> bool {
+    end.as_ref()
+        .map_or(true, |end| serialize_key(key).as_slice() < end.as_slice())
+}
+
 /// Persistent iterator over index keys that stores its position in the database.
 ///
 /// This iterator can be used similarly to [`PersistentIter`]; the only difference is the
@@ -402,6 +448,41 @@ mod tests {
         assert_eq!(iter.count(), 0);
     }
 
+    #[test]
+    fn persistent_iter_with_range() {
+        let db = TemporaryDB::new();
+        let fork = db.fork();
+        let mut map = fork.get_map("map");
+        for i in 0_u32..10 {
+            map.put(&i, i.to_string());
+        }
+
+        let scratchpad = Scratchpad::new("iter", &fork);
+        let iter = PersistentIter::with_range(&scratchpad, "map", &map, Some(&3), Some(&7));
+        let keys: Vec<_> = iter.take(2).map(|(key, _)| key).collect();
+        assert_eq!(keys, vec![3, 4]);
+
+        // The resumed iterator ignores `start`, but respects `end`.
+        {
+            let iter = PersistentIter::with_range(&scratchpad, "map", &map, Some(&0), Some(&7));
+            assert!(!iter.is_ended());
+            let mut iter = iter.skip_values();
+            assert_eq!(iter.by_ref().collect::<Vec<_>>(), vec![5, 6]);
+            assert!(iter.base_iter.is_ended());
+        }
+        {
+            let position_entry = scratchpad.get_entry::<_, IteratorPosition<u32>>("map");
+            assert_eq!(position_entry.get(), Some(IteratorPosition::Ended));
+        }
+
+        // The iterator ends after the last key in the range even if it is not exhausted.
+        let mut iter = PersistentIter::with_range(&scratchpad, "other", &map, Some(&8), None);
+        assert_eq!(iter.next(), Some((8, "8".to_owned())));
+        assert!(!iter.is_ended());
+        assert_eq!(iter.next(), Some((9, "9".to_owned())));
+        assert!(iter.is_ended());
+    }
+
     #[test]
     fn persistent_iter_with_unsized_keys() {
         let db = TemporaryDB::new();
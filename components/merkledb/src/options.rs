@@ -14,7 +14,7 @@
 
 //! Abstract settings for databases.
 
-use rocksdb::DBCompressionType;
+use rocksdb::{DBCompactionStyle, DBCompressionType};
 use serde_derive::{Deserialize, Serialize};
 
 /// Options for the database.
@@ -51,6 +51,45 @@ pub struct DbOptions {
     /// Defaults to `None`, meaning that the size of WAL journal will be adjusted
     /// by the rocksdb.
     pub max_total_wal_size: Option<u64>,
+    /// Size in bytes of the cache for values read from the database.
+    ///
+    /// The cache is shared by all snapshots of the database and is updated when a patch
+    /// is merged. It primarily speeds up repeated reads of the upper levels of Merkelized indexes,
+    /// such as branch nodes of `ProofMapIndex` and `ProofListIndex`.
+    ///
+    /// Defaults to `None`, meaning that the cache is disabled.
+    pub read_cache_size: Option<usize>,
+    /// Size in bytes of the LRU cache for uncompressed data blocks of the database.
+    ///
+    /// The cache is shared by all column families of the database. Unlike `read_cache_size`,
+    /// it caches whole data blocks rather than separate values, and thus also speeds up
+    /// iteration over indexes.
+    ///
+    /// Defaults to `None`, meaning that the default cache of the underlying database is used
+    /// (8 MB per column family for `RocksDB`).
+    pub block_cache_size: Option<usize>,
+    /// Number of bits per key in Bloom filters built for the database tables.
+    ///
+    /// Bloom filters allow to skip reading data blocks which definitely do not contain
+    /// the requested key, which speeds up reads of missing keys (e.g., checks whether
+    /// a transaction is already known). The filters are built over whole keys and do not
+    /// affect iteration. 10 bits per key give approximately 1% of false positives.
+    ///
+    /// Defaults to `None`, meaning that Bloom filters are not used.
+    pub bloom_filter_bits: Option<i32>,
+    /// Size in bytes of the in-memory buffer accumulating writes to a column family
+    /// before they are flushed to disk.
+    ///
+    /// Larger buffers reduce write amplification at the cost of memory usage and
+    /// recovery time.
+    ///
+    /// Defaults to `None`, meaning that the default size of the underlying database is used
+    /// (64 MB for `RocksDB`).
+    pub write_buffer_size: Option<usize>,
+    /// Compaction style used by the database.
+    ///
+    /// Defaults to `None`, meaning that `CompactionStyle::Level` is used.
+    pub compaction_style: Option<CompactionStyle>,
 }
 
 impl DbOptions {
@@ -66,8 +105,20 @@ impl DbOptions {
             create_if_missing,
             compression_type,
             max_total_wal_size,
+            read_cache_size: None,
+            block_cache_size: None,
+            bloom_filter_bits: None,
+            write_buffer_size: None,
+            compaction_style: None,
         }
     }
+
+    /// Enables the cache for values read from the database with the specified size in bytes.
+    /// See [`read_cache_size`](#structfield.read_cache_size) for details.
+    pub fn with_read_cache_size(mut self, size: usize) -> Self {
+        self.read_cache_size = Some(size);
+        self
+    }
 }
 
 /// Algorithms of compression for the database.
@@ -102,8 +153,32 @@ impl From<CompressionType> for DBCompressionType {
     }
 }
 
+/// Compaction styles of the database.
+///
+/// See [`RocksDB` docs] for the detailed description of the styles.
+///
+/// [`RocksDB` docs]: https://github.com/facebook/rocksdb/wiki/Compaction
+#[derive(Debug, Clone, Copy, Serialize, Deserialize, PartialEq)]
+#[serde(rename_all = "lowercase")]
+pub enum CompactionStyle {
+    /// Leveled compaction. Provides the smallest space and read amplification.
+    Level,
+    /// Universal (tiered) compaction. Reduces write amplification at the cost
+    /// of the space and read amplification.
+    Universal,
+}
+
+impl From<CompactionStyle> for DBCompactionStyle {
+    fn from(compaction_style: CompactionStyle) -> Self {
+        match compaction_style {
+            CompactionStyle::Level => Self::Level,
+            CompactionStyle::Universal => Self::Universal,
+        }
+    }
+}
+
 impl Default for DbOptions {
     fn default() -> Self {
-        Self::new(None, true, CompressionType::None, None)
+        Self::new(None, true, CompressionType::None, None, None)
     }
 }
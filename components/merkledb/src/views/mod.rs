@@ -193,6 +193,24 @@ impl<T: RawAccess> ViewInner<T> {
             .unwrap_or_else(|()| self.snapshot().get(&self.address, key))
     }
 
+    fn read_value<R>(&self, key: &[u8], f: impl FnOnce(Cow<'_, [u8]>) -> R) -> Option<R> {
+        match self.changes.as_ref().map(|changes| changes.get_ref(key)) {
+            Some(Ok(Some(value))) => return Some(f(Cow::Borrowed(value))),
+            Some(Ok(None)) => return None,
+            // The value needs to be retrieved from the snapshot.
+            None | Some(Err(())) => {}
+        }
+
+        let mut f = Some(f);
+        let mut output = None;
+        self.snapshot()
+            .read_value(&self.address, key, &mut |value: Cow<'_, [u8]>| {
+                let f = f.take().expect("Value is read more than once");
+                output = Some(f(value));
+            });
+        output
+    }
+
     fn contains_raw_key(&self, key: &[u8]) -> bool {
         self.changes
             .as_ref()
@@ -275,9 +293,14 @@ impl<T: RawAccess> View<T> {
         K: BinaryKey + ?Sized,
         V: BinaryValue,
     {
-        self.get_bytes(&key_bytes(key)).map(|v| {
-            BinaryValue::from_bytes(Cow::Owned(v)).expect("Error while deserializing value")
-        })
+        match self {
+            Self::Real(inner) => inner.read_value(&key_bytes(key), |value| {
+                // Values borrowed from the storage are decoded without copying them
+                // unless the value type needs to own the bytes.
+                V::from_bytes(value).expect("Error while deserializing value")
+            }),
+            Self::Phantom => None,
+        }
     }
 
     /// Returns `true` if the index contains a value of *any* type for the specified key of
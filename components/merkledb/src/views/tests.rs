@@ -15,14 +15,15 @@
 use assert_matches::assert_matches;
 use url::form_urlencoded::byte_serialize;
 
-use std::{num::NonZeroU64, panic, rc::Rc};
+use std::{fs, num::NonZeroU64, panic, rc::Rc};
 
 use crate::{
     access::CopyAccessExt,
     db,
     validation::is_valid_identifier,
     views::{IndexAddress, IndexType, RawAccess, View, ViewWithMetadata},
-    Database, DbOptions, Fork, ListIndex, MapIndex, ResolvedAddress, RocksDB, TemporaryDB,
+    BinaryValue, CompactionStyle, Database, DbOptions, Fork, ListIndex, MapIndex, ResolvedAddress,
+    RocksDB, Snapshot, TemporaryDB,
 };
 
 const IDX_NAME: &str = "idx_name";
@@ -390,6 +391,71 @@ fn test_database_check_incorrect_version() {
     RocksDB::open(&dir, &opts).unwrap();
 }
 
+#[test]
+fn test_database_with_tuned_options() {
+    let dir = tempfile::TempDir::new().unwrap();
+    let mut opts = DbOptions::default();
+    opts.block_cache_size = Some(1 << 20);
+    opts.bloom_filter_bits = Some(10);
+    opts.write_buffer_size = Some(1 << 20);
+    opts.compaction_style = Some(CompactionStyle::Universal);
+
+    {
+        let db = RocksDB::open(&dir, &opts).unwrap();
+        let fork = db.fork();
+        fork.get_list(IDX_NAME).extend(vec![1_u32, 2, 3]);
+        fork.get_map(PREFIXED_IDX).put(&1_u8, 10_u32);
+        db.merge(fork.into_patch()).unwrap();
+    }
+
+    // Column families created with the tuned options can be reopened.
+    let db = RocksDB::open(&dir, &opts).unwrap();
+    let snapshot = db.snapshot();
+    let list = snapshot.get_list::<_, u32>(IDX_NAME);
+    assert_eq!(list.iter().collect::<Vec<_>>(), vec![1, 2, 3]);
+    let map = snapshot.get_map::<_, u8, u32>(PREFIXED_IDX);
+    assert_eq!(map.get(&1), Some(10));
+    assert_eq!(map.get(&2), None);
+}
+
+#[test]
+fn tuned_options_apply_to_reopened_column_families() {
+    let dir = tempfile::TempDir::new().unwrap();
+    {
+        let db = RocksDB::open(&dir, &DbOptions::default()).unwrap();
+        let fork = db.fork();
+        fork.get_list(IDX_NAME).push(1_u32);
+        db.merge(fork.into_patch()).unwrap();
+    }
+
+    let mut opts = DbOptions::default();
+    opts.write_buffer_size = Some(1 << 20);
+    opts.compaction_style = Some(CompactionStyle::Universal);
+    drop(RocksDB::open(&dir, &opts).unwrap());
+
+    // RocksDB persists options of all column families on opening the database.
+    let options_file = fs::read_dir(&dir)
+        .unwrap()
+        .map(|entry| entry.unwrap().file_name().into_string().unwrap())
+        .filter(|name| name.starts_with("OPTIONS-"))
+        .max()
+        .expect("No options file");
+    let options = fs::read_to_string(dir.path().join(options_file)).unwrap();
+
+    let cf_sections: Vec<_> = options.split("[CFOptions ").skip(1).collect();
+    // The `default` column family and column families created by the first instance.
+    assert!(cf_sections.len() > 1);
+    for section in cf_sections {
+        let section = section.split("[TableOptions").next().unwrap();
+        assert!(section.contains("write_buffer_size=1048576"), "{}", section);
+        assert!(
+            section.contains("compaction_style=kCompactionStyleUniversal"),
+            "{}",
+            section
+        );
+    }
+}
+
 #[test]
 fn fork_iter() {
     test_fork_iter(&TemporaryDB::new(), IDX_NAME);
@@ -400,6 +466,91 @@ fn fork_iter_prefixed() {
     test_fork_iter(&TemporaryDB::new(), PREFIXED_IDX);
 }
 
+fn test_fork_iter_in_adjacent_indexes<T: Database>(db: &T) {
+    let fork = db.fork();
+    for &id in &[41, 42, 43, u64::max_value()] {
+        let mut view = View::new(&fork, ("idx", id));
+        view.put(&vec![1], vec![id as u8]);
+        view.put(&vec![2], vec![id as u8]);
+    }
+    db.merge(fork.into_patch()).unwrap();
+
+    let fork = db.fork();
+    let mut view = View::new(&fork, PREFIXED_IDX);
+    view.remove(&vec![2]);
+    view.put(&vec![3], vec![3]);
+    assert_iter(&view, 0, &[(1, 42), (3, 3)]);
+    assert_iter(&view, 2, &[(3, 3)]);
+
+    let view = View::new(&fork, ("idx", u64::max_value()));
+    assert_iter(&view, 0, &[(1, 255), (2, 255)]);
+
+    // Peeking does not advance the iterator.
+    let snapshot = db.snapshot();
+    let view = View::new(&snapshot, PREFIXED_IDX);
+    let mut iter = view.iter_bytes(&[]);
+    assert_eq!(iter.peek(), Some((&[1_u8][..], &[42_u8][..])));
+    assert_eq!(iter.next(), Some((&[1_u8][..], &[42_u8][..])));
+    assert_eq!(iter.peek(), Some((&[2_u8][..], &[42_u8][..])));
+    assert_eq!(iter.peek(), Some((&[2_u8][..], &[42_u8][..])));
+    assert_eq!(iter.next(), Some((&[2_u8][..], &[42_u8][..])));
+    assert_eq!(iter.peek(), None);
+    assert_eq!(iter.next(), None);
+}
+
+#[test]
+fn fork_iter_in_adjacent_indexes() {
+    test_fork_iter_in_adjacent_indexes(&TemporaryDB::new());
+    let dir = tempfile::TempDir::new().unwrap();
+    let db = RocksDB::open(&dir, &DbOptions::default()).unwrap();
+    test_fork_iter_in_adjacent_indexes(&db);
+}
+
+fn test_borrowed_reads<T: Database>(db: &T) {
+    let fork = db.fork();
+    let mut view = View::new(&fork, PREFIXED_IDX);
+    view.put(&1_u8, 10_u64);
+    view.put(&2_u8, "foo".to_owned());
+    view.put(&3_u8, 30_u64);
+    db.merge(fork.into_patch()).unwrap();
+
+    let fork = db.fork();
+    let mut view = View::new(&fork, PREFIXED_IDX);
+    view.put(&1_u8, 11_u64);
+    view.remove(&3_u8);
+    // Values are read both from the fork changes and from the database.
+    assert_eq!(view.get(&1_u8), Some(11_u64));
+    assert_eq!(view.get(&2_u8), Some("foo".to_owned()));
+    assert_eq!(view.get::<_, u64>(&3_u8), None);
+    assert_eq!(view.get::<_, u64>(&4_u8), None);
+    drop(view);
+
+    let patch = fork.into_patch();
+    let address = ResolvedAddress::from(PREFIXED_IDX);
+    let mut values = vec![];
+    for key in 1_u8..=4 {
+        patch.read_value(&address, &[key], &mut |value| {
+            values.push((key, value.into_owned()))
+        });
+    }
+    assert_eq!(values, vec![(1, 11_u64.to_bytes()), (2, b"foo".to_vec())]);
+    db.merge(patch).unwrap();
+
+    let snapshot = db.snapshot();
+    let view = View::new(&snapshot, PREFIXED_IDX);
+    assert_eq!(view.get(&1_u8), Some(11_u64));
+    assert_eq!(view.get(&2_u8), Some("foo".to_owned()));
+    assert_eq!(view.get::<_, u64>(&3_u8), None);
+}
+
+#[test]
+fn borrowed_reads() {
+    test_borrowed_reads(&TemporaryDB::new());
+    let dir = tempfile::TempDir::new().unwrap();
+    let db = RocksDB::open(&dir, &DbOptions::default()).unwrap();
+    test_borrowed_reads(&db);
+}
+
 #[test]
 fn changelog() {
     test_changelog(&TemporaryDB::new(), IDX_NAME);
@@ -0,0 +1,88 @@
+// Copyright 2020 The Exonum Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Tests for the read cache of `RocksDB`.
+
+use exonum_crypto::Hash;
+use exonum_merkledb::{access::CopyAccessExt, Database, DbOptions, ObjectHash, RocksDB};
+use tempfile::TempDir;
+
+fn open_db(dir: &TempDir) -> RocksDB {
+    let options = DbOptions::default().with_read_cache_size(1 << 20);
+    RocksDB::open(dir.path(), &options).unwrap()
+}
+
+#[test]
+fn cached_reads_respect_snapshot_isolation() {
+    let dir = TempDir::new().unwrap();
+    let db = open_db(&dir);
+
+    let fork = db.fork();
+    fork.get_proof_map("map").put(&1_u64, 1_u64);
+    fork.get_proof_map("map").put(&2_u64, 2_u64);
+    db.merge(fork.into_patch()).unwrap();
+
+    let old_snapshot = db.snapshot();
+    let old_hash = old_snapshot
+        .get_proof_map::<_, u64, u64>("map")
+        .object_hash();
+    // Reading the map again should be served from the cache.
+    let old_snapshot_again = db.snapshot();
+    let map = old_snapshot_again.get_proof_map::<_, u64, u64>("map");
+    assert_eq!(map.object_hash(), old_hash);
+    assert!(db.read_cache_stats().unwrap().hits > 0);
+
+    let fork = db.fork();
+    fork.get_proof_map("map").put(&1_u64, 10_u64);
+    fork.get_proof_map::<_, u64, u64>("map").remove(&2_u64);
+    db.merge(fork.into_patch()).unwrap();
+
+    // The old snapshot is not affected by the merged changes.
+    let map = old_snapshot.get_proof_map::<_, u64, u64>("map");
+    assert_eq!(map.get(&1), Some(1));
+    assert_eq!(map.get(&2), Some(2));
+    assert_eq!(map.object_hash(), old_hash);
+
+    let new_snapshot = db.snapshot();
+    let map = new_snapshot.get_proof_map::<_, u64, u64>("map");
+    assert_eq!(map.get(&1), Some(10));
+    assert_eq!(map.get(&2), None);
+    assert_ne!(map.object_hash(), old_hash);
+}
+
+#[test]
+fn cleared_indexes_are_not_cached() {
+    let dir = TempDir::new().unwrap();
+    let db = open_db(&dir);
+
+    let fork = db.fork();
+    fork.get_list("list").extend(vec![Hash::zero(); 10]);
+    db.merge(fork.into_patch()).unwrap();
+    assert_eq!(
+        db.snapshot().get_list::<_, Hash>("list").get(5),
+        Some(Hash::zero())
+    );
+
+    let fork = db.fork();
+    fork.get_list::<_, Hash>("list").clear();
+    db.merge(fork.into_patch()).unwrap();
+    assert_eq!(db.snapshot().get_list::<_, Hash>("list").get(5), None);
+}
+
+#[test]
+fn read_cache_is_disabled_by_default() {
+    let dir = TempDir::new().unwrap();
+    let db = RocksDB::open(dir.path(), &DbOptions::default()).unwrap();
+    assert!(db.read_cache_stats().is_none());
+}
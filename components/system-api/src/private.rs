@@ -21,6 +21,7 @@
 //!
 //! - [Get node info](#get-node-info)
 //! - [Get node statistics](#get-node-statistics)
+//! - [Get node metrics](#get-node-metrics)
 //! - [Add peer](#add-peer)
 //! - [Change consensus status](#change-consensus-status)
 //! - [Node shutdown](#node-shutdown)
@@ -81,6 +82,22 @@
 //! # }
 //! ```
 //!
+//! # Get Node Metrics
+//!
+//! | Property    | Value |
+//! |-------------|-------|
+//! | Path        | `/api/system/v1/metrics` |
+//! | Method      | GET   |
+//! | Query type  | - |
+//! | Return type | Plain text |
+//!
+//! Returns performance metrics of the node (consensus round durations, block execution
+//! and commit times, transaction pool size, etc.) in the text format of [Prometheus],
+//! so that the endpoint can be scraped directly. See [`NodeMetrics`] for details.
+//!
+//! [Prometheus]: https://prometheus.io/docs/instrumenting/exposition_formats/
+//! [`NodeMetrics`]: https://docs.rs/exonum-node/latest/exonum_node/struct.NodeMetrics.html
+//!
 //! # Add Peer
 //!
 //! | Property    | Value |
@@ -317,6 +334,7 @@ impl SystemApi {
     pub fn wire(self, api_scope: &mut ApiScope) -> &mut ApiScope {
         self.handle_info("v1/info", api_scope)
             .handle_stats("v1/stats", api_scope)
+            .handle_metrics("v1/metrics", api_scope)
             .handle_peers("v1/peers", api_scope)
             .handle_consensus_status("v1/consensus_status", api_scope)
             .handle_shutdown("v1/shutdown", api_scope);
@@ -405,6 +423,30 @@ impl SystemApi {
         self
     }
 
+    fn handle_metrics(self, name: &'static str, api_scope: &mut ApiScope) -> Self {
+        // The metrics are returned as plain text rather than JSON, thus a raw handler is used.
+        use actix_web::HttpResponse;
+        use exonum_api::backends::actix::{RawHandler, RequestHandler};
+
+        let shared_api_state = self.shared_api_state.clone();
+        let index = move |_, _| {
+            let metrics = shared_api_state.metrics().to_prometheus();
+            let response = HttpResponse::Ok()
+                .content_type("text/plain; version=0.0.4")
+                .body(metrics);
+            future::ok::<_, actix_web::Error>(response).boxed_local()
+        };
+
+        let handler = RequestHandler {
+            name: name.to_owned(),
+            method: actix_web::http::Method::GET,
+            inner: Arc::new(index) as Arc<RawHandler>,
+        };
+        api_scope.web_backend().raw_handler(handler);
+
+        self
+    }
+
     fn handle_shutdown(self, name: &'static str, api_scope: &mut ApiScope) -> Self {
         // These backend-dependent uses are needed to provide realization of the support of empty
         // request which is not easy in the generic approach, so it will be harder to misuse
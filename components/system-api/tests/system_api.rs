@@ -67,3 +67,18 @@ async fn shutdown() {
         _ => panic!("Unexpected control messages: {:?}", control_messages),
     }
 }
+
+#[tokio::test]
+async fn metrics() {
+    let mut testkit = create_testkit();
+    let api = testkit.api();
+    let url = api.private_url("api/system/v1/metrics");
+    let response = api.client().inner().get(&url).send().await.unwrap();
+    assert!(response.status().is_success());
+    let content_type = response.headers()["content-type"].to_str().unwrap();
+    assert!(content_type.starts_with("text/plain"));
+
+    let metrics = response.text().await.unwrap();
+    assert!(metrics.contains("# TYPE exonum_node_round_duration_seconds histogram\n"));
+    assert!(metrics.contains("exonum_node_tx_pool_size 0\n"));
+}
@@ -15,7 +15,7 @@
 //! Cryptocurrency API.
 
 use exonum::{
-    blockchain::{BlockProof, IndexProof},
+    blockchain::{BlockProof, IndexProof, MultiIndexProof},
     crypto::{Hash, PublicKey},
     messages::{AnyTx, Verified},
     runtime::CallerAddress as Address,
@@ -32,6 +32,53 @@ pub struct WalletQuery {
     pub pub_key: PublicKey,
 }
 
+/// Describes the query parameters for the `get_wallets_proof` endpoint.
+#[derive(Debug, Clone, Serialize, Deserialize, PartialEq)]
+pub struct WalletsQuery {
+    /// Comma-separated public keys of the queried wallets.
+    pub pub_keys: String,
+}
+
+impl WalletsQuery {
+    /// Maximum number of wallets that can be proven with a single request.
+    pub const MAX_WALLETS: usize = 100;
+
+    /// Creates a query for the specified wallets.
+    pub fn new(pub_keys: &[PublicKey]) -> Self {
+        let pub_keys: Vec<_> = pub_keys.iter().map(PublicKey::to_string).collect();
+        Self {
+            pub_keys: pub_keys.join(","),
+        }
+    }
+
+    fn addresses(&self) -> api::Result<Vec<Address>> {
+        let keys_count = self.pub_keys.split(',').count();
+        if keys_count > Self::MAX_WALLETS {
+            let msg = format!(
+                "Number of queried wallets ({}) exceeds the limit ({})",
+                keys_count,
+                Self::MAX_WALLETS
+            );
+            return Err(api::Error::bad_request()
+                .title("Invalid wallets query")
+                .detail(msg));
+        }
+
+        self.pub_keys
+            .split(',')
+            .map(|key| {
+                key.parse::<PublicKey>()
+                    .map(Address::from_key)
+                    .map_err(|err| {
+                        api::Error::bad_request()
+                            .title("Invalid wallets query")
+                            .detail(err.to_string())
+                    })
+            })
+            .collect()
+    }
+}
+
 /// Proof of existence for specific wallet.
 #[derive(Debug, Serialize, Deserialize)]
 pub struct WalletProof {
@@ -110,10 +157,25 @@ impl PublicApi {
         })
     }
 
-    /// Wires the above endpoint to public scope of the given `ServiceApiBuilder`.
+    /// Endpoint for getting a combined proof for several wallets. Unlike `wallet_info`,
+    /// the block header and the shared parts of the proof are returned only once.
+    /// At most `WalletsQuery::MAX_WALLETS` wallets can be queried at once.
+    pub async fn wallets_proof(
+        state: ServiceApiState,
+        query: WalletsQuery,
+    ) -> api::Result<MultiIndexProof<Address, Wallet, Raw>> {
+        let addresses = query.addresses()?;
+        state
+            .data()
+            .proof_for_service_index_entries(vec![("wallets", addresses)])
+            .map_err(|err| api::Error::internal(err).title("Cannot create wallets proof"))
+    }
+
+    /// Wires the above endpoints to public scope of the given `ServiceApiBuilder`.
     pub fn wire(builder: &mut ServiceApiBuilder) {
         builder
             .public_scope()
-            .endpoint("v1/wallets/info", Self::wallet_info);
+            .endpoint("v1/wallets/info", Self::wallet_info)
+            .endpoint("v1/wallets/proof", Self::wallets_proof);
     }
 }
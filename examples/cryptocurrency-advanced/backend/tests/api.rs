@@ -18,13 +18,14 @@
 //! about the storage state.
 
 use exonum::{
-    blockchain::IndexProof,
+    blockchain::{IndexProof, MultiIndexProof},
     crypto::{Hash, KeyPair, PublicKey},
-    merkledb::ObjectHash,
+    merkledb::{proof_map::Raw, BinaryValue, ObjectHash},
     messages::{AnyTx, Verified},
     runtime::{Caller, CallerAddress, SnapshotExt},
 };
 use exonum_explorer_service::ExplorerFactory;
+use exonum_rust_runtime::api::HttpStatusCode;
 use exonum_testkit::{
     explorer::api::{TransactionQuery, TransactionResponse},
     ApiKind, Spec, TestKit, TestKitApi, TestKitBuilder,
@@ -33,7 +34,7 @@ use serde_json::json;
 
 // Import data types used in tests from the crate where the service is defined.
 use exonum_cryptocurrency_advanced::{
-    api::{WalletInfo, WalletQuery},
+    api::{WalletInfo, WalletQuery, WalletsQuery},
     schema::Schema,
     transactions::{CreateWallet, Transfer},
     wallet::Wallet,
@@ -265,6 +266,59 @@ async fn test_unknown_wallet_request() {
     api.assert_no_wallet(tx.author()).await;
 }
 
+/// Check that several wallets can be proven with a single request.
+#[tokio::test]
+async fn test_wallets_proof() {
+    let (mut testkit, api) = create_testkit();
+    let (tx_alice, _) = api.create_wallet(ALICE_NAME).await;
+    let (tx_bob, _) = api.create_wallet(BOB_NAME).await;
+    testkit.create_block();
+
+    let unknown_key = KeyPair::random().public_key();
+    let pub_keys = [tx_alice.author(), tx_bob.author(), unknown_key];
+    let proof: MultiIndexProof<CallerAddress, Wallet, Raw> = api
+        .inner
+        .public(ApiKind::Service(SERVICE_NAME))
+        .query(&WalletsQuery::new(&pub_keys))
+        .get("v1/wallets/proof")
+        .await
+        .unwrap();
+
+    // The binary encoding of the proof should be lossless.
+    let proof =
+        MultiIndexProof::<CallerAddress, Wallet, Raw>::from_bytes(proof.to_bytes().into()).unwrap();
+    let checked_proofs = proof.verify(&api.validator_keys).unwrap();
+    let wallets_proof = &checked_proofs[format!("{}.wallets", SERVICE_NAME).as_str()];
+
+    let mut wallet_names: Vec<_> = wallets_proof
+        .entries()
+        .map(|(_, wallet)| wallet.name.as_str())
+        .collect();
+    wallet_names.sort();
+    assert_eq!(wallet_names, vec![ALICE_NAME, BOB_NAME]);
+    let missing_keys: Vec<_> = wallets_proof.missing_keys().collect();
+    assert_eq!(missing_keys, vec![&CallerAddress::from_key(unknown_key)]);
+}
+
+/// Check that the number of wallets proven with a single request is limited.
+#[tokio::test]
+async fn test_wallets_proof_with_too_many_keys() {
+    let (_testkit, api) = create_testkit();
+    let pub_keys: Vec<_> = (0..=WalletsQuery::MAX_WALLETS)
+        .map(|_| KeyPair::random().public_key())
+        .collect();
+    let err = api
+        .inner
+        .public(ApiKind::Service(SERVICE_NAME))
+        .query(&WalletsQuery::new(&pub_keys))
+        .get::<MultiIndexProof<CallerAddress, Wallet, Raw>>("v1/wallets/proof")
+        .await
+        .unwrap_err();
+
+    assert_eq!(err.http_code, HttpStatusCode::BAD_REQUEST);
+    assert_eq!(err.body.title, "Invalid wallets query");
+}
+
 /// Wrapper for the cryptocurrency service API allowing to easily use it
 /// (compared to `TestKitApi` calls).
 struct CryptocurrencyApi {
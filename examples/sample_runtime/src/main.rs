@@ -263,6 +263,7 @@ fn node_config() -> (NodeConfig, Keys) {
         api: api_cfg,
         mempool: Default::default(),
         thread_pool_size: Default::default(),
+        pruning: None,
     };
     (node_config, keys)
 }
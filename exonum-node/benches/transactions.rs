@@ -156,6 +156,9 @@ impl MessageVerifier {
         let internal_part = InternalPart {
             internal_tx: channel.internal_events.0,
             internal_requests_rx: channel.internal_requests.1,
+            verification_batch_size: 64,
+            blockchain: None,
+            metrics: Arc::default(),
         };
         let network_task = rt.spawn(internal_part.run());
 
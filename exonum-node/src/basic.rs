@@ -12,12 +12,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-use exonum::{crypto::PublicKey, helpers::Height, merkledb::ObjectHash, messages::Verified};
+use exonum::{
+    crypto::PublicKey,
+    helpers::Height,
+    merkledb::ObjectHash,
+    messages::{AnyTx, Verified},
+};
 use log::{error, info, trace};
 use rand::Rng;
 
 use crate::{
-    events::ConnectedPeerAddr,
+    events::{ConnectedPeerAddr, TxPrecheck},
     messages::{Connect, Message, PeersRequest, Responses, Service, Status},
     schema::NodeSchema,
     state::{PeerState, RequestData},
@@ -33,16 +38,7 @@ impl NodeHandler {
 
             Message::Service(Service::Connect(msg)) => self.handle_connect(msg),
             Message::Service(Service::Status(msg)) => self.handle_status(&msg),
-            Message::Service(Service::AnyTx(msg)) => {
-                if let Err(e) = self.handle_tx(msg.clone()) {
-                    log::warn!(
-                        "Failed to process transaction {:?} (hash = `{}`): {}",
-                        msg.payload(),
-                        msg.object_hash(),
-                        e
-                    );
-                }
-            }
+            Message::Service(Service::AnyTx(msg)) => self.handle_peer_tx(msg, None),
 
             Message::Responses(Responses::BlockResponse(msg)) => {
                 self.handle_block(msg);
@@ -59,6 +55,18 @@ impl NodeHandler {
         }
     }
 
+    /// Handles a transaction received from the network.
+    pub(crate) fn handle_peer_tx(&mut self, msg: Verified<AnyTx>, precheck: Option<TxPrecheck>) {
+        if let Err(e) = self.handle_prechecked_tx(msg.clone(), precheck) {
+            log::warn!(
+                "Failed to process transaction {:?} (hash = `{}`): {}",
+                msg.payload(),
+                msg.object_hash(),
+                e
+            );
+        }
+    }
+
     /// Handles the `Connected` event. Node's `Connect` message is sent as response
     /// if received `Connect` message is correct.
     pub(crate) fn handle_connected(
@@ -203,8 +211,10 @@ impl NodeHandler {
 
         // Handle message from future epoch / height.
         if peer_state.blockchain_height > block_height {
-            // Request a block with the next height.
-            self.request(RequestData::Block(block_height), peer);
+            // Request a block with the next height, unless the peer has pruned it.
+            if peer_state.can_provide_block(block_height) {
+                self.request(RequestData::Block(block_height), peer);
+            }
         } else if peer_state.epoch > epoch {
             // Request a block with the next height or a block skip with a larger epoch.
             let data = RequestData::BlockOrEpoch {
@@ -273,6 +283,8 @@ impl NodeHandler {
     /// Node update internal `ApiState` and `NodeRole`.
     pub(crate) fn handle_update_api_state_timeout(&mut self) {
         self.api_state.update_node_state(&self.state);
+        let pool_size = self.blockchain.as_ref().pool_size();
+        self.api_state.metrics().set_tx_pool_len(pool_size);
         // FIXME Add special event to update state [ECR-3222]
         self.node_role = NodeRole::new(self.state.validator_id());
         self.add_update_api_state_timeout();
@@ -285,6 +297,7 @@ impl NodeHandler {
             blockchain_height: self.state.blockchain_height(),
             last_hash: self.blockchain.as_ref().last_hash(),
             pool_size: self.uncommitted_txs_count(),
+            first_retained_height: self.first_retained_height,
         };
         trace!("Broadcast status: {:?}", status);
 
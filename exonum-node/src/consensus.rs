@@ -26,10 +26,10 @@ use exonum::{
 };
 use log::{error, info, trace, warn};
 
-use std::{collections::HashSet, convert::TryFrom, fmt};
+use std::{collections::HashSet, convert::TryFrom, fmt, time::Instant};
 
 use crate::{
-    events::InternalRequest,
+    events::{InternalRequest, TxPrecheck},
     messages::{
         BlockRequest, BlockResponse, Consensus as ConsensusMessage, PoolTransactionsRequest,
         Prevote, PrevotesRequest, Propose, ProposeRequest, TransactionsRequest,
@@ -197,7 +197,7 @@ impl NodeHandler {
         let has_unknown_txs = match self.state.add_propose(
             msg.clone(),
             &schema.transactions(),
-            &schema.transactions_pool(),
+            &schema.transactions_locations(),
         ) {
             Ok(state) => state.has_unknown_txs(),
             Err(err) => {
@@ -302,6 +302,11 @@ impl NodeHandler {
     /// If the node knows all transactions right away, it executes and commits the block.
     /// (The execution stage may be skipped if the block was executed earlier.)
     pub(crate) fn handle_block(&mut self, msg: Verified<BlockResponse>) {
+        if msg.payload().block.height > self.state.blockchain_height() {
+            self.queue_block(msg);
+            return;
+        }
+
         let precommits = match self.validate_block_response(&msg) {
             Ok(precommits) => precommits,
             Err(e) => {
@@ -309,8 +314,15 @@ impl NodeHandler {
                 return;
             }
         };
-        // At this point, the block is valid.
+        self.handle_valid_block(msg, precommits);
+    }
 
+    /// Handles a `BlockResponse` message which has passed `validate_block_response`.
+    fn handle_valid_block(
+        &mut self,
+        msg: Verified<BlockResponse>,
+        precommits: Vec<Verified<Precommit>>,
+    ) {
         let sender = msg.author();
         let BlockResponse {
             block,
@@ -348,6 +360,29 @@ impl NodeHandler {
         }
     }
 
+    /// Saves a block for a future height, which was received as a part of a batched
+    /// `BlockResponse`. The block is validated and committed once the node reaches its height.
+    fn queue_block(&mut self, msg: Verified<BlockResponse>) {
+        if msg.payload().to != self.state.keys().consensus_pk()
+            || !self.state.connect_list().is_peer_allowed(&msg.author())
+        {
+            log::error!("Received incorrect block {:?}", msg.payload());
+            return;
+        }
+
+        let block_height = msg.payload().block.height;
+        if self.state.add_queued_block(msg) {
+            trace!("Queued block at height {}", block_height);
+        } else {
+            log::error!(
+                "Received block has inappropriate height {} or is already queued, \
+                 our height is {}",
+                block_height,
+                self.state.blockchain_height()
+            );
+        }
+    }
+
     /// Checks if propose is correct (doesn't contain invalid transactions), and then
     /// broadcasts a prevote for this propose.
     ///
@@ -734,10 +769,18 @@ impl NodeHandler {
             "Cannot clear consensus messages",
         );
 
+        let commit_start = Instant::now();
         self.blockchain
             .commit(block_state.patch(), precommits)
             .expect("Cannot commit block");
 
+        let metrics = self.api_state.metrics();
+        metrics.observe_block_commit(commit_start.elapsed(), committed_txs_len);
+        metrics.observe_round(self.state.round_elapsed());
+        if let Some(propose_time) = self.state.first_propose_time() {
+            metrics.observe_propose_to_commit(propose_time.elapsed());
+        }
+
         match block_kind {
             BlockKind::Normal => {
                 // Update node state.
@@ -784,6 +827,13 @@ impl NodeHandler {
                 .expect("Cannot save changes to transaction pool");
         }
 
+        if let Some(pruning) = self.pruning {
+            self.first_retained_height = self
+                .blockchain
+                .prune_history(pruning.retained_blocks)
+                .expect("Cannot prune blockchain history");
+        }
+
         let schema = Schema::new(&snapshot);
         let pool_len = schema.transactions_pool_len();
         let epoch = self.state.epoch();
@@ -830,6 +880,16 @@ impl NodeHandler {
     ///
     /// This function panics if it receives an invalid transaction for an already committed block.
     pub(crate) fn handle_tx(&mut self, msg: Verified<AnyTx>) -> Result<(), HandleTxError> {
+        self.handle_prechecked_tx(msg, None)
+    }
+
+    /// Same as `handle_tx`, but reuses the result of `Blockchain::check_tx` obtained outside
+    /// of the handler if the result is still actual.
+    pub(crate) fn handle_prechecked_tx(
+        &mut self,
+        msg: Verified<AnyTx>,
+        precheck: Option<TxPrecheck>,
+    ) -> Result<(), HandleTxError> {
         let hash = msg.object_hash();
         if self.state.tx_cache().contains_key(&hash) {
             // Transaction is already in the ephemeral transaction cache, i.e.,
@@ -843,10 +903,21 @@ impl NodeHandler {
             // Transaction is either committed or is present in the persistent pool.
             return Err(HandleTxError::AlreadyProcessed);
         }
+        if self.first_retained_height > Height(0) && schema.transactions_locations().contains(&hash)
+        {
+            // Transaction is committed, but its body was pruned.
+            return Err(HandleTxError::AlreadyProcessed);
+        }
 
         let outcome;
-        let tx_check_cache = self.state.tx_check_cache_mut();
-        if let Err(e) = Blockchain::check_tx_with_cache(&snapshot, &msg, tx_check_cache) {
+        let check_result = match precheck {
+            Some(precheck) if precheck.next_height == schema.next_height() => precheck.result,
+            _ => {
+                let tx_check_cache = self.state.tx_check_cache_mut();
+                Blockchain::check_tx_with_cache(&snapshot, &msg, tx_check_cache)
+            }
+        };
+        if let Err(e) = check_result {
             // Store transaction as invalid to know it if it'll be included into a proposal.
             // Please note that it **must** happen before calling `check_incomplete_proposes`,
             // since the latter uses `invalid_txs` to recalculate the validity of proposals.
@@ -958,6 +1029,9 @@ impl NodeHandler {
         }
 
         info!("Jump to a new round = {}", round);
+        self.api_state
+            .metrics()
+            .observe_round(self.state.round_elapsed());
         self.state.jump_round(round);
         self.add_round_timeout();
         self.process_new_round();
@@ -994,6 +1068,9 @@ impl NodeHandler {
         warn!("ROUND TIMEOUT epoch={}, round={}", epoch, round);
 
         // Update the node state to the new round.
+        self.api_state
+            .metrics()
+            .observe_round(self.state.round_elapsed());
         self.state.new_round();
         // Add a timeout for this round.
         self.add_round_timeout();
@@ -1042,6 +1119,15 @@ impl NodeHandler {
         self.broadcast(propose.clone());
         self.allow_expedited_propose = true;
 
+        // Push transactions to the peers which are likely to miss some of them,
+        // so that they do not need to request the transactions before voting.
+        let tx_hashes = &propose.payload().transactions;
+        if !tx_hashes.is_empty() {
+            for peer in self.state.peers_lacking_txs() {
+                self.send_transactions_by_hash(peer, tx_hashes);
+            }
+        }
+
         // Save our propose into the state.
         let hash = self.state.add_self_propose(propose, &mut self.blockchain);
 
@@ -1058,7 +1144,7 @@ impl NodeHandler {
 
         let snapshot = self.blockchain.snapshot();
         let pool = PersistentPool::new(snapshot.as_ref(), self.state.tx_cache());
-        let params = ProposeParams::new(self.state(), &snapshot);
+        let params = ProposeParams::new(self.state(), &snapshot, self.blockchain.execution_costs());
         self.pool_manager.propose_block(pool, params)
     }
 
@@ -1121,7 +1207,13 @@ impl NodeHandler {
                     .into(),
 
                 RequestData::Block(height) => {
-                    self.sign_message(BlockRequest::new(peer, height)).into()
+                    let count = self.block_request_count(&peer, height);
+                    let request = if count > 1 {
+                        BlockRequest::with_count(peer, height, count)
+                    } else {
+                        BlockRequest::new(peer, height)
+                    };
+                    self.sign_message(request).into()
                 }
 
                 RequestData::BlockOrEpoch {
@@ -1144,9 +1236,20 @@ impl NodeHandler {
         epoch: Height,
         contents: BlockContents<'_>,
     ) -> BlockPatch {
+        let tx_count = match contents {
+            BlockContents::Transactions(tx_hashes) => tx_hashes.len(),
+            _ => 0,
+        };
         let block_params = BlockParams::with_contents(contents, proposer_id, epoch);
-        self.blockchain
-            .create_patch(block_params, self.state.tx_cache())
+
+        let start = Instant::now();
+        let patch = self
+            .blockchain
+            .create_patch(block_params, self.state.tx_cache());
+        self.api_state
+            .metrics()
+            .observe_block_execution(start.elapsed(), tx_count);
+        patch
     }
 
     /// Calls `create_block` with transactions from the corresponding `Propose` and returns the
@@ -1212,13 +1315,46 @@ impl NodeHandler {
             return;
         }
 
+        // Blocks from batched responses are processed without additional requests.
+        let mut invalid_block_sender = None;
+        if let Some(block) = self.state.take_queued_block() {
+            match self.validate_block_response(&block) {
+                Ok(precommits) => {
+                    self.handle_valid_block(block, precommits);
+                    return;
+                }
+                Err(e) => {
+                    log::error!("Queued block {:?} is incorrect: {}", block.payload(), e);
+                    invalid_block_sender = Some(block.author());
+                }
+            }
+        }
+
         // TODO: Randomize next peer. (ECR-171)
-        let peers = self.state.advanced_peers();
+        let mut peers = self.state.advanced_peers();
+        if let Some(invalid_block_sender) = invalid_block_sender {
+            // Request the block from other peers first. The sort is stable, so the order
+            // of other peers is retained.
+            peers
+                .peers_with_greater_height
+                .sort_by_key(|peer| *peer == invalid_block_sender);
+        }
         if let Some((peer, data)) = peers.send_message(&self.state) {
             self.request(data, peer);
         }
     }
 
+    /// Returns the number of blocks to request from the peer starting from the given height.
+    fn block_request_count(&self, peer: &PublicKey, height: Height) -> u32 {
+        let available_blocks = self
+            .state
+            .peer_height(peer)
+            .map_or(1, |peer_height| peer_height.0.saturating_sub(height.0));
+        let window = u64::from(self.state.block_sync_window());
+        // The conversion is lossless since the value does not exceed `window`.
+        available_blocks.min(window).max(1) as u32
+    }
+
     /// Removes the specified request from the pending request list.
     fn remove_request(&mut self, data: &RequestData) -> HashSet<PublicKey> {
         // TODO: Clear timeout. (ECR-171)
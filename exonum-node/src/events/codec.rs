@@ -14,11 +14,8 @@
 
 use anyhow::bail;
 use byteorder::{ByteOrder, LittleEndian};
-use bytes::BytesMut;
-use exonum::{
-    merkledb::BinaryValue,
-    messages::{SignedMessage, SIGNED_MESSAGE_MIN_SIZE},
-};
+use bytes::{Bytes, BytesMut};
+use exonum::messages::SIGNED_MESSAGE_MIN_SIZE;
 use tokio_util::codec::{Decoder, Encoder};
 
 use std::mem;
@@ -74,22 +71,24 @@ impl Decoder for MessagesCodec {
             )
         }
 
-        Ok(Some(buf.to_vec()))
+        Ok(Some(buf))
     }
 }
 
-impl Encoder<SignedMessage> for MessagesCodec {
+/// Encodes serialized `SignedMessage`s. Messages are serialized before being sent
+/// to a connection, so that a broadcast message is serialized only once.
+impl Encoder<Bytes> for MessagesCodec {
     type Error = anyhow::Error;
 
-    fn encode(&mut self, msg: SignedMessage, buf: &mut BytesMut) -> Result<(), Self::Error> {
-        self.session.encrypt_msg(&msg.into_bytes(), buf)?;
+    fn encode(&mut self, msg: Bytes, buf: &mut BytesMut) -> Result<(), Self::Error> {
+        self.session.encrypt_msg(&msg, buf)?;
         Ok(())
     }
 }
 
 #[cfg(test)]
 mod test {
-    use bytes::BytesMut;
+    use bytes::{Bytes, BytesMut};
     use exonum::{
         crypto::{Hash, KeyPair},
         helpers::Height,
@@ -190,8 +189,12 @@ mod test {
         let data = raw.to_bytes();
 
         let mut bytes: BytesMut = BytesMut::new();
-        initiator.encode(raw.clone(), &mut bytes).unwrap();
-        initiator.encode(raw, &mut bytes).unwrap();
+        initiator
+            .encode(Bytes::from(data.clone()), &mut bytes)
+            .unwrap();
+        initiator
+            .encode(Bytes::from(data.clone()), &mut bytes)
+            .unwrap();
 
         match responder.decode_eof(&mut bytes.clone()) {
             Ok(Some(ref message)) if *message == data => {}
@@ -12,14 +12,23 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-use exonum::{merkledb::BinaryValue, messages::SignedMessage};
+use exonum::{
+    blockchain::{Blockchain, Schema, TxCheckCache},
+    merkledb::BinaryValue,
+    messages::SignedMessage,
+};
 use futures::{channel::mpsc, prelude::*};
 use tokio::{task, time::delay_for};
 
-use std::time::{Duration, SystemTime};
+use std::{
+    sync::Arc,
+    time::{Duration, Instant, SystemTime},
+};
 
+use super::TxPrecheck;
 use crate::{
-    messages::{ExonumMessage, Message},
+    messages::{ExonumMessage, Message, Service},
+    metrics::NodeMetrics,
     InternalEvent, InternalRequest, TimeoutRequest,
 };
 
@@ -30,6 +39,13 @@ pub struct InternalPart {
     pub internal_tx: mpsc::Sender<InternalEvent>,
     /// Receiver of internal requests.
     pub internal_requests_rx: mpsc::Receiver<InternalRequest>,
+    /// Maximum number of messages verified within a single blocking task.
+    pub verification_batch_size: usize,
+    /// Blockchain used to check verified transactions before passing them to the node handler.
+    /// If not set, transactions are checked by the handler itself.
+    pub blockchain: Option<Blockchain>,
+    /// Node metrics updated with the message verification latency.
+    pub metrics: Arc<NodeMetrics>,
 }
 
 impl InternalPart {
@@ -39,23 +55,98 @@ impl InternalPart {
         sender.send(event).await.ok();
     }
 
-    async fn verify_message(raw: Vec<u8>, internal_tx: mpsc::Sender<InternalEvent>) {
-        let task = task::spawn_blocking(|| {
-            SignedMessage::from_bytes(raw.into())
-                .and_then(SignedMessage::into_verified::<ExonumMessage>)
-                .map(Message::from)
+    fn verify_message(raw: Vec<u8>) -> Option<Message> {
+        SignedMessage::from_bytes(raw.into())
+            .and_then(SignedMessage::into_verified::<ExonumMessage>)
+            .map(Message::from)
+            .ok()
+    }
+
+    /// Verifies a batch of messages within a single blocking task. Messages with incorrect
+    /// signatures are dropped; this does not influence the processing of other messages
+    /// in the batch.
+    ///
+    /// If the `blockchain` is specified, transactions in the batch are additionally checked
+    /// against a single snapshot, so that the node handler only needs to check whether
+    /// the result is still actual.
+    async fn verify_messages(
+        batch: Vec<Vec<u8>>,
+        blockchain: Option<Blockchain>,
+        metrics: Arc<NodeMetrics>,
+        mut internal_tx: mpsc::Sender<InternalEvent>,
+    ) {
+        let task = task::spawn_blocking(move || {
+            let start = Instant::now();
+            let batch_size = batch.len();
+            let messages: Vec<_> = batch.into_iter().filter_map(Self::verify_message).collect();
+            metrics.observe_verification(start.elapsed(), batch_size);
+
+            let messages = messages.into_iter();
+            if let Some(blockchain) = blockchain {
+                Self::check_transactions(&blockchain, messages)
+            } else {
+                messages.map(InternalEvent::message_verified).collect()
+            }
         });
-        if let Ok(Ok(msg)) = task.await {
-            let event = InternalEvent::message_verified(msg);
-            Self::send_event(internal_tx, event).await;
+
+        if let Ok(events) = task.await {
+            for event in events {
+                if internal_tx.send(event).await.is_err() {
+                    // The node is being terminated.
+                    break;
+                }
+            }
         }
     }
 
+    fn check_transactions(
+        blockchain: &Blockchain,
+        messages: impl Iterator<Item = Message>,
+    ) -> Vec<InternalEvent> {
+        let mut snapshot = None;
+        let mut cache = TxCheckCache::new();
+        messages
+            .map(|msg| match msg {
+                Message::Service(Service::AnyTx(tx)) => {
+                    let snapshot = snapshot.get_or_insert_with(|| blockchain.snapshot());
+                    let precheck = TxPrecheck {
+                        next_height: Schema::new(snapshot.as_ref()).next_height(),
+                        result: Blockchain::check_tx_with_cache(snapshot.as_ref(), &tx, &mut cache),
+                    };
+                    InternalEvent::transaction_checked(tx, precheck)
+                }
+                msg => InternalEvent::message_verified(msg),
+            })
+            .collect()
+    }
+
+    /// Moves verification requests already queued in the channel into the `batch`, until
+    /// the batch is full. Does not wait for new requests to arrive, so batching does not
+    /// increase message latency. Returns the first encountered request of another kind, if any.
+    fn fill_verification_batch(&mut self, batch: &mut Vec<Vec<u8>>) -> Option<InternalRequest> {
+        while batch.len() < self.verification_batch_size {
+            match self.internal_requests_rx.try_next() {
+                Ok(Some(InternalRequest::VerifyMessage(raw))) => batch.push(raw),
+                Ok(Some(other_request)) => return Some(other_request),
+                // The channel is either empty or closed.
+                Ok(None) | Err(_) => break,
+            }
+        }
+        None
+    }
+
     /// Represents a task that processes internal requests and produces internal events.
-    /// `handle` is used to schedule additional tasks within this task.
-    /// `verify_executor` is where transaction verification tasks are executed.
     pub async fn run(mut self) {
-        while let Some(request) = self.internal_requests_rx.next().await {
+        let mut postponed_request = None;
+        loop {
+            let request = if let Some(request) = postponed_request.take() {
+                request
+            } else if let Some(request) = self.internal_requests_rx.next().await {
+                request
+            } else {
+                break;
+            };
+
             // Check if the receiver of internal events has hanged up. If so, terminate
             // event processing immediately since the generated events will be dropped anyway.
             if self.internal_tx.is_closed() {
@@ -65,7 +156,12 @@ impl InternalPart {
 
             match request {
                 InternalRequest::VerifyMessage(raw) => {
-                    tokio::spawn(Self::verify_message(raw, internal_tx));
+                    let mut batch = vec![raw];
+                    postponed_request = self.fill_verification_batch(&mut batch);
+                    let blockchain = self.blockchain.clone();
+                    let metrics = Arc::clone(&self.metrics);
+                    let task = Self::verify_messages(batch, blockchain, metrics, internal_tx);
+                    tokio::spawn(task);
                 }
 
                 InternalRequest::Timeout(TimeoutRequest(time, timeout)) => {
@@ -91,33 +187,55 @@ impl InternalPart {
 #[cfg(test)]
 mod tests {
     use exonum::{
+        blockchain::Blockchain,
         crypto::{Hash, KeyPair, Signature},
         helpers::Height,
         merkledb::BinaryValue,
-        messages::{SignedMessage, Verified},
+        messages::{AnyTx, SignedMessage, Verified},
+        runtime::{CallInfo, CoreError, ErrorMatch},
     };
     use futures::{channel::mpsc, SinkExt, StreamExt};
     use pretty_assertions::assert_eq;
 
+    use std::sync::Arc;
+
     use crate::{
+        events::InternalEventInner,
         messages::{Message, Status},
         InternalEvent, InternalPart, InternalRequest,
     };
 
-    async fn verify_message(msg: Vec<u8>) -> Option<InternalEvent> {
-        let (internal_tx, mut internal_rx) = mpsc::channel(16);
+    async fn verify_messages(messages: Vec<Vec<u8>>) -> Vec<InternalEvent> {
+        verify_and_check_messages(messages, None).await
+    }
+
+    async fn verify_and_check_messages(
+        messages: Vec<Vec<u8>>,
+        blockchain: Option<Blockchain>,
+    ) -> Vec<InternalEvent> {
+        let (internal_tx, internal_rx) = mpsc::channel(16);
         let (mut internal_requests_tx, internal_requests_rx) = mpsc::channel(16);
 
+        // Queue requests before starting `internal_part` so that they are verified in a batch.
+        for msg in messages {
+            let request = InternalRequest::VerifyMessage(msg);
+            internal_requests_tx.send(request).await.unwrap();
+        }
+        drop(internal_requests_tx); // force the `internal_part` to stop
+
         let internal_part = InternalPart {
             internal_tx,
             internal_requests_rx,
+            verification_batch_size: 4,
+            blockchain,
+            metrics: Arc::default(),
         };
         tokio::spawn(internal_part.run());
+        internal_rx.collect().await
+    }
 
-        let request = InternalRequest::VerifyMessage(msg);
-        internal_requests_tx.send(request).await.unwrap();
-        drop(internal_requests_tx); // force the `internal_part` to stop
-        internal_rx.next().await
+    async fn verify_message(msg: Vec<u8>) -> Option<InternalEvent> {
+        verify_messages(vec![msg]).await.pop()
     }
 
     fn get_signed_message() -> SignedMessage {
@@ -146,4 +264,59 @@ mod tests {
         let event = verify_message(tx.into_bytes()).await;
         assert_eq!(event, None);
     }
+
+    #[tokio::test]
+    async fn verify_msg_batch() {
+        let mut incorrect_tx = get_signed_message();
+        incorrect_tx.signature = Signature::zero();
+        let correct_txs: Vec<_> = (0..6).map(|_| get_signed_message()).collect();
+
+        let mut messages: Vec<_> = correct_txs
+            .iter()
+            .cloned()
+            .map(SignedMessage::into_bytes)
+            .collect();
+        messages.insert(2, incorrect_tx.into_bytes());
+        let events = verify_messages(messages).await;
+
+        // Batches are verified concurrently, so the order of events is not guaranteed.
+        assert_eq!(events.len(), correct_txs.len());
+        for tx in correct_txs {
+            let expected_event = InternalEvent::message_verified(Message::from_signed(tx).unwrap());
+            assert!(events.contains(&expected_event));
+        }
+    }
+
+    #[tokio::test]
+    async fn transactions_are_checked_against_blockchain() {
+        let keys = KeyPair::random();
+        let tx = AnyTx::new(CallInfo::new(100, 0), vec![]).sign_with_keypair(&keys);
+        let status = get_signed_message();
+        let messages = vec![
+            tx.clone().into_raw().into_bytes(),
+            status.clone().into_bytes(),
+        ];
+
+        let blockchain = Blockchain::build_for_tests();
+        let events = verify_and_check_messages(messages, Some(blockchain)).await;
+        assert_eq!(events.len(), 2);
+
+        let expected_event = InternalEvent::message_verified(Message::from_signed(status).unwrap());
+        assert!(events.contains(&expected_event));
+        let precheck = events
+            .into_iter()
+            .find_map(|event| match event.0 {
+                InternalEventInner::TransactionChecked(checked_tx, precheck) => {
+                    assert_eq!(*checked_tx, tx);
+                    Some(precheck)
+                }
+                _ => None,
+            })
+            .expect("Transaction was not checked");
+
+        // The blockchain has no services, so the transaction is incorrect.
+        assert_eq!(precheck.next_height, Height(0));
+        let err = precheck.result.unwrap_err();
+        assert_eq!(err, ErrorMatch::from_fail(&CoreError::IncorrectInstanceId));
+    }
 }
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+pub(crate) use self::network::OutgoingQueue;
 pub use self::{
     internal::InternalPart,
     network::{ConnectedPeerAddr, NetworkEvent, NetworkPart, NetworkRequest},
@@ -25,7 +26,9 @@ mod noise;
 
 use exonum::{
     helpers::{Height, Round},
+    merkledb::BinaryValue,
     messages::{AnyTx, Verified},
+    runtime::ExecutionError,
 };
 use futures::{channel::mpsc, prelude::*};
 
@@ -118,8 +121,18 @@ impl InternalEvent {
         Self(InternalEventInner::MessageVerified(Box::new(message)))
     }
 
+    pub(crate) fn transaction_checked(tx: Verified<AnyTx>, precheck: TxPrecheck) -> Self {
+        Self(InternalEventInner::TransactionChecked(
+            Box::new(tx),
+            precheck,
+        ))
+    }
+
     pub fn is_message_verified(&self) -> bool {
-        matches!(self.0, InternalEventInner::MessageVerified(_))
+        matches!(
+            self.0,
+            InternalEventInner::MessageVerified(_) | InternalEventInner::TransactionChecked(..)
+        )
     }
 
     pub(crate) fn timeout(timeout: NodeTimeout) -> Self {
@@ -136,6 +149,31 @@ pub enum InternalEventInner {
     /// Message has been successfully verified.
     /// Message is boxed here so that enum variants have similar size.
     MessageVerified(Box<Message>),
+    /// Transaction has been successfully verified and checked against a blockchain snapshot.
+    TransactionChecked(Box<Verified<AnyTx>>, TxPrecheck),
+}
+
+/// Result of `Blockchain::check_tx` performed outside of the node handler.
+#[derive(Debug, Clone)]
+pub struct TxPrecheck {
+    /// Height of the next block at the moment of the check. Service statuses can change
+    /// only on a block commit, so the result remains actual while this height is not reached.
+    pub(crate) next_height: Height,
+    /// Outcome of the check.
+    pub(crate) result: Result<(), ExecutionError>,
+}
+
+impl PartialEq for TxPrecheck {
+    fn eq(&self, other: &Self) -> bool {
+        // `ExecutionError` does not implement `PartialEq`, so errors are compared
+        // by their binary representation.
+        let results_match = match (&self.result, &other.result) {
+            (Ok(()), Ok(())) => true,
+            (Err(err), Err(other_err)) => err.to_bytes() == other_err.to_bytes(),
+            _ => false,
+        };
+        self.next_height == other.next_height && results_match
+    }
 }
 
 /// Asynchronous requests for internal actions.
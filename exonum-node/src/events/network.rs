@@ -13,11 +13,13 @@
 // limitations under the License.
 
 use anyhow::{bail, ensure, format_err};
+use bytes::Bytes;
 use exonum::{
     crypto::{
         x25519::{self, into_x25519_public_key},
         PublicKey,
     },
+    merkledb::BinaryValue,
     messages::{SignedMessage, Verified},
 };
 use futures::{channel::mpsc, future, prelude::*};
@@ -31,7 +33,10 @@ use std::{
     io,
     net::SocketAddr,
     ops,
-    sync::{Arc, RwLock},
+    sync::{
+        atomic::{AtomicU64, AtomicUsize, Ordering},
+        Arc, RwLock,
+    },
     time::Duration,
 };
 
@@ -41,11 +46,15 @@ use crate::{
         noise::{Handshake, HandshakeData, HandshakeParams, NoiseHandshake},
     },
     messages::{Connect, Message, Service},
+    metrics::NodeMetrics,
     state::SharedConnectList,
     NetworkConfiguration,
 };
 
 const OUTGOING_CHANNEL_SIZE: usize = 10;
+/// Maximum number of messages in the outgoing queue of a connection. If the queue
+/// is longer, broadcast messages to the peer are dropped.
+const MAX_OUTGOING_QUEUE_LEN: usize = 512;
 
 #[derive(Debug)]
 struct ErrorAction {
@@ -122,6 +131,9 @@ pub enum NetworkEvent {
 #[derive(Debug, Clone)]
 pub enum NetworkRequest {
     SendMessage(PublicKey, SignedMessage),
+    /// Sends a message to several peers. The message is serialized once and is dropped
+    /// for the peers with the full outgoing queue.
+    Broadcast(Vec<PublicKey>, SignedMessage),
     #[cfg(test)]
     DisconnectWithPeer(PublicKey),
 }
@@ -135,11 +147,62 @@ pub struct NetworkPart {
     pub network_requests: mpsc::Receiver<NetworkRequest>,
     pub network_tx: mpsc::Sender<NetworkEvent>,
     pub(crate) connect_list: SharedConnectList,
+    pub(crate) metrics: Arc<NodeMetrics>,
+}
+
+/// Length and statistics of the outgoing message queue of a connection.
+#[derive(Debug, Default)]
+pub(crate) struct OutgoingQueue {
+    /// Number of messages sent to the connection, but not yet written to the socket.
+    len: AtomicUsize,
+    /// Number of broadcast messages dropped because the queue was full.
+    dropped: AtomicU64,
+}
+
+impl OutgoingQueue {
+    fn push(&self) {
+        self.len.fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Reserves a place for a broadcast message in the queue. Returns `false` and
+    /// records a dropped message if the queue is full.
+    fn try_push(&self, peer_key: &PublicKey) -> bool {
+        let len = self.len.load(Ordering::Relaxed);
+        if len < MAX_OUTGOING_QUEUE_LEN {
+            self.push();
+            return true;
+        }
+
+        let dropped = self.dropped.fetch_add(1, Ordering::Relaxed) + 1;
+        if dropped == 1 || dropped % 100 == 0 {
+            log::warn!(
+                "Outgoing queue to peer {} is full ({} messages); {} broadcast messages \
+                 have been dropped",
+                peer_key,
+                len,
+                dropped
+            );
+        }
+        false
+    }
+
+    fn pop(&self) {
+        self.len.fetch_sub(1, Ordering::Relaxed);
+    }
+
+    pub(crate) fn len(&self) -> usize {
+        self.len.load(Ordering::Relaxed)
+    }
+
+    pub(crate) fn dropped(&self) -> u64 {
+        self.dropped.load(Ordering::Relaxed)
+    }
 }
 
 #[derive(Clone, Debug)]
 struct ConnectionPoolEntry {
-    sender: mpsc::Sender<SignedMessage>,
+    sender: mpsc::Sender<Bytes>,
+    queue: Arc<OutgoingQueue>,
     address: ConnectedPeerAddr,
     // Connection ID assigned to the connection during instantiation. This ID is unique among
     // all connections and is used in `ConnectList::remove()` to figure out whether
@@ -153,9 +216,9 @@ struct SharedConnectionPool {
 }
 
 impl SharedConnectionPool {
-    fn new(our_key: PublicKey) -> Self {
+    fn new(our_key: PublicKey, metrics: Arc<NodeMetrics>) -> Self {
         Self {
-            inner: Arc::new(RwLock::new(ConnectionPool::new(our_key))),
+            inner: Arc::new(RwLock::new(ConnectionPool::new(our_key, metrics))),
         }
     }
 
@@ -167,23 +230,56 @@ impl SharedConnectionPool {
         self.inner.write().unwrap()
     }
 
-    async fn send_message(&self, peer_key: &PublicKey, message: SignedMessage) {
+    async fn send_message(&self, peer_key: &PublicKey, message: Bytes) {
         let maybe_peer_info = {
             // Ensure that we don't hold the lock across the `await` point.
             let peers = &self.inner.read().unwrap().peers;
             peers
                 .get(peer_key)
-                .map(|peer| (peer.sender.clone(), peer.id))
+                .map(|peer| (peer.sender.clone(), Arc::clone(&peer.queue), peer.id))
         };
 
-        if let Some((mut sender, connection_id)) = maybe_peer_info {
+        if let Some((mut sender, queue, connection_id)) = maybe_peer_info {
+            queue.push();
             if sender.send(message).await.is_err() {
+                queue.pop();
                 log::warn!("Cannot send message to peer {}", peer_key);
                 self.write().remove(peer_key, Some(connection_id));
             }
         }
     }
 
+    /// Puts a broadcast message into the outgoing queue of a peer without waiting.
+    /// If the queue is full, the message is dropped.
+    ///
+    /// # Return value
+    ///
+    /// Returns `false` if there is no connection with the peer.
+    fn enqueue_broadcast(&self, peer_key: &PublicKey, message: Bytes) -> bool {
+        let connection_id = {
+            let peers = &self.read().peers;
+            let peer = match peers.get(peer_key) {
+                Some(peer) => peer,
+                None => return false,
+            };
+            if !peer.queue.try_push(peer_key) {
+                return true;
+            }
+
+            // A cloned sender always has a free slot in the channel, so the message
+            // is only rejected if the connection is closed.
+            if peer.sender.clone().try_send(message).is_ok() {
+                return true;
+            }
+            peer.queue.pop();
+            peer.id
+        };
+
+        log::warn!("Cannot send message to peer {}", peer_key);
+        self.write().remove(peer_key, Some(connection_id));
+        true
+    }
+
     fn create_connection(
         &self,
         peer_key: PublicKey,
@@ -197,10 +293,11 @@ impl SharedConnectionPool {
             return None;
         }
 
-        let (receiver_rx, connection_id) = guard.add(peer_key, address.clone());
+        let (receiver_rx, queue, connection_id) = guard.add(peer_key, address.clone());
         Some(Connection {
             socket,
             receiver_rx,
+            queue,
             address,
             key: peer_key,
             id: connection_id,
@@ -220,14 +317,16 @@ struct ConnectionPool {
     peers: HashMap<PublicKey, ConnectionPoolEntry>,
     our_key: PublicKey,
     next_connection_id: u64,
+    metrics: Arc<NodeMetrics>,
 }
 
 impl ConnectionPool {
-    fn new(our_key: PublicKey) -> Self {
+    fn new(our_key: PublicKey, metrics: Arc<NodeMetrics>) -> Self {
         Self {
             peers: HashMap::new(),
             our_key,
             next_connection_id: 0,
+            metrics,
         }
     }
 
@@ -249,23 +348,27 @@ impl ConnectionPool {
     ///
     /// # Return value
     ///
-    /// Returns the receiver for outgoing messages to the peer and the connection ID.
+    /// Returns the receiver for outgoing messages to the peer, the statistics of the outgoing
+    /// queue and the connection ID.
     fn add(
         &mut self,
         key: PublicKey,
         address: ConnectedPeerAddr,
-    ) -> (mpsc::Receiver<SignedMessage>, u64) {
+    ) -> (mpsc::Receiver<Bytes>, Arc<OutgoingQueue>, u64) {
         let id = self.next_connection_id;
         let (sender, receiver_rx) = mpsc::channel(OUTGOING_CHANNEL_SIZE);
+        let queue = Arc::new(OutgoingQueue::default());
         let entry = ConnectionPoolEntry {
             sender,
+            queue: Arc::clone(&queue),
             address,
             id,
         };
 
         self.next_connection_id += 1;
         self.peers.insert(key, entry);
-        (receiver_rx, id)
+        self.metrics.add_outgoing_queue(key, Arc::clone(&queue));
+        (receiver_rx, queue, id)
     }
 
     fn contains(&self, address: &PublicKey) -> bool {
@@ -284,6 +387,7 @@ impl ConnectionPool {
         if let Some(entry) = self.peers.get(address) {
             if connection_id.map_or(true, |id| id == entry.id) {
                 self.peers.remove(address);
+                self.metrics.remove_outgoing_queue(address);
                 return true;
             }
         }
@@ -293,7 +397,8 @@ impl ConnectionPool {
 
 struct Connection {
     socket: Framed<TcpStream, MessagesCodec>,
-    receiver_rx: mpsc::Receiver<SignedMessage>,
+    receiver_rx: mpsc::Receiver<Bytes>,
+    queue: Arc<OutgoingQueue>,
     address: ConnectedPeerAddr,
     key: PublicKey,
     id: u64,
@@ -476,7 +581,7 @@ impl NetworkHandler {
         connection: Connection,
         mut network_tx: mpsc::Sender<NetworkEvent>,
     ) {
-        let (sink, stream) = connection.socket.split();
+        let (sink, stream) = connection.socket.split::<Bytes>();
         let key = connection.key;
         let connection_id = connection.id;
 
@@ -497,7 +602,14 @@ impl NetworkHandler {
         futures::pin_mut!(incoming);
 
         // Processing of outgoing messages.
-        let outgoing = connection.receiver_rx.map(Ok).forward(sink);
+        let queue = connection.queue;
+        let outgoing = connection
+            .receiver_rx
+            .map(move |message| {
+                queue.pop();
+                Ok(message)
+            })
+            .forward(sink);
 
         // Select the first future to terminate and drop the remaining one.
         let task = future::select(incoming, outgoing).map(|res| {
@@ -570,6 +682,8 @@ impl NetworkHandler {
                     });
                 }
 
+                NetworkRequest::Broadcast(keys, message) => self.handle_broadcast(keys, message),
+
                 #[cfg(test)]
                 NetworkRequest::DisconnectWithPeer(peer) => {
                     let disconnected = self.pool.write().remove(&peer, None);
@@ -587,12 +701,33 @@ impl NetworkHandler {
         }
     }
 
+    /// Sends a message to several peers. The connected peers get the same serialized message
+    /// without waiting for each other; connections to other peers are established
+    /// in separate tasks, as with `NetworkRequest::SendMessage`.
+    fn handle_broadcast(&self, keys: Vec<PublicKey>, message: SignedMessage) {
+        let bytes = Bytes::from(message.to_bytes());
+        for key in keys {
+            if self.pool.enqueue_broadcast(&key, bytes.clone()) {
+                continue;
+            }
+
+            let mut this = self.clone();
+            let message = message.clone();
+            tokio::spawn(async move {
+                if let Err(e) = this.handle_send_message(key, message).await {
+                    log::error!("Cannot send message to peer {:?}: {}", key, e);
+                }
+            });
+        }
+    }
+
     async fn handle_send_message(
         &mut self,
         address: PublicKey,
         message: SignedMessage,
     ) -> anyhow::Result<()> {
         if self.pool.read().contains(&address) {
+            let message = Bytes::from(message.into_bytes());
             self.pool.send_message(&address, message).await;
             Ok(())
         } else if self.can_create_connections() {
@@ -610,6 +745,7 @@ impl NetworkHandler {
         self.connect(key, &self.handshake_params).await?;
         let connect = &self.handshake_params.connect;
         if message != *connect.as_raw() {
+            let message = Bytes::from(message.into_bytes());
             self.pool.send_message(&key, message).await;
         }
         Ok(())
@@ -649,7 +785,7 @@ impl NetworkPart {
 
         let handler = NetworkHandler::new(
             self.listen_address,
-            SharedConnectionPool::new(our_key),
+            SharedConnectionPool::new(our_key, self.metrics),
             self.network_config,
             self.network_tx,
             handshake_params,
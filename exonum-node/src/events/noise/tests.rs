@@ -170,6 +170,28 @@ fn noise_encrypt_decrypt_bogus_message() {
     assert!(res.unwrap_err().to_string().contains("decrypt error"));
 }
 
+#[test]
+fn noise_encrypt_decrypt_several_messages_in_buffer() {
+    let (mut initiator, mut responder) = create_noise_sessions();
+    let mut buffer_msg = BytesMut::new();
+    let messages = vec![raw_message(64), raw_message(MAX_MESSAGE_LENGTH + 10)];
+
+    for message in &messages {
+        initiator
+            .encrypt_msg(&message.to_bytes(), &mut buffer_msg)
+            .expect("Unable to encrypt message");
+    }
+
+    for message in &messages {
+        let len = LittleEndian::read_u32(&buffer_msg[..HEADER_LENGTH]) as usize;
+        let res = responder
+            .decrypt_msg(len, &mut buffer_msg)
+            .expect("Unable to decrypt message");
+        assert_eq!(message.to_bytes(), res);
+    }
+    assert!(buffer_msg.is_empty());
+}
+
 fn check_encrypt_decrypt_message(msg_size: usize) {
     let (mut initiator, mut responder) = create_noise_sessions();
     let mut buffer_msg = BytesMut::with_capacity(msg_size);
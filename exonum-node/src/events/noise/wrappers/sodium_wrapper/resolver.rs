@@ -209,10 +209,17 @@ impl Cipher for SodiumChaChaPoly {
 
         let nonce = Self::get_ietf_nonce(nonce);
 
-        let buf = sodium_chacha20poly1305::seal(plaintext, Some(authtext), &nonce, &self.key);
-
-        out[..buf.len()].copy_from_slice(&buf);
-        buf.len()
+        // Encrypt in place in the output buffer to avoid allocating a separate one.
+        let len = plaintext.len();
+        out[..len].copy_from_slice(plaintext);
+        let tag = sodium_chacha20poly1305::seal_detached(
+            &mut out[..len],
+            Some(authtext),
+            &nonce,
+            &self.key,
+        );
+        out[len..len + sodium_chacha20poly1305::TAGBYTES].copy_from_slice(&tag.0);
+        len + sodium_chacha20poly1305::TAGBYTES
     }
 
     fn decrypt(
@@ -230,15 +237,21 @@ impl Cipher for SodiumChaChaPoly {
 
         let nonce = Self::get_ietf_nonce(nonce);
 
-        let result = sodium_chacha20poly1305::open(ciphertext, Some(authtext), &nonce, &self.key);
-
-        match result {
-            Ok(ref buf) => {
-                out[..buf.len()].copy_from_slice(buf);
-                Ok(buf.len())
-            }
-            Err(_) => Err(()),
+        if ciphertext.len() < sodium_chacha20poly1305::TAGBYTES {
+            return Err(());
         }
+        // Decrypt in place in the output buffer to avoid allocating a separate one.
+        let len = ciphertext.len() - sodium_chacha20poly1305::TAGBYTES;
+        let tag = sodium_chacha20poly1305::Tag::from_slice(&ciphertext[len..]).ok_or(())?;
+        out[..len].copy_from_slice(&ciphertext[..len]);
+        sodium_chacha20poly1305::open_detached(
+            &mut out[..len],
+            Some(authtext),
+            &tag,
+            &nonce,
+            &self.key,
+        )?;
+        Ok(len)
     }
 }
 
@@ -115,24 +115,25 @@ impl TransportWrapper {
     /// 1. Message splits to packets of length smaller or equal to 65535 bytes.
     /// 2. Then each packet is decrypted by selected noise algorithm.
     /// 3. Append all decrypted packets to `decoded_message`.
-    pub fn decrypt_msg(&mut self, len: usize, buf: &mut BytesMut) -> anyhow::Result<BytesMut> {
+    ///
+    /// Packets are decrypted directly from `buf` into the resulting message, without
+    /// intermediate buffers.
+    pub fn decrypt_msg(&mut self, len: usize, buf: &mut BytesMut) -> anyhow::Result<Vec<u8>> {
         debug_assert!(len + HEADER_LENGTH <= buf.len());
-        let data = buf.split_to(len + HEADER_LENGTH).to_vec();
+        let data = buf.split_to(len + HEADER_LENGTH);
         let data = &data[HEADER_LENGTH..];
 
         let len = decrypted_msg_len(data.len());
-        let mut decrypted_message = BytesMut::with_capacity(len);
-        decrypted_message.resize(len, 0);
-
-        let mut read = vec![0_u8; MAX_MESSAGE_LENGTH];
+        // The last packet is decrypted into a buffer with the extra space for the tag,
+        // so that the buffer is large enough even for a malformed packet.
+        let mut decrypted_message = vec![0_u8; len + TAG_LENGTH];
         for (i, msg) in data.chunks(MAX_MESSAGE_LENGTH).enumerate() {
-            let len = self.state.read_message(msg, &mut read)?;
             let start = i * (MAX_MESSAGE_LENGTH - TAG_LENGTH);
-            let end = start + len;
-
-            decrypted_message[start..end].copy_from_slice(&read[..len]);
+            self.state
+                .read_message(msg, &mut decrypted_message[start..])?;
         }
 
+        decrypted_message.truncate(len);
         Ok(decrypted_message)
     }
 
@@ -145,23 +146,27 @@ impl TransportWrapper {
     /// 3. Result message: first 4 bytes is message length(`len').
     /// 4. Append all encrypted packets in corresponding order.
     /// 5. Write result message to `buf`
+    ///
+    /// Packets are encrypted directly into `buf`, without intermediate buffers.
     pub fn encrypt_msg(&mut self, msg: &[u8], buf: &mut BytesMut) -> anyhow::Result<()> {
-        //TODO: don't use additional allocations [ECR-2213]
         const CHUNK_LENGTH: usize = MAX_MESSAGE_LENGTH - TAG_LENGTH;
         let len = encrypted_msg_len(msg.len());
-        let mut encrypted_message = vec![0; len + HEADER_LENGTH];
-        LittleEndian::write_u32(&mut encrypted_message[..HEADER_LENGTH], len as u32);
+        let offset = buf.len();
+        buf.resize(offset + HEADER_LENGTH + len, 0);
+        LittleEndian::write_u32(&mut buf[offset..offset + HEADER_LENGTH], len as u32);
 
-        let mut written = vec![0_u8; MAX_MESSAGE_LENGTH];
+        let encrypted_message = &mut buf[offset + HEADER_LENGTH..];
         for (i, msg) in msg.chunks(CHUNK_LENGTH).enumerate() {
-            let len = self.state.write_message(msg, &mut written)?;
-            let start = HEADER_LENGTH + i * MAX_MESSAGE_LENGTH;
-            let end = start + len;
-
-            encrypted_message[start..end].copy_from_slice(&written[..len]);
+            let start = i * MAX_MESSAGE_LENGTH;
+            let end = (start + MAX_MESSAGE_LENGTH).min(encrypted_message.len());
+            if let Err(e) = self
+                .state
+                .write_message(msg, &mut encrypted_message[start..end])
+            {
+                buf.truncate(offset);
+                return Err(e.into());
+            }
         }
-
-        buf.extend_from_slice(&encrypted_message);
         Ok(())
     }
 }
@@ -171,7 +176,9 @@ impl TransportWrapper {
 // length we need to subtract `TAG_LENGTH` multiplied by messages count
 // from `data.len()`.
 fn decrypted_msg_len(raw_message_len: usize) -> usize {
-    raw_message_len - TAG_LENGTH * div_ceil(raw_message_len, MAX_MESSAGE_LENGTH)
+    // Malformed messages may be shorter than the tags they are supposed to contain;
+    // decryption of such messages fails later.
+    raw_message_len.saturating_sub(TAG_LENGTH * div_ceil(raw_message_len, MAX_MESSAGE_LENGTH))
 }
 
 // In case of encryption we need to add `TAG_LENGTH` multiplied by messages count to
@@ -29,6 +29,7 @@ use tokio::time::timeout;
 
 use std::{
     net::SocketAddr,
+    sync::Arc,
     time::{self, Duration, SystemTime},
 };
 
@@ -94,6 +95,13 @@ impl TestHandler {
             .unwrap();
     }
 
+    pub async fn broadcast(&mut self, keys: Vec<PublicKey>, raw: SignedMessage) {
+        self.network_requests_tx
+            .send(NetworkRequest::Broadcast(keys, raw))
+            .await
+            .unwrap();
+    }
+
     pub async fn wait_for_connect(&mut self) -> Verified<Connect> {
         match self.wait_for_event().await {
             Ok(NetworkEvent::PeerConnected { connect, .. }) => *connect,
@@ -165,6 +173,7 @@ impl TestEvents {
             network_requests: channel.network_requests.1,
             network_tx,
             connect_list: self.connect_list,
+            metrics: Arc::default(),
         };
 
         TestHandler::new(
@@ -466,6 +475,58 @@ async fn test_network_multiple_connect() {
     );
 }
 
+#[tokio::test]
+async fn test_network_broadcast() {
+    let main = "127.0.0.1:19700".parse().unwrap();
+    let nodes = [
+        "127.0.0.1:19701".parse().unwrap(),
+        "127.0.0.1:19702".parse().unwrap(),
+    ];
+
+    let mut connect_list = ConnectList::default();
+    let mut connection_params: Vec<_> = nodes
+        .iter()
+        .cloned()
+        .map(ConnectionParams::from_address)
+        .collect();
+    for params in &connection_params {
+        connect_list.add(params.connect_info.clone());
+    }
+    let keys: Vec<_> = connection_params
+        .iter()
+        .map(|params| params.connect_info.public_key)
+        .collect();
+
+    let mut t1 = ConnectionParams::from_address(main);
+    let main_key = t1.connect_info.public_key;
+    connect_list.add(t1.connect_info.clone());
+    let connect_list = SharedConnectList::from_connect_list(connect_list);
+    let events = TestEvents::with_addr(t1.address, &connect_list);
+    let mut node = t1.spawn(events, connect_list.clone());
+
+    let mut peers: Vec<_> = connection_params
+        .iter_mut()
+        .map(|params| {
+            let events = TestEvents::with_addr(params.address, &connect_list);
+            params.spawn(events, connect_list.clone())
+        })
+        .collect();
+
+    // The first peer is connected before the broadcast, and the connection
+    // to the second one is established by the broadcast itself.
+    peers[0]
+        .connect_with(main_key, connection_params[0].connect.clone())
+        .await;
+    node.wait_for_connect().await;
+    peers[0].wait_for_connect().await;
+
+    let msg = raw_message(1_000);
+    node.broadcast(keys, msg.clone()).await;
+    assert_eq!(peers[0].wait_for_message().await, msg);
+    assert_eq!(peers[1].wait_for_connect().await, t1.connect);
+    assert_eq!(peers[1].wait_for_message().await, msg);
+}
+
 #[tokio::test]
 async fn test_send_first_not_connect() {
     let main = "127.0.0.1:19500".parse().unwrap();
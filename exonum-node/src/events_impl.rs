@@ -52,6 +52,9 @@ impl NodeHandler {
             InternalEventInner::Timeout(timeout) => self.handle_timeout(timeout),
             InternalEventInner::JumpToRound(height, round) => self.handle_new_round(height, round),
             InternalEventInner::MessageVerified(msg) => self.handle_message(*msg),
+            InternalEventInner::TransactionChecked(tx, precheck) => {
+                self.handle_peer_tx(*tx, Some(precheck))
+            }
         }
     }
 
@@ -143,10 +146,8 @@ impl NodeHandler {
         );
 
         let fork = self.blockchain.fork();
-        let mut schema = Schema::new(&fork);
-        for (_, tx) in mem::take(self.state.tx_cache_mut()) {
-            schema.add_transaction_into_pool(tx);
-        }
+        let transactions = mem::take(self.state.tx_cache_mut());
+        Schema::new(&fork).add_transactions_into_pool(transactions.into_iter().map(|(_, tx)| tx));
 
         if self.blockchain.merge(fork.into_patch()).is_err() {
             warn!("Failed to flush transactions from cache to persistent pool.");
@@ -58,6 +58,7 @@
 
 pub use crate::{
     connect_list::{ConnectInfo, ConnectListConfig},
+    metrics::{NodeMetrics, StartupPhase},
     plugin::{NodePlugin, PluginApiContext, SharedNodeState},
 };
 
@@ -71,7 +72,7 @@ use exonum::{
     crypto::{self, Hash, PublicKey},
     helpers::{user_agent, Height, Milliseconds, Round, ValidateInput, ValidatorId},
     keys::Keys,
-    merkledb::{Database, ObjectHash},
+    merkledb::{Database, ObjectHash, SystemSchema},
     messages::{AnyTx, IntoMessage, SignedMessage, Verified},
     runtime::RuntimeInstance,
 };
@@ -94,7 +95,7 @@ use std::{
     net::SocketAddr,
     sync::Arc,
     thread,
-    time::{Duration, SystemTime},
+    time::{Duration, Instant, SystemTime},
 };
 
 use crate::{
@@ -103,7 +104,7 @@ use crate::{
         HandlerPart, HandshakeParams, InternalEvent, InternalPart, InternalRequest, NetworkEvent,
         NetworkPart, NetworkRequest, SyncSender, TimeoutRequest,
     },
-    messages::Connect,
+    messages::{Connect, BLOCK_REQUEST_MAX_COUNT},
     pool::{ManagePool, StandardPoolManager},
     schema::NodeSchema,
     state::{RequestData, State},
@@ -116,6 +117,7 @@ mod events;
 mod events_impl;
 pub mod helpers;
 mod messages;
+mod metrics;
 mod plugin;
 pub mod pool;
 mod proto;
@@ -209,6 +211,10 @@ pub(crate) struct NodeHandler {
     allow_expedited_propose: bool,
     /// Pool manager.
     pool_manager: Box<dyn ManagePool>,
+    /// Historical data pruning configuration.
+    pruning: Option<PruningConfig>,
+    /// Height of the earliest block with non-pruned transactions and precommits.
+    first_retained_height: Height,
 }
 
 /// HTTP API configuration options.
@@ -289,6 +295,17 @@ pub struct NetworkConfiguration {
     pub tcp_connect_retry_timeout: Milliseconds,
     /// Maximum number of retries when connecting to a peer.
     pub tcp_connect_max_retries: u64,
+    /// Maximum number of consecutive blocks requested from a peer in a single `BlockRequest`
+    /// when the node lags behind. Setting this value to 1 makes the node request blocks
+    /// one by one. The value cannot exceed `BLOCK_REQUEST_MAX_COUNT`.
+    #[serde(default = "NetworkConfiguration::default_block_sync_window")]
+    pub block_sync_window: u32,
+}
+
+impl NetworkConfiguration {
+    fn default_block_sync_window() -> u32 {
+        16
+    }
 }
 
 impl Default for NetworkConfiguration {
@@ -300,6 +317,7 @@ impl Default for NetworkConfiguration {
             tcp_nodelay: true,
             tcp_connect_retry_timeout: 15_000,
             tcp_connect_max_retries: 10,
+            block_sync_window: Self::default_block_sync_window(),
         }
     }
 }
@@ -315,6 +333,15 @@ pub struct EventsPoolCapacity {
     internal_events_capacity: usize,
     /// Maximum number of queued requests from api.
     api_requests_capacity: usize,
+    /// Maximum number of incoming messages verified within a single blocking task.
+    #[serde(default = "EventsPoolCapacity::default_verification_batch_size")]
+    verification_batch_size: usize,
+}
+
+impl EventsPoolCapacity {
+    fn default_verification_batch_size() -> usize {
+        64
+    }
 }
 
 impl Default for EventsPoolCapacity {
@@ -324,6 +351,7 @@ impl Default for EventsPoolCapacity {
             network_events_capacity: 512,
             internal_events_capacity: 128,
             api_requests_capacity: 1024,
+            verification_batch_size: Self::default_verification_batch_size(),
         }
     }
 }
@@ -362,6 +390,16 @@ pub struct MemoryPoolConfig {
     /// allows to specify the coherence interval for the pool.
     #[serde(default)]
     pub flush_pool_strategy: FlushPoolStrategy,
+
+    /// Whether the node should proactively send transactions of its proposals to peers
+    /// which have recently requested missing transactions from it.
+    ///
+    /// Such peers are likely to miss transactions of the next proposals as well (e.g., because
+    /// of a high network latency), and would otherwise spend at least a request timeout
+    /// and a network round trip before they can vote for the proposal. Pushing transactions
+    /// trades some bandwidth for fewer stalled rounds. Disabled by default.
+    #[serde(default)]
+    pub push_propose_txs: bool,
 }
 
 /// Strategy to flush transactions into the pool.
@@ -395,6 +433,28 @@ impl Default for FlushPoolStrategy {
     }
 }
 
+/// Configuration of historical data pruning.
+///
+/// A pruning node stores transactions and precommits only for the latest blocks; see
+/// [`BlockchainMut::prune_history()`] for details. Pruning does not influence the blockchain
+/// state, but the node cannot provide pruned data to its peers (thus, the network should
+/// include at least some archival nodes) or via the HTTP API.
+///
+/// [`BlockchainMut::prune_history()`]: https://docs.rs/exonum/latest/exonum/blockchain/struct.BlockchainMut.html#method.prune_history
+#[derive(Debug, Clone, Copy, PartialEq, Serialize, Deserialize)]
+#[non_exhaustive]
+pub struct PruningConfig {
+    /// Number of the latest blocks for which transactions and precommits are retained.
+    pub retained_blocks: u64,
+}
+
+impl PruningConfig {
+    /// Creates a pruning configuration retaining the specified number of the latest blocks.
+    pub fn new(retained_blocks: u64) -> Self {
+        Self { retained_blocks }
+    }
+}
+
 /// Configuration for the `Node`.
 #[derive(Clone, Debug, Serialize, Deserialize, PartialEq)]
 pub struct NodeConfig {
@@ -414,6 +474,10 @@ pub struct NodeConfig {
     pub connect_list: ConnectListConfig,
     /// Number of threads allocated for transaction verification.
     pub thread_pool_size: Option<u8>,
+    /// Historical data pruning configuration. If set to `None`, the node stores
+    /// the complete blockchain history.
+    #[serde(default)]
+    pub pruning: Option<PruningConfig>,
 }
 
 impl ValidateInput for NodeConfig {
@@ -431,6 +495,16 @@ impl ValidateInput for NodeConfig {
             "network_requests_capacity({}) must be strictly larger than 0",
             capacity.network_requests_capacity
         );
+        ensure!(
+            self.network.block_sync_window > 0,
+            "`network.block_sync_window` must be strictly larger than 0"
+        );
+        ensure!(
+            self.network.block_sync_window <= BLOCK_REQUEST_MAX_COUNT,
+            "`network.block_sync_window`({}) must not exceed {}",
+            self.network.block_sync_window,
+            BLOCK_REQUEST_MAX_COUNT
+        );
 
         let restart_policy = &self.api.server_restart;
         ensure!(
@@ -474,6 +548,8 @@ pub struct Configuration {
     pub peer_discovery: Vec<String>,
     /// Memory pool configuration.
     pub mempool: MemoryPoolConfig,
+    /// Historical data pruning configuration.
+    pub pruning: Option<PruningConfig>,
     /// Validator keys.
     pub keys: Keys,
 }
@@ -541,6 +617,7 @@ impl NodeHandler {
         let last_block = schema.last_block();
         let last_block_skip = schema.block_skip();
         let consensus_config = schema.consensus_config();
+        let first_retained_height = schema.first_retained_height();
         info!("Creating a node with config: {:#?}", consensus_config);
 
         let connect = Connect::new(
@@ -553,6 +630,7 @@ impl NodeHandler {
             .iter()
             .collect();
         let peer_discovery = config.peer_discovery.clone();
+        let pruning = config.pruning;
 
         let state = State::new(
             config,
@@ -582,6 +660,8 @@ impl NodeHandler {
             config_manager,
             allow_expedited_propose: true,
             pool_manager,
+            pruning,
+            first_retained_height,
         }
     }
 
@@ -739,10 +819,8 @@ impl NodeHandler {
                 }
             })
             .collect();
-        let message = message.into();
-        for address in peers {
-            self.send_to_peer(address, message.clone());
-        }
+        let request = NetworkRequest::Broadcast(peers, message.into());
+        self.channel.network_requests.send(request);
     }
 
     /// Performs connection to the specified network address.
@@ -989,6 +1067,7 @@ pub struct Node {
     channel: NodeChannel,
     max_message_len: u32,
     thread_pool_size: Option<u8>,
+    verification_batch_size: usize,
     disable_signals: bool,
 }
 
@@ -1046,6 +1125,7 @@ pub struct NodeBuilder {
     pool_manager: Box<dyn ManagePool>,
     plugins: Vec<Box<dyn NodePlugin>>,
     disable_signals: bool,
+    database_open_time: Option<Duration>,
 }
 
 impl fmt::Debug for NodeBuilder {
@@ -1083,6 +1163,7 @@ impl NodeBuilder {
             plugins: vec![],
             pool_manager: Box::new(StandardPoolManager::default()),
             disable_signals: false,
+            database_open_time: None,
         }
     }
 
@@ -1153,9 +1234,20 @@ impl NodeBuilder {
         self
     }
 
+    /// Sets the time spent on opening the node database, so that it is reported among
+    /// durations of other startup phases in the node metrics.
+    pub fn with_database_open_time(mut self, duration: Duration) -> Self {
+        self.database_open_time = Some(duration);
+        self
+    }
+
     /// Converts this builder into a `Node`.
     pub fn build(self) -> Node {
+        let start = Instant::now();
         let blockchain = self.blockchain_builder.build();
+        let restore_time = start.elapsed();
+
+        let start = Instant::now();
         let mut node = Node::with_blockchain(
             blockchain,
             self.channel,
@@ -1166,6 +1258,13 @@ impl NodeBuilder {
             self.pool_manager,
         );
         node.disable_signals = self.disable_signals;
+
+        let metrics = node.handler.api_state.metrics();
+        if let Some(duration) = self.database_open_time {
+            metrics.observe_startup_phase(StartupPhase::OpenDatabase, duration);
+        }
+        metrics.observe_startup_phase(StartupPhase::RestoreBlockchain, restore_time);
+        metrics.observe_startup_phase(StartupPhase::CreateNode, start.elapsed());
         node
     }
 }
@@ -1183,10 +1282,15 @@ impl Node {
     ) -> Self {
         crypto::init();
 
+        let verification_batch_size = node_cfg
+            .mempool
+            .events_pool_capacity
+            .verification_batch_size;
         let peers = node_cfg.connect_list.addresses();
         let config = Configuration {
             connect_list: ConnectList::from_config(node_cfg.connect_list),
             mempool: node_cfg.mempool,
+            pruning: node_cfg.pruning,
             network: node_cfg.network,
             peer_discovery: peers,
             keys: node_keys,
@@ -1244,6 +1348,7 @@ impl Node {
             network_config,
             max_message_len: node_cfg.consensus.max_message_len,
             thread_pool_size: node_cfg.thread_pool_size,
+            verification_batch_size,
             api_manager_config: api_runtime_config,
             disable_signals: false,
         }
@@ -1256,7 +1361,12 @@ impl Node {
         // (see below).
         const STOP_TIMEOUT: Duration = Duration::from_millis(50);
 
+        let start = Instant::now();
         self.handler.initialize();
+        let metrics = self.handler.api_state.metrics_handle();
+        metrics.observe_startup_phase(StartupPhase::InitializeConsensus, start.elapsed());
+        spawn_cache_warm_up(self.handler.blockchain.immutable_view(), metrics);
+
         let res = Reactor::new(self).run(handshake_params).await;
 
         // Wait for a little bit to prevent undefined behavior with RocksDB, when it is dropped
@@ -1308,6 +1418,47 @@ impl Node {
     }
 }
 
+/// Number of the latest blocks read during the cache warm-up.
+const WARM_UP_BLOCKS: u64 = 100;
+
+/// Reads the data frequently accessed by a running node in a background thread,
+/// so that it is cached by the database by the time it is needed. Among other things,
+/// the latest blocks are requested by lagging peers, and the state aggregator
+/// is accessed by light clients requesting proofs.
+fn spawn_cache_warm_up(blockchain: Blockchain, metrics: Arc<NodeMetrics>) {
+    let warm_up = move || {
+        let start = Instant::now();
+        let snapshot = blockchain.snapshot();
+        let schema = Schema::new(&snapshot);
+        let height = schema.height();
+        let from = height
+            .0
+            .saturating_sub(WARM_UP_BLOCKS)
+            .max(schema.first_retained_height().0);
+
+        let transactions = schema.transactions();
+        for block_height in from..=height.0 {
+            let block_height = Height(block_height);
+            schema.block_and_precommits(block_height);
+            for tx_hash in &schema.block_transactions(block_height) {
+                transactions.get(&tx_hash);
+            }
+        }
+        SystemSchema::new(&snapshot)
+            .state_aggregator()
+            .iter()
+            .count();
+
+        log::info!("Warmed up caches in {:?}", start.elapsed());
+        metrics.observe_startup_phase(StartupPhase::WarmUpCaches, start.elapsed());
+    };
+
+    thread::Builder::new()
+        .name("cache-warm-up".to_owned())
+        .spawn(warm_up)
+        .expect("Cannot spawn thread for cache warm-up");
+}
+
 struct Reactor {
     handler_part: HandlerPart<NodeHandler>,
     network_part: NetworkPart,
@@ -1346,6 +1497,7 @@ impl Reactor {
 
         let (network_tx, network_rx) = node.channel.network_events;
         let internal_requests_rx = node.channel.internal_requests.1;
+        let metrics = node.handler.api_state.metrics_handle();
         let network_part = NetworkPart {
             our_connect_message: connect_message,
             listen_address: node.handler.system_state.listen_address(),
@@ -1354,9 +1506,11 @@ impl Reactor {
             network_config: node.network_config,
             max_message_len: node.max_message_len,
             connect_list,
+            metrics: Arc::clone(&metrics),
         };
 
         let (internal_tx, internal_rx) = node.channel.internal_events;
+        let blockchain = node.handler.blockchain.immutable_view();
         let handler_part = HandlerPart {
             handler: node.handler,
             internal_rx,
@@ -1368,6 +1522,9 @@ impl Reactor {
         let internal_part = InternalPart {
             internal_tx,
             internal_requests_rx,
+            verification_batch_size: node.verification_batch_size,
+            blockchain: Some(blockchain),
+            metrics,
         };
 
         Self {
@@ -1499,6 +1656,7 @@ pub fn generate_testnet_config(count: u16, start_port: u16) -> Vec<(NodeConfig,
                 api: NodeApiConfig::default(),
                 mempool: MemoryPoolConfig::default(),
                 thread_pool_size: None,
+                pruning: None,
             };
             (config, keys)
         })
@@ -1542,6 +1700,15 @@ mod tests {
         NodeBuilder::new(db, node_cfg, node_keys);
     }
 
+    #[test]
+    #[should_panic(expected = "`network.block_sync_window`(65) must not exceed 64")]
+    fn test_bad_block_sync_window_too_large() {
+        let db = TemporaryDB::new();
+        let (mut node_cfg, node_keys) = generate_testnet_config(1, 16_500).pop().unwrap();
+        node_cfg.network.block_sync_window = 65;
+        NodeBuilder::new(db, node_cfg, node_keys);
+    }
+
     #[test]
     #[should_panic(expected = "must be smaller than 65536")]
     fn test_bad_internal_events_capacity_too_large() {
@@ -25,6 +25,9 @@ use std::borrow::Cow;
 
 mod types;
 
+/// Maximum number of blocks sent in response to a single `BlockRequest`.
+pub const BLOCK_REQUEST_MAX_COUNT: u32 = 64;
+
 /// Size of an empty `TransactionsResponse`.
 pub const TX_RES_EMPTY_SIZE: usize = SIGNED_MESSAGE_MIN_SIZE + PUBLIC_KEY_LENGTH + 8;
 
@@ -349,6 +352,7 @@ mod tests {
             blockchain_height: Height(0),
             last_hash: Hash::zero(),
             pool_size: 0,
+            first_retained_height: Height(0),
         };
         let protocol_message = ExonumMessage::from(msg.clone());
         let signed = SignedMessage::new(
@@ -376,6 +380,7 @@ mod tests {
             blockchain_height: Height(0),
             last_hash: Hash::zero(),
             pool_size: 0,
+            first_retained_height: Height(0),
         };
         let protocol_message = ExonumMessage::from(msg);
         let mut signed =
@@ -396,6 +401,7 @@ mod tests {
                 blockchain_height: Height(0),
                 last_hash: Hash::zero(),
                 pool_size: 0,
+                first_retained_height: Height(0),
             },
             keypair.public_key(),
             keypair.secret_key(),
@@ -100,6 +100,9 @@ impl Connect {
 /// - Otherwise, if `epoch` is greater or equal to the current epoch of the node,
 ///   then `BlockRequest` with the current height and the current epoch is sent in reply.
 ///
+/// A `BlockRequest` is not sent if the requested block is lower than `first_retained_height`
+/// of the sender, since the sender has pruned data necessary to respond to the request.
+///
 /// ### Generation
 ///
 /// `Status` message is broadcast regularly with the timeout controlled by
@@ -115,6 +118,9 @@ pub struct Status {
     pub last_hash: Hash,
     /// Transactions pool size.
     pub pool_size: u64,
+    /// Height of the earliest block for which the node can provide transactions and precommits.
+    /// This value is set to `Height(0)` if the node stores the complete blockchain history.
+    pub first_retained_height: Height,
 }
 
 impl Status {
@@ -125,8 +131,15 @@ impl Status {
             blockchain_height,
             last_hash,
             pool_size,
+            first_retained_height: Height(0),
         }
     }
+
+    /// Sets the height of the earliest block for which the node retains historical data.
+    pub fn with_first_retained_height(mut self, height: Height) -> Self {
+        self.first_retained_height = height;
+        self
+    }
 }
 
 /// Proposal for a new block.
@@ -515,6 +528,13 @@ impl PeersRequest {
 ///   or the latest block skip with the epoch greater or equal to the `epoch` mentioned
 ///   in the message.
 ///
+/// If `count` is greater than 1, the node additionally sends `BlockResponse`s for the following
+/// committed heights, up to `count` blocks in total (but no more than
+/// [`BLOCK_REQUEST_MAX_COUNT`]). All blocks in such a batch are taken from the same snapshot
+/// of the blockchain.
+///
+/// [`BLOCK_REQUEST_MAX_COUNT`]: constant.BLOCK_REQUEST_MAX_COUNT.html
+///
 /// ### Generation
 ///
 /// This message can be sent during `Status` processing.
@@ -528,6 +548,9 @@ pub struct BlockRequest {
     /// The epoch to retrieve if the specified blockchain height is not reached by the node.
     /// This value is set to `Height(0)` to signal to skip this stage of message processing.
     pub epoch: Height,
+    /// Number of consecutive blocks to retrieve starting from `height`. Values 0 and 1
+    /// both mean a single block.
+    pub count: u32,
 }
 
 impl BlockRequest {
@@ -537,13 +560,30 @@ impl BlockRequest {
             to,
             height,
             epoch: Height(0),
+            count: 0,
+        }
+    }
+
+    /// Creates a new `BlockRequest` for `count` consecutive blocks starting from `height`.
+    pub fn with_count(to: PublicKey, height: Height, count: u32) -> Self {
+        debug_assert!(count > 1);
+        Self {
+            to,
+            height,
+            epoch: Height(0),
+            count,
         }
     }
 
     /// Creates a new `BlockRequest` with the specified epoch.
     pub fn with_epoch(to: PublicKey, height: Height, epoch: Height) -> Self {
         debug_assert!(epoch > Height(0));
-        Self { to, height, epoch }
+        Self {
+            to,
+            height,
+            epoch,
+            count: 0,
+        }
     }
 
     /// Returns the effective value of `epoch` in this request.
@@ -554,6 +594,11 @@ impl BlockRequest {
             Some(self.epoch)
         }
     }
+
+    /// Returns the effective number of blocks requested by this message.
+    pub fn count(&self) -> u32 {
+        self.count.max(1)
+    }
 }
 
 /// Enumeration of all possible types of Exonum messages which are used in P2P communication
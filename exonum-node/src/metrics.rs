@@ -0,0 +1,433 @@
+// Copyright 2020 The Exonum Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Performance metrics of the node.
+
+use exonum::crypto::PublicKey;
+
+use std::{
+    collections::{BTreeMap, HashMap},
+    fmt::{self, Write as _},
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Arc, Mutex,
+    },
+    time::Duration,
+};
+
+use crate::events::OutgoingQueue;
+
+/// Upper bounds of histogram buckets for durations, in microseconds.
+const DURATION_BOUNDS: &[u64] = &[
+    100, 500, 1_000, 2_500, 5_000, 10_000, 25_000, 50_000, 100_000, 250_000, 500_000, 1_000_000,
+    2_500_000, 5_000_000, 10_000_000,
+];
+/// Number of microseconds in a second.
+const MICROS_IN_SECOND: f64 = 1_000_000.0;
+/// Upper bounds of histogram buckets for sizes.
+const SIZE_BOUNDS: &[u64] = &[1, 4, 16, 64, 256, 1_024, 4_096, 16_384];
+
+/// Histogram with fixed buckets, which can be updated concurrently.
+#[derive(Debug)]
+struct Histogram {
+    bounds: &'static [u64],
+    /// Number of observed values in each bucket (not cumulative). The last bucket
+    /// holds values exceeding all bounds.
+    buckets: Vec<AtomicU64>,
+    sum: AtomicU64,
+    /// Divisor converting the observed values into the exported unit.
+    scale: f64,
+}
+
+impl Histogram {
+    fn new(bounds: &'static [u64], scale: f64) -> Self {
+        Self {
+            bounds,
+            buckets: (0..=bounds.len()).map(|_| AtomicU64::new(0)).collect(),
+            sum: AtomicU64::new(0),
+            scale,
+        }
+    }
+
+    fn durations() -> Self {
+        Self::new(DURATION_BOUNDS, MICROS_IN_SECOND)
+    }
+
+    fn sizes() -> Self {
+        Self::new(SIZE_BOUNDS, 1.0)
+    }
+
+    fn observe(&self, value: u64) {
+        let bucket = self
+            .bounds
+            .iter()
+            .position(|&bound| value <= bound)
+            .unwrap_or_else(|| self.bounds.len());
+        self.buckets[bucket].fetch_add(1, Ordering::Relaxed);
+        self.sum.fetch_add(value, Ordering::Relaxed);
+    }
+
+    fn observe_duration(&self, duration: Duration) {
+        self.observe(duration.as_micros() as u64);
+    }
+
+    fn write(&self, out: &mut String, name: &str, help: &str) -> fmt::Result {
+        writeln!(out, "# HELP {} {}", name, help)?;
+        writeln!(out, "# TYPE {} histogram", name)?;
+        let mut cumulative_count = 0;
+        for (i, bucket) in self.buckets.iter().enumerate() {
+            cumulative_count += bucket.load(Ordering::Relaxed);
+            if let Some(&bound) = self.bounds.get(i) {
+                let bound = bound as f64 / self.scale;
+                writeln!(
+                    out,
+                    "{}_bucket{{le=\"{}\"}} {}",
+                    name, bound, cumulative_count
+                )?;
+            } else {
+                writeln!(out, "{}_bucket{{le=\"+Inf\"}} {}", name, cumulative_count)?;
+            }
+        }
+        let sum = self.sum.load(Ordering::Relaxed) as f64 / self.scale;
+        writeln!(out, "{}_sum {}", name, sum)?;
+        writeln!(out, "{}_count {}", name, cumulative_count)
+    }
+}
+
+fn write_gauge(out: &mut String, name: &str, help: &str, value: u64) -> fmt::Result {
+    writeln!(out, "# HELP {} {}", name, help)?;
+    writeln!(out, "# TYPE {} gauge", name)?;
+    writeln!(out, "{} {}", name, value)
+}
+
+/// Phase of the node startup. Durations of the phases are recorded in [`NodeMetrics`].
+///
+/// [`NodeMetrics`]: struct.NodeMetrics.html
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+#[non_exhaustive]
+pub enum StartupPhase {
+    /// Opening the node database. This phase is recorded only if its duration is provided
+    /// via `NodeBuilder::with_database_open_time()`.
+    OpenDatabase,
+    /// Restoring the blockchain state, including deploying artifacts
+    /// and restarting service instances.
+    RestoreBlockchain,
+    /// Creating the node, including wiring HTTP API of plugins.
+    CreateNode,
+    /// Initializing the consensus state before connecting to peers.
+    InitializeConsensus,
+    /// Warming up the database caches in the background after the consensus is started.
+    WarmUpCaches,
+}
+
+impl StartupPhase {
+    fn as_str(self) -> &'static str {
+        match self {
+            Self::OpenDatabase => "open_database",
+            Self::RestoreBlockchain => "restore_blockchain",
+            Self::CreateNode => "create_node",
+            Self::InitializeConsensus => "initialize_consensus",
+            Self::WarmUpCaches => "warm_up_caches",
+        }
+    }
+}
+
+/// Performance metrics collected by the node.
+///
+/// Metrics are shared by all parts of the node and can be retrieved via the `metrics()`
+/// method of [`SharedNodeState`]. Use [`to_prometheus()`] to export the metrics in the text
+/// format of [Prometheus].
+///
+/// [`SharedNodeState`]: struct.SharedNodeState.html
+/// [`to_prometheus()`]: #method.to_prometheus
+/// [Prometheus]: https://prometheus.io/docs/instrumenting/exposition_formats/
+#[derive(Debug)]
+pub struct NodeMetrics {
+    round_duration: Histogram,
+    propose_to_commit: Histogram,
+    block_execution: Histogram,
+    tx_execution: Histogram,
+    block_commit: Histogram,
+    block_transactions: Histogram,
+    message_verification: Histogram,
+    verification_batch_size: Histogram,
+    tx_cache_len: AtomicU64,
+    tx_pool_len: AtomicU64,
+    outgoing_queues: Mutex<HashMap<PublicKey, Arc<OutgoingQueue>>>,
+    startup_phases: Mutex<BTreeMap<StartupPhase, Duration>>,
+}
+
+impl Default for NodeMetrics {
+    fn default() -> Self {
+        Self {
+            round_duration: Histogram::durations(),
+            propose_to_commit: Histogram::durations(),
+            block_execution: Histogram::durations(),
+            tx_execution: Histogram::durations(),
+            block_commit: Histogram::durations(),
+            block_transactions: Histogram::sizes(),
+            message_verification: Histogram::durations(),
+            verification_batch_size: Histogram::sizes(),
+            tx_cache_len: AtomicU64::new(0),
+            tx_pool_len: AtomicU64::new(0),
+            outgoing_queues: Mutex::default(),
+            startup_phases: Mutex::default(),
+        }
+    }
+}
+
+impl NodeMetrics {
+    /// Records the duration of a finished consensus round.
+    pub(crate) fn observe_round(&self, duration: Duration) {
+        self.round_duration.observe_duration(duration);
+    }
+
+    /// Records the time between receiving the first proposal of an epoch and committing
+    /// a block for this epoch.
+    pub(crate) fn observe_propose_to_commit(&self, duration: Duration) {
+        self.propose_to_commit.observe_duration(duration);
+    }
+
+    /// Records the execution time of a block with the specified number of transactions.
+    pub(crate) fn observe_block_execution(&self, duration: Duration, tx_count: usize) {
+        self.block_execution.observe_duration(duration);
+        if tx_count > 0 {
+            self.tx_execution
+                .observe_duration(duration / tx_count as u32);
+        }
+    }
+
+    /// Records the time of writing a block with the specified number of transactions
+    /// to the database.
+    pub(crate) fn observe_block_commit(&self, duration: Duration, tx_count: usize) {
+        self.block_commit.observe_duration(duration);
+        self.block_transactions.observe(tx_count as u64);
+    }
+
+    /// Records the time of verifying signatures of a batch of messages.
+    pub(crate) fn observe_verification(&self, duration: Duration, batch_size: usize) {
+        self.message_verification.observe_duration(duration);
+        self.verification_batch_size.observe(batch_size as u64);
+    }
+
+    pub(crate) fn set_tx_cache_len(&self, len: usize) {
+        self.tx_cache_len.store(len as u64, Ordering::Relaxed);
+    }
+
+    pub(crate) fn set_tx_pool_len(&self, len: u64) {
+        self.tx_pool_len.store(len, Ordering::Relaxed);
+    }
+
+    pub(crate) fn add_outgoing_queue(&self, peer: PublicKey, queue: Arc<OutgoingQueue>) {
+        let mut queues = self.outgoing_queues.lock().unwrap();
+        queues.insert(peer, queue);
+    }
+
+    pub(crate) fn remove_outgoing_queue(&self, peer: &PublicKey) {
+        let mut queues = self.outgoing_queues.lock().unwrap();
+        queues.remove(peer);
+    }
+
+    pub(crate) fn observe_startup_phase(&self, phase: StartupPhase, duration: Duration) {
+        let mut phases = self.startup_phases.lock().unwrap();
+        phases.insert(phase, duration);
+    }
+
+    /// Returns the duration of the specified node startup phase, or `None` if the phase
+    /// has not been completed yet.
+    pub fn startup_phase(&self, phase: StartupPhase) -> Option<Duration> {
+        let phases = self.startup_phases.lock().unwrap();
+        phases.get(&phase).copied()
+    }
+
+    /// Exports metrics in the text format of Prometheus.
+    pub fn to_prometheus(&self) -> String {
+        let mut out = String::new();
+        self.write_prometheus(&mut out)
+            .expect("Writing to a string cannot fail");
+        out
+    }
+
+    fn write_prometheus(&self, out: &mut String) -> fmt::Result {
+        self.round_duration.write(
+            out,
+            "exonum_node_round_duration_seconds",
+            "Duration of finished consensus rounds.",
+        )?;
+        self.propose_to_commit.write(
+            out,
+            "exonum_node_propose_to_commit_seconds",
+            "Time from receiving the first proposal of an epoch to committing the block.",
+        )?;
+        self.block_execution.write(
+            out,
+            "exonum_node_block_execution_seconds",
+            "Time of executing proposed blocks.",
+        )?;
+        self.tx_execution.write(
+            out,
+            "exonum_node_tx_execution_seconds",
+            "Average time of executing a transaction within a block.",
+        )?;
+        self.block_commit.write(
+            out,
+            "exonum_node_block_commit_seconds",
+            "Time of writing committed blocks to the database.",
+        )?;
+        self.block_transactions.write(
+            out,
+            "exonum_node_block_transactions",
+            "Number of transactions in committed blocks.",
+        )?;
+        self.message_verification.write(
+            out,
+            "exonum_node_message_verification_seconds",
+            "Time of verifying signatures of a batch of incoming messages.",
+        )?;
+        self.verification_batch_size.write(
+            out,
+            "exonum_node_message_verification_batch_size",
+            "Number of messages verified within a batch.",
+        )?;
+
+        write_gauge(
+            out,
+            "exonum_node_tx_cache_size",
+            "Number of transactions in the ephemeral transaction cache.",
+            self.tx_cache_len.load(Ordering::Relaxed),
+        )?;
+        write_gauge(
+            out,
+            "exonum_node_tx_pool_size",
+            "Number of transactions in the persistent transaction pool.",
+            self.tx_pool_len.load(Ordering::Relaxed),
+        )?;
+
+        let phases = self.startup_phases.lock().unwrap();
+        let name = "exonum_node_startup_phase_seconds";
+        writeln!(out, "# HELP {} Duration of the node startup phases.", name)?;
+        writeln!(out, "# TYPE {} gauge", name)?;
+        for (phase, duration) in &*phases {
+            writeln!(
+                out,
+                "{}{{phase=\"{}\"}} {}",
+                name,
+                phase.as_str(),
+                duration.as_secs_f64()
+            )?;
+        }
+        drop(phases);
+
+        let queues = self.outgoing_queues.lock().unwrap();
+        let name = "exonum_node_peer_outgoing_queue_len";
+        writeln!(out, "# HELP {} Number of messages queued for a peer.", name)?;
+        writeln!(out, "# TYPE {} gauge", name)?;
+        for (peer, queue) in &*queues {
+            writeln!(
+                out,
+                "{}{{peer=\"{}\"}} {}",
+                name,
+                peer.to_hex(),
+                queue.len()
+            )?;
+        }
+        let name = "exonum_node_peer_dropped_broadcasts_total";
+        writeln!(
+            out,
+            "# HELP {} Number of broadcast messages dropped for a peer.",
+            name
+        )?;
+        writeln!(out, "# TYPE {} counter", name)?;
+        for (peer, queue) in &*queues {
+            writeln!(
+                out,
+                "{}{{peer=\"{}\"}} {}",
+                name,
+                peer.to_hex(),
+                queue.dropped()
+            )?;
+        }
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn histogram_buckets_are_cumulative() {
+        let histogram = Histogram::durations();
+        histogram.observe_duration(Duration::from_micros(50));
+        histogram.observe_duration(Duration::from_millis(3));
+        histogram.observe_duration(Duration::from_secs(60));
+
+        let mut out = String::new();
+        histogram.write(&mut out, "test", "Test.").unwrap();
+        assert!(out.contains("test_bucket{le=\"0.0001\"} 1\n"));
+        assert!(out.contains("test_bucket{le=\"0.0025\"} 1\n"));
+        assert!(out.contains("test_bucket{le=\"0.005\"} 2\n"));
+        assert!(out.contains("test_bucket{le=\"10\"} 2\n"));
+        assert!(out.contains("test_bucket{le=\"+Inf\"} 3\n"));
+        let sum_line = out
+            .lines()
+            .find(|line| line.starts_with("test_sum "))
+            .unwrap();
+        let sum: f64 = sum_line["test_sum ".len()..].parse().unwrap();
+        assert!((sum - 60.003_05).abs() < 1e-9);
+        assert!(out.contains("test_count 3\n"));
+    }
+
+    #[test]
+    fn metrics_export() {
+        let metrics = NodeMetrics::default();
+        metrics.observe_block_execution(Duration::from_millis(10), 4);
+        metrics.set_tx_pool_len(42);
+
+        let peer = PublicKey::zero();
+        metrics.add_outgoing_queue(peer, Arc::default());
+        let out = metrics.to_prometheus();
+        assert!(out.contains("exonum_node_block_execution_seconds_count 1\n"));
+        assert!(out.contains("exonum_node_tx_execution_seconds_bucket{le=\"0.0025\"} 1\n"));
+        assert!(out.contains("exonum_node_tx_pool_size 42\n"));
+        let queue_line = format!(
+            "exonum_node_peer_outgoing_queue_len{{peer=\"{}\"}} 0\n",
+            peer
+        );
+        assert!(out.contains(&queue_line));
+
+        metrics.remove_outgoing_queue(&peer);
+        assert!(!metrics.to_prometheus().contains(&queue_line));
+    }
+
+    #[test]
+    fn startup_phases_export() {
+        let metrics = NodeMetrics::default();
+        assert_eq!(metrics.startup_phase(StartupPhase::RestoreBlockchain), None);
+        metrics.observe_startup_phase(
+            StartupPhase::RestoreBlockchain,
+            Duration::from_millis(1_500),
+        );
+        assert_eq!(
+            metrics.startup_phase(StartupPhase::RestoreBlockchain),
+            Some(Duration::from_millis(1_500))
+        );
+
+        let out = metrics.to_prometheus();
+        assert!(
+            out.contains("exonum_node_startup_phase_seconds{phase=\"restore_blockchain\"} 1.5\n")
+        );
+        assert!(!out.contains("phase=\"warm_up_caches\""));
+    }
+}
@@ -25,7 +25,10 @@ use std::{
     sync::{Arc, RwLock},
 };
 
-use crate::{events::ConnectedPeerAddr, state::State, ConnectInfo, ExternalMessage, NodeRole};
+use crate::{
+    events::ConnectedPeerAddr, metrics::NodeMetrics, state::State, ConnectInfo, ExternalMessage,
+    NodeRole,
+};
 
 #[derive(Debug, Default)]
 struct ApiNodeState {
@@ -55,6 +58,7 @@ impl ApiNodeState {
 #[derive(Clone, Debug)]
 pub struct SharedNodeState {
     node: Arc<RwLock<ApiNodeState>>,
+    metrics: Arc<NodeMetrics>,
     state_update_timeout: Milliseconds,
 }
 
@@ -63,6 +67,7 @@ impl SharedNodeState {
     pub fn new(state_update_timeout: Milliseconds) -> Self {
         Self {
             node: Arc::new(RwLock::new(ApiNodeState::new())),
+            metrics: Arc::default(),
             state_update_timeout,
         }
     }
@@ -131,6 +136,7 @@ impl SharedNodeState {
         lock.node_role = NodeRole::new(state.validator_id());
         lock.validators = state.validators().to_vec();
         lock.tx_cache_len = state.tx_cache_len();
+        self.metrics.set_tx_cache_len(lock.tx_cache_len);
 
         for (public_key, addr) in state.connections() {
             match addr {
@@ -174,6 +180,15 @@ impl SharedNodeState {
         let state = self.node.read().expect("Expected read lock");
         state.tx_cache_len
     }
+
+    /// Returns performance metrics of the node.
+    pub fn metrics(&self) -> &NodeMetrics {
+        &self.metrics
+    }
+
+    pub(crate) fn metrics_handle(&self) -> Arc<NodeMetrics> {
+        Arc::clone(&self.metrics)
+    }
 }
 
 /// Context supplied to a node plugin in `wire_api` method.
@@ -56,14 +56,17 @@
 //! [Exonum white paper]: https://bitfury.com/content/downloads/wp_consensus_181227.pdf
 
 use exonum::{
-    blockchain::{Blockchain, ConsensusConfig, PersistentPool, TransactionCache, TxCheckCache},
-    crypto::Hash,
+    blockchain::{
+        Blockchain, ConsensusConfig, ExecutionCosts, PersistentPool, Schema, TransactionCache,
+        TxCheckCache,
+    },
+    crypto::{Hash, PUBLIC_KEY_LENGTH, SIGNATURE_LENGTH},
     helpers::{Height, Round},
     merkledb::Snapshot,
     messages::{AnyTx, Verified},
 };
 
-use std::{collections::BTreeMap, fmt};
+use std::{cmp::Reverse, collections::BTreeMap, fmt, time::Duration};
 
 use crate::State;
 
@@ -77,15 +80,24 @@ pub struct ProposeParams<'a> {
     height: Height,
     round: Round,
     snapshot: &'a dyn Snapshot,
+    execution_costs: ExecutionCosts,
+    pool_size: u64,
 }
 
 impl<'a> ProposeParams<'a> {
-    pub(crate) fn new(state: &State, snapshot: &'a dyn Snapshot) -> Self {
+    pub(crate) fn new(
+        state: &State,
+        snapshot: &'a dyn Snapshot,
+        execution_costs: ExecutionCosts,
+    ) -> Self {
+        let pool_size = Schema::new(snapshot).transactions_pool_len();
         Self {
             consensus_config: state.consensus_config().to_owned(),
             height: state.epoch(),
             round: state.round(),
             snapshot,
+            execution_costs,
+            pool_size: pool_size + state.tx_cache_len() as u64,
         }
     }
 
@@ -108,6 +120,18 @@ impl<'a> ProposeParams<'a> {
     pub fn snapshot(&self) -> &'a dyn Snapshot {
         self.snapshot
     }
+
+    /// Returns estimates of the transaction execution time based on the transactions
+    /// recently executed by the node.
+    pub fn execution_costs(&self) -> &ExecutionCosts {
+        &self.execution_costs
+    }
+
+    /// Returns the number of uncommitted transactions known to the node, both in the persistent
+    /// pool and in the in-memory cache.
+    pub fn pool_size(&self) -> u64 {
+        self.pool_size
+    }
 }
 
 /// Propose template returned by the proposal creator.
@@ -319,3 +343,183 @@ impl<T: ManagePool> ManagePool for SkipEmptyBlocks<T> {
         self.inner.remove_transactions(pool, snapshot)
     }
 }
+
+/// Transaction priority function used by [`AdaptivePoolManager`].
+///
+/// [`AdaptivePoolManager`]: struct.AdaptivePoolManager.html
+pub type PriorityFn = Box<dyn FnMut(&Verified<AnyTx>) -> u64 + Send>;
+
+/// Pool manager that fills proposals up to the target execution time and size budgets.
+///
+/// Execution time of each transaction is estimated based on the recent executions of the same
+/// service method by the node (see [`ExecutionCosts`]). Unlike [`StandardPoolManager`],
+/// which always proposes up to `txs_block_limit` transactions, this manager keeps the execution
+/// time of proposed blocks approximately constant. Heavy transactions thus do not make the block
+/// execution exceed round timeouts, while light transactions are not limited by a conservative
+/// `txs_block_limit`. The latter limit is still respected.
+///
+/// By default, transactions are considered in the pool order. A [priority function] can be used
+/// to propose transactions with higher priority (e.g., ones paying higher fees) first.
+///
+/// Incorrect transactions are removed from the pool in the same way as by `StandardPoolManager`.
+///
+/// # Examples
+///
+/// ```
+/// # use exonum_node::pool::AdaptivePoolManager;
+/// use std::time::Duration;
+///
+/// // Manager proposing blocks that take about 300 ms to execute and are no larger than 1 MB.
+/// let manager = AdaptivePoolManager::default()
+///     .with_execution_budget(Duration::from_millis(300))
+///     .with_size_budget(1 << 20);
+/// ```
+///
+/// [`ExecutionCosts`]: https://docs.rs/exonum/latest/exonum/blockchain/struct.ExecutionCosts.html
+/// [`StandardPoolManager`]: struct.StandardPoolManager.html
+/// [priority function]: #method.with_priority
+pub struct AdaptivePoolManager {
+    execution_budget: Option<Duration>,
+    size_budget: Option<usize>,
+    priority: Option<PriorityFn>,
+    standard: StandardPoolManager,
+}
+
+impl fmt::Debug for AdaptivePoolManager {
+    fn fmt(&self, formatter: &mut fmt::Formatter<'_>) -> fmt::Result {
+        formatter
+            .debug_struct("AdaptivePoolManager")
+            .field("execution_budget", &self.execution_budget)
+            .field("size_budget", &self.size_budget)
+            .field("has_priority", &self.priority.is_some())
+            .field("standard", &self.standard)
+            .finish()
+    }
+}
+
+impl Default for AdaptivePoolManager {
+    fn default() -> Self {
+        Self {
+            execution_budget: None,
+            size_budget: None,
+            priority: None,
+            standard: StandardPoolManager::default(),
+        }
+    }
+}
+
+impl AdaptivePoolManager {
+    /// Part of `first_round_timeout` used as the execution budget if it is not specified
+    /// explicitly.
+    pub const DEFAULT_BUDGET_DIVISOR: u32 = 4;
+
+    /// Maximum number of candidate transactions considered per each transaction in a block
+    /// if the priority function is set.
+    const PRIORITY_CANDIDATES_FACTOR: usize = 4;
+
+    /// Sets the target execution time of proposed blocks. If not set, the budget is
+    /// `first_round_timeout / DEFAULT_BUDGET_DIVISOR`.
+    pub fn with_execution_budget(mut self, budget: Duration) -> Self {
+        self.execution_budget = Some(budget);
+        self
+    }
+
+    /// Sets the maximum cumulative size of transactions in proposed blocks, in bytes.
+    /// If not set, the size of proposals is not limited.
+    pub fn with_size_budget(mut self, budget: usize) -> Self {
+        self.size_budget = Some(budget);
+        self
+    }
+
+    /// Sets the priority function for transactions. Transactions with higher priority
+    /// are proposed first; transactions with equal priority are considered in the pool order.
+    ///
+    /// To limit the amount of work performed on each proposal, the priority is only computed
+    /// for the limited number of correct transactions from the pool, which is proportional
+    /// to `txs_block_limit`.
+    pub fn with_priority<F>(mut self, priority: F) -> Self
+    where
+        F: FnMut(&Verified<AnyTx>) -> u64 + Send + 'static,
+    {
+        self.priority = Some(Box::new(priority));
+        self
+    }
+
+    /// Sets the limit on transactions considered for removal each time a block is accepted.
+    /// See [`StandardPoolManager::with_removal_limit`] for details.
+    ///
+    /// [`StandardPoolManager::with_removal_limit`]: struct.StandardPoolManager.html#method.with_removal_limit
+    pub fn with_removal_limit(mut self, removal_limit: impl Into<Option<usize>>) -> Self {
+        self.standard = StandardPoolManager::with_removal_limit(removal_limit);
+        self
+    }
+
+    fn transaction_size(transaction: &Verified<AnyTx>) -> usize {
+        transaction.as_raw().payload.len() + PUBLIC_KEY_LENGTH + SIGNATURE_LENGTH
+    }
+}
+
+impl ManagePool for AdaptivePoolManager {
+    fn propose_block(&mut self, pool: Pool<'_>, params: ProposeParams<'_>) -> ProposeTemplate {
+        let max_transactions = params.consensus_config.txs_block_limit as usize;
+        let execution_budget = self.execution_budget.unwrap_or_else(|| {
+            Duration::from_millis(params.consensus_config.first_round_timeout)
+                / Self::DEFAULT_BUDGET_DIVISOR
+        });
+        let size_budget = self.size_budget.unwrap_or_else(usize::max_value);
+        let snapshot = params.snapshot();
+        let costs = params.execution_costs();
+        let mut cache = TxCheckCache::new();
+
+        let correct_transactions = pool
+            .transactions()
+            .filter(|(_, tx)| Blockchain::check_tx_with_cache(snapshot, tx, &mut cache).is_ok());
+        let candidates: Box<dyn Iterator<Item = _> + '_> =
+            if let Some(priority) = &mut self.priority {
+                let mut candidates: Vec<_> = correct_transactions
+                    .take(max_transactions.saturating_mul(Self::PRIORITY_CANDIDATES_FACTOR))
+                    .map(|(tx_hash, tx)| (priority(&tx), tx_hash, tx))
+                    .collect();
+                // The sort is stable, so the pool order is retained for equal priorities.
+                candidates.sort_by_key(|(priority, ..)| Reverse(*priority));
+                Box::new(candidates.into_iter().map(|(_, tx_hash, tx)| (tx_hash, tx)))
+            } else {
+                Box::new(correct_transactions)
+            };
+
+        let mut tx_hashes = vec![];
+        let mut execution_time = Duration::default();
+        let mut size = 0;
+        for (tx_hash, tx) in candidates {
+            if tx_hashes.len() >= max_transactions {
+                break;
+            }
+
+            let tx_time = costs.estimate(&tx.payload().call_info);
+            let tx_size = Self::transaction_size(&tx);
+            // The first transaction is always proposed, so that costly transactions
+            // cannot get stuck in the pool.
+            if !tx_hashes.is_empty()
+                && (execution_time + tx_time > execution_budget || size + tx_size > size_budget)
+            {
+                break;
+            }
+            execution_time += tx_time;
+            size += tx_size;
+            tx_hashes.push(tx_hash);
+        }
+
+        log::trace!(
+            "Proposing {} transactions (estimated execution time: {:?}, size: {}, pool size: {})",
+            tx_hashes.len(),
+            execution_time,
+            size,
+            params.pool_size()
+        );
+        ProposeTemplate::ordinary(tx_hashes)
+    }
+
+    fn remove_transactions(&mut self, pool: Pool<'_>, snapshot: &dyn Snapshot) -> Vec<Hash> {
+        self.standard.remove_transactions(pool, snapshot)
+    }
+}
@@ -15,6 +15,7 @@
 use exonum::{
     blockchain::{PersistentPool, Schema, TransactionCache},
     crypto::{Hash, PublicKey},
+    helpers::Height,
     merkledb::BinaryValue,
     messages::Verified,
 };
@@ -25,8 +26,8 @@ use std::mem;
 use crate::{
     messages::{
         BlockRequest, BlockResponse, PoolTransactionsRequest, PrevotesRequest, ProposeRequest,
-        Requests, TransactionsRequest, TransactionsResponse, TX_RES_EMPTY_SIZE,
-        TX_RES_PB_OVERHEAD_PAYLOAD,
+        Requests, TransactionsRequest, TransactionsResponse, BLOCK_REQUEST_MAX_COUNT,
+        TX_RES_EMPTY_SIZE, TX_RES_PB_OVERHEAD_PAYLOAD,
     },
     NodeHandler,
 };
@@ -81,6 +82,9 @@ impl NodeHandler {
     /// Handles `TransactionsRequest` message. For details see the message documentation.
     pub(crate) fn handle_request_txs(&mut self, msg: &Verified<TransactionsRequest>) {
         trace!("HANDLE TRANSACTIONS REQUEST");
+        if !msg.payload().txs.is_empty() {
+            self.state.note_txs_request(msg.author());
+        }
         self.send_transactions_by_hash(msg.author(), &msg.payload().txs);
     }
 
@@ -96,7 +100,7 @@ impl NodeHandler {
         self.send_transactions_by_hash(msg.author(), &hashes);
     }
 
-    fn send_transactions_by_hash(&mut self, author: PublicKey, hashes: &[Hash]) {
+    pub(crate) fn send_transactions_by_hash(&mut self, author: PublicKey, hashes: &[Hash]) {
         let snapshot = self.blockchain.snapshot();
         let mut txs = Vec::new();
         let mut txs_size = 0;
@@ -161,25 +165,36 @@ impl NodeHandler {
         if height > current_height {
             return;
         }
+        if height < self.first_retained_height {
+            // Precommits for the block are pruned, so we cannot prove its authenticity.
+            trace!("Requested block at height {} has been pruned", height);
+            return;
+        }
         let snapshot = self.blockchain.snapshot();
         let schema = Schema::new(&snapshot);
 
-        let mut proof_and_transactions = None;
+        let mut proofs_and_transactions = vec![];
         if height == current_height {
             if let Some(epoch) = msg.payload().epoch() {
                 if self.state.epoch() >= epoch {
                     if let Some(proof) = schema.block_skip_and_precommits() {
-                        proof_and_transactions = Some((proof, vec![]));
+                        proofs_and_transactions.push((proof, vec![]));
                     }
                 }
             }
         } else {
-            let proof = schema.block_and_precommits(height).unwrap();
-            let transactions = schema.block_transactions(height).iter().collect();
-            proof_and_transactions = Some((proof, transactions));
+            // Send all requested blocks from the same snapshot, so that the peer
+            // does not need to make a network round trip for each of them.
+            let count = msg.payload().count().min(BLOCK_REQUEST_MAX_COUNT);
+            let last_height = current_height.0.min(height.0 + u64::from(count));
+            for height in (height.0..last_height).map(Height) {
+                let proof = schema.block_and_precommits(height).unwrap();
+                let transactions = schema.block_transactions(height).iter().collect();
+                proofs_and_transactions.push((proof, transactions));
+            }
         };
 
-        if let Some((proof, transactions)) = proof_and_transactions {
+        for (proof, transactions) in proofs_and_transactions {
             let block_msg = self.sign_message(BlockResponse::new(
                 msg.author(),
                 proof.block,
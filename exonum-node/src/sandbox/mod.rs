@@ -68,7 +68,8 @@ use crate::{
     pool::{ManagePool, StandardPoolManager},
     state::State,
     ApiSender, Configuration, ConnectInfo, ConnectListConfig, ExternalMessage, MemoryPoolConfig,
-    NetworkConfiguration, NodeHandler, NodeSender, SharedNodeState, SystemStateProvider,
+    NetworkConfiguration, NodeHandler, NodeSender, PruningConfig, SharedNodeState,
+    SystemStateProvider,
 };
 
 pub type SharedTime = Arc<Mutex<SystemTime>>;
@@ -129,6 +130,12 @@ impl SandboxInner {
                     let msg = Message::from_signed(msg).expect("Expected valid message.");
                     self.sent.push_back((peer, msg))
                 }
+                NetworkRequest::Broadcast(peers, msg) => {
+                    let msg = Message::from_signed(msg).expect("Expected valid message.");
+                    for peer in peers {
+                        self.sent.push_back((peer, msg.clone()));
+                    }
+                }
                 NetworkRequest::DisconnectWithPeer(_) => {}
             }
         }
@@ -239,6 +246,18 @@ impl Sandbox {
         Verified::from_value(BlockRequest::new(to, height), author, secret_key)
     }
 
+    /// Creates a `BlockRequest` message for several consecutive blocks signed by this validator.
+    pub fn create_batched_block_request(
+        author: PublicKey,
+        to: PublicKey,
+        height: Height,
+        count: u32,
+        secret_key: &SecretKey,
+    ) -> Verified<BlockRequest> {
+        let request = BlockRequest::with_count(to, height, count);
+        Verified::from_value(request, author, secret_key)
+    }
+
     /// Creates a `BlockRequest` message signed by this validator.
     pub fn create_full_block_request(
         author: PublicKey,
@@ -647,11 +666,12 @@ impl Sandbox {
     }
 
     pub fn check_broadcast_status(&self, height: Height, block_hash: Hash) {
-        self.broadcast(&Self::create_status(
+        let first_retained_height = self.inner.borrow().handler.first_retained_height;
+        let status = Status::new(height, height, block_hash, 0)
+            .with_first_retained_height(first_retained_height);
+        self.broadcast(&Verified::from_value(
+            status,
             self.node_public_key(),
-            height,
-            block_hash,
-            0,
             &self.node_secret_key(),
         ));
     }
@@ -956,6 +976,7 @@ impl Sandbox {
             network: NetworkConfiguration::default(),
             peer_discovery: Vec::new(),
             mempool: MemoryPoolConfig::default(),
+            pruning: inner.handler.pruning,
             keys,
         };
 
@@ -1020,6 +1041,8 @@ pub struct SandboxBuilder {
     instances: Vec<InstanceInitParams>,
     artifacts: HashMap<ArtifactId, Vec<u8>>,
     pool_manager: Box<dyn ManagePool>,
+    mempool_config: MemoryPoolConfig,
+    pruning: Option<PruningConfig>,
 }
 
 impl Default for SandboxBuilder {
@@ -1047,6 +1070,8 @@ impl Default for SandboxBuilder {
             instances: Vec::new(),
             artifacts: HashMap::new(),
             pool_manager: Box::new(StandardPoolManager::default()),
+            mempool_config: MemoryPoolConfig::default(),
+            pruning: None,
         }
     }
 }
@@ -1066,6 +1091,17 @@ impl SandboxBuilder {
         self
     }
 
+    pub fn with_mempool<F: FnOnce(&mut MemoryPoolConfig)>(mut self, update: F) -> Self {
+        update(&mut self.mempool_config);
+        self
+    }
+
+    /// Enables historical data pruning retaining the specified number of the latest blocks.
+    pub fn with_pruning(mut self, retained_blocks: u64) -> Self {
+        self.pruning = Some(PruningConfig::new(retained_blocks));
+        self
+    }
+
     pub fn with_validators(mut self, n: u8) -> Self {
         self.validators_count = n;
         self
@@ -1124,9 +1160,11 @@ impl SandboxBuilder {
             self.artifacts,
             self.instances,
             self.consensus_config,
+            self.mempool_config,
             self.validators_count,
         );
         sandbox.inner.borrow_mut().handler.pool_manager = self.pool_manager;
+        sandbox.inner.borrow_mut().handler.pruning = self.pruning;
 
         sandbox.inner.borrow_mut().sent.clear(); // To clear initial connect messages.
         if self.initialize {
@@ -1168,6 +1206,7 @@ fn sandbox_with_services_uninitialized(
     artifacts: HashMap<ArtifactId, Vec<u8>>,
     instances: Vec<InstanceInitParams>,
     consensus: ConsensusConfig,
+    mempool: MemoryPoolConfig,
     validators_count: u8,
 ) -> Sandbox {
     let keys = (0..validators_count)
@@ -1231,7 +1270,8 @@ fn sandbox_with_services_uninitialized(
         connect_list: ConnectList::from_config(connect_list_config),
         network: NetworkConfiguration::default(),
         peer_discovery: Vec::new(),
-        mempool: MemoryPoolConfig::default(),
+        mempool,
+        pruning: None,
         keys: keys[0].clone(),
     };
 
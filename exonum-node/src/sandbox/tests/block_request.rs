@@ -15,22 +15,24 @@
 //! Tests in this module are designed to test communication related to block requests.
 
 use exonum::{
-    blockchain::Epoch,
+    blockchain::{Epoch, Schema},
     crypto::Hash,
     helpers::{Height, Round, ValidatorId},
     merkledb::ObjectHash,
+    messages::Verified,
 };
 
 use std::time::Duration;
 
 use crate::{
+    messages::{BlockResponse, Status},
     sandbox::{
         sandbox_tests_helper::{
             add_one_height, add_one_height_with_transactions, gen_incorrect_tx,
             gen_timestamping_tx, make_prevote_from_propose, BlockBuilder, ProposeBuilder,
             SandboxState, TimestampingSandbox,
         },
-        timestamping_sandbox, Sandbox,
+        timestamping_sandbox, timestamping_sandbox_builder, Sandbox,
     },
     state::{BLOCK_REQUEST_TIMEOUT, TRANSACTIONS_REQUEST_TIMEOUT},
 };
@@ -1220,3 +1222,253 @@ fn handle_outdated_skip_request() {
     );
     sandbox.send(sandbox.public_key(ValidatorId(1)), &response);
 }
+
+#[test]
+fn handle_batched_block_request() {
+    let sandbox = timestamping_sandbox();
+    let tx = gen_timestamping_tx();
+    add_one_height_with_transactions(&sandbox, &SandboxState::new(), vec![&tx]);
+    add_one_height(&sandbox, &SandboxState::new());
+
+    // The node has only 2 committed blocks, so the remaining part of the request is ignored.
+    let request = Sandbox::create_batched_block_request(
+        sandbox.public_key(ValidatorId(1)),
+        sandbox.public_key(ValidatorId(0)),
+        Height(1),
+        5,
+        sandbox.secret_key(ValidatorId(1)),
+    );
+    sandbox.recv(&request);
+
+    for (height, tx_hashes) in vec![(Height(1), vec![tx.object_hash()]), (Height(2), vec![])] {
+        let proof = sandbox.block_and_precommits(height).unwrap();
+        let response = Sandbox::create_block_response(
+            sandbox.public_key(ValidatorId(0)),
+            sandbox.public_key(ValidatorId(1)),
+            proof.block,
+            proof.precommits,
+            tx_hashes,
+            sandbox.secret_key(ValidatorId(0)),
+        );
+        sandbox.send(sandbox.public_key(ValidatorId(1)), &response);
+    }
+}
+
+#[test]
+fn pruned_blocks_are_not_requested() {
+    let sandbox = timestamping_sandbox();
+    let status =
+        Status::new(Height(3), Height(3), Hash::zero(), 0).with_first_retained_height(Height(2));
+    sandbox.recv(&Verified::from_value(
+        status,
+        sandbox.public_key(ValidatorId(3)),
+        sandbox.secret_key(ValidatorId(3)),
+    ));
+
+    // The peer is ahead of us, but it cannot provide the block at height 1.
+    sandbox.add_time(Duration::from_millis(BLOCK_REQUEST_TIMEOUT));
+
+    // An archival peer is asked for the block instead.
+    sandbox.recv(&Sandbox::create_status(
+        sandbox.public_key(ValidatorId(2)),
+        Height(3),
+        Hash::zero(),
+        0,
+        sandbox.secret_key(ValidatorId(2)),
+    ));
+    sandbox.add_time(Duration::from_millis(BLOCK_REQUEST_TIMEOUT));
+    sandbox.send(
+        sandbox.public_key(ValidatorId(2)),
+        &Sandbox::create_block_request(
+            sandbox.public_key(ValidatorId(0)),
+            sandbox.public_key(ValidatorId(2)),
+            Height(1),
+            sandbox.secret_key(ValidatorId(0)),
+        ),
+    );
+}
+
+#[test]
+fn pruning_node_ignores_requests_for_pruned_blocks() {
+    let sandbox = timestamping_sandbox_builder().with_pruning(1).build();
+    let tx = gen_timestamping_tx();
+    add_one_height(&sandbox, &SandboxState::new());
+    add_one_height_with_transactions(&sandbox, &SandboxState::new(), vec![&tx]);
+    // Blocks at heights 0 and 1 have been pruned.
+    let snapshot = sandbox.blockchain().snapshot();
+    assert_eq!(Schema::new(&snapshot).first_retained_height(), Height(2));
+
+    sandbox.recv(&Sandbox::create_block_request(
+        sandbox.public_key(ValidatorId(1)),
+        sandbox.public_key(ValidatorId(0)),
+        Height(1),
+        sandbox.secret_key(ValidatorId(1)),
+    ));
+
+    sandbox.recv(&Sandbox::create_block_request(
+        sandbox.public_key(ValidatorId(1)),
+        sandbox.public_key(ValidatorId(0)),
+        Height(2),
+        sandbox.secret_key(ValidatorId(1)),
+    ));
+    let proof = sandbox.block_and_precommits(Height(2)).unwrap();
+    let response = Sandbox::create_block_response(
+        sandbox.public_key(ValidatorId(0)),
+        sandbox.public_key(ValidatorId(1)),
+        proof.block,
+        proof.precommits,
+        vec![tx.object_hash()],
+        sandbox.secret_key(ValidatorId(0)),
+    );
+    sandbox.send(sandbox.public_key(ValidatorId(1)), &response);
+}
+
+/// Creates a sandbox with the specified number of committed blocks without transactions,
+/// which is used as a source of blocks for a lagging node.
+fn source_sandbox(blocks: u64) -> TimestampingSandbox {
+    let sandbox = timestamping_sandbox();
+    for _ in 0..blocks {
+        add_one_height_with_transactions(&sandbox, &SandboxState::new(), &[]);
+    }
+    sandbox
+}
+
+fn committed_block_hash(sandbox: &TimestampingSandbox, height: Height) -> Hash {
+    sandbox
+        .block_and_precommits(height)
+        .unwrap()
+        .block
+        .object_hash()
+}
+
+fn create_block_response_from(
+    sandbox: &TimestampingSandbox,
+    source: &TimestampingSandbox,
+    from: ValidatorId,
+    height: Height,
+) -> Verified<BlockResponse> {
+    let proof = source.block_and_precommits(height).unwrap();
+    Sandbox::create_block_response(
+        sandbox.public_key(from),
+        sandbox.public_key(ValidatorId(0)),
+        proof.block,
+        proof.precommits,
+        vec![],
+        sandbox.secret_key(from),
+    )
+}
+
+/// - get `Status` from other node with later height, send batched `BlockRequest` to this node
+/// - receive `BlockResponse`s in reverse order
+/// - blocks for future heights should be queued and committed once the previous block
+///   is committed
+#[test]
+fn handle_batched_block_responses_out_of_order() {
+    let source = source_sandbox(3);
+    let sandbox = timestamping_sandbox();
+
+    sandbox.recv(&Sandbox::create_status(
+        sandbox.public_key(ValidatorId(3)),
+        Height(4),
+        source.last_hash(),
+        0,
+        sandbox.secret_key(ValidatorId(3)),
+    ));
+    sandbox.add_time(Duration::from_millis(BLOCK_REQUEST_TIMEOUT));
+    sandbox.send(
+        sandbox.public_key(ValidatorId(3)),
+        &Sandbox::create_batched_block_request(
+            sandbox.public_key(ValidatorId(0)),
+            sandbox.public_key(ValidatorId(3)),
+            Height(1),
+            3,
+            sandbox.secret_key(ValidatorId(0)),
+        ),
+    );
+
+    for height in [3, 2].iter().copied().map(Height) {
+        let response = create_block_response_from(&sandbox, &source, ValidatorId(3), height);
+        sandbox.recv(&response);
+    }
+    sandbox.assert_state(Height(1), Round(1));
+
+    let response = create_block_response_from(&sandbox, &source, ValidatorId(3), Height(1));
+    sandbox.recv(&response);
+    for height in (1..=3).map(Height) {
+        sandbox.check_broadcast_status(height.next(), committed_block_hash(&source, height));
+    }
+    sandbox.assert_state(Height(4), Round(1));
+    assert_eq!(sandbox.last_hash(), source.last_hash());
+}
+
+/// - get `Status` from two nodes with later height, send batched `BlockRequest` to one of them
+/// - receive an invalid `BlockResponse` for the future height from this node, which is queued
+/// - receive a valid block for the following height from another node, which is ignored
+/// - receive a valid `BlockResponse` for the next height and commit it
+/// - the invalid queued block should be dropped and requested from another node
+#[test]
+fn invalid_queued_block_is_requested_again() {
+    let source = source_sandbox(2);
+    let sandbox = timestamping_sandbox();
+
+    sandbox.recv(&Sandbox::create_status(
+        sandbox.public_key(ValidatorId(3)),
+        Height(3),
+        source.last_hash(),
+        0,
+        sandbox.secret_key(ValidatorId(3)),
+    ));
+    sandbox.add_time(Duration::from_millis(BLOCK_REQUEST_TIMEOUT));
+    sandbox.send(
+        sandbox.public_key(ValidatorId(3)),
+        &Sandbox::create_batched_block_request(
+            sandbox.public_key(ValidatorId(0)),
+            sandbox.public_key(ValidatorId(3)),
+            Height(1),
+            2,
+            sandbox.secret_key(ValidatorId(0)),
+        ),
+    );
+    sandbox.recv(&Sandbox::create_status(
+        sandbox.public_key(ValidatorId(2)),
+        Height(3),
+        source.last_hash(),
+        0,
+        sandbox.secret_key(ValidatorId(2)),
+    ));
+
+    // The block is not authenticated by the precommits.
+    let block = source.block_and_precommits(Height(2)).unwrap().block;
+    sandbox.recv(&Sandbox::create_block_response(
+        sandbox.public_key(ValidatorId(3)),
+        sandbox.public_key(ValidatorId(0)),
+        block,
+        vec![],
+        vec![],
+        sandbox.secret_key(ValidatorId(3)),
+    ));
+    // The queued block cannot be replaced by another peer.
+    let valid_response = create_block_response_from(&sandbox, &source, ValidatorId(1), Height(2));
+    sandbox.recv(&valid_response);
+
+    let response = create_block_response_from(&sandbox, &source, ValidatorId(3), Height(1));
+    sandbox.recv(&response);
+    sandbox.check_broadcast_status(Height(2), committed_block_hash(&source, Height(1)));
+    sandbox.assert_state(Height(2), Round(1));
+
+    sandbox.add_time(Duration::from_millis(BLOCK_REQUEST_TIMEOUT));
+    sandbox.send(
+        sandbox.public_key(ValidatorId(2)),
+        &Sandbox::create_block_request(
+            sandbox.public_key(ValidatorId(0)),
+            sandbox.public_key(ValidatorId(2)),
+            Height(2),
+            sandbox.secret_key(ValidatorId(0)),
+        ),
+    );
+
+    let response = create_block_response_from(&sandbox, &source, ValidatorId(2), Height(2));
+    sandbox.recv(&response);
+    sandbox.check_broadcast_status(Height(3), source.last_hash());
+    sandbox.assert_state(Height(3), Round(1));
+}
@@ -27,7 +27,9 @@ use std::{collections::BTreeSet, iter::FromIterator, time::Duration};
 
 use crate::{
     messages::{TX_RES_EMPTY_SIZE, TX_RES_PB_OVERHEAD_PAYLOAD},
-    pool::{ManagePool, Pool, ProposeParams, ProposeTemplate, StandardPoolManager},
+    pool::{
+        AdaptivePoolManager, ManagePool, Pool, ProposeParams, ProposeTemplate, StandardPoolManager,
+    },
     sandbox::{
         sandbox_tests_helper::{
             add_one_height, add_one_height_with_transactions, gen_incorrect_tx,
@@ -626,6 +628,69 @@ fn expedited_propose_on_transaction_pressure() {
     sandbox.broadcast(&make_prevote_from_propose(&sandbox, &propose));
 }
 
+/// Checks that the leader pushes transactions of its proposal to the peer which has
+/// recently requested transactions from it.
+#[test]
+fn propose_txs_are_pushed_to_peers_lacking_txs() {
+    let sandbox = timestamping_sandbox_builder()
+        .with_mempool(|config| config.push_propose_txs = true)
+        .build();
+
+    let tx = gen_timestamping_tx();
+    sandbox.recv(&tx);
+    // The request from a peer with unknown state is served, but not remembered.
+    sandbox.recv(&Sandbox::create_transactions_request(
+        sandbox.public_key(ValidatorId(2)),
+        sandbox.public_key(ValidatorId(0)),
+        vec![tx.object_hash()],
+        sandbox.secret_key(ValidatorId(2)),
+    ));
+    sandbox.send(
+        sandbox.public_key(ValidatorId(2)),
+        &Sandbox::create_transactions_response(
+            sandbox.public_key(ValidatorId(0)),
+            sandbox.public_key(ValidatorId(2)),
+            vec![tx.clone()],
+            sandbox.secret_key(ValidatorId(0)),
+        ),
+    );
+
+    sandbox.recv(&Sandbox::create_status(
+        sandbox.public_key(ValidatorId(1)),
+        Height(1),
+        sandbox.last_hash(),
+        0,
+        sandbox.secret_key(ValidatorId(1)),
+    ));
+    sandbox.recv(&Sandbox::create_transactions_request(
+        sandbox.public_key(ValidatorId(1)),
+        sandbox.public_key(ValidatorId(0)),
+        vec![tx.object_hash()],
+        sandbox.secret_key(ValidatorId(1)),
+    ));
+    let tx_response = Sandbox::create_transactions_response(
+        sandbox.public_key(ValidatorId(0)),
+        sandbox.public_key(ValidatorId(1)),
+        vec![tx.clone()],
+        sandbox.secret_key(ValidatorId(0)),
+    );
+    sandbox.send(sandbox.public_key(ValidatorId(1)), &tx_response);
+
+    // Wait for us to become the leader.
+    sandbox.add_time(Duration::from_millis(sandbox.current_round_timeout()));
+    sandbox.add_time(Duration::from_millis(sandbox.current_round_timeout()));
+    assert!(sandbox.is_leader());
+    sandbox.add_time(Duration::from_millis(PROPOSE_TIMEOUT));
+
+    let propose = ProposeBuilder::new(&sandbox)
+        .with_tx_hashes(&[tx.object_hash()])
+        .build();
+    sandbox.broadcast(&propose);
+    // Only the known peer which has requested transactions receives them.
+    sandbox.send(sandbox.public_key(ValidatorId(1)), &tx_response);
+    sandbox.broadcast(&make_prevote_from_propose(&sandbox, &propose));
+}
+
 #[test]
 fn valid_txs_are_broadcast() {
     let sandbox = timestamping_sandbox();
@@ -796,6 +861,87 @@ fn propose_with_custom_logic() {
     sandbox.broadcast(&prevote);
 }
 
+fn check_adaptive_propose(sandbox: &Sandbox, tx_hashes: Vec<Hash>) {
+    while !sandbox.is_leader() {
+        sandbox.add_time(Duration::from_millis(sandbox.current_round_timeout()));
+    }
+    let (height, round) = (sandbox.current_epoch(), sandbox.current_round());
+    sandbox.add_time(Duration::from_millis(sandbox.current_round_timeout()));
+
+    let propose = sandbox.create_propose(
+        ValidatorId(0),
+        height,
+        round,
+        sandbox.last_hash(),
+        tx_hashes,
+        sandbox.secret_key(ValidatorId(0)),
+    );
+    sandbox.broadcast(&propose);
+    sandbox.broadcast(&make_prevote_from_propose(sandbox, &propose));
+}
+
+#[test]
+fn adaptive_propose_respects_priority() {
+    let sandbox = timestamping_sandbox_builder()
+        .with_consensus(|config| config.txs_block_limit = 2)
+        .with_pool_manager(
+            AdaptivePoolManager::default().with_priority(|tx| tx.payload().arguments.len() as u64),
+        )
+        .build();
+
+    let keypair = KeyPair::random();
+    let transactions = (1..=3)
+        .map(|len| keypair.timestamp(TimestampingService::ID, vec![0; len]))
+        .collect::<Vec<_>>();
+    for tx in &transactions {
+        sandbox.recv(tx);
+    }
+
+    // Transactions with the largest arguments are proposed first.
+    let tx_hashes = vec![transactions[2].object_hash(), transactions[1].object_hash()];
+    check_adaptive_propose(&sandbox, tx_hashes);
+}
+
+#[test]
+fn adaptive_propose_respects_size_budget() {
+    let sandbox = timestamping_sandbox_builder()
+        .with_pool_manager(AdaptivePoolManager::default().with_size_budget(1))
+        .build();
+
+    let transactions = TimestampingTxGenerator::new(64).take(3).collect::<Vec<_>>();
+    for tx in &transactions {
+        sandbox.recv(tx);
+    }
+
+    // A single transaction is proposed even if it does not fit into the budget.
+    let tx_hashes = tx_hashes(&transactions);
+    check_adaptive_propose(&sandbox, vec![tx_hashes[0]]);
+}
+
+#[test]
+fn adaptive_propose_respects_execution_budget() {
+    let sandbox = timestamping_sandbox_builder()
+        .with_pool_manager(
+            AdaptivePoolManager::default().with_execution_budget(Duration::from_nanos(1)),
+        )
+        .build();
+
+    // Execution costs are estimated based on the executed transactions, so the budget
+    // has no effect until the node executes a block with transactions.
+    add_one_height(&sandbox, &SandboxState::new());
+    let costs = sandbox.blockchain_mut().execution_costs();
+    assert!(costs.average_cost().is_some());
+
+    let transactions = TimestampingTxGenerator::new(64).take(3).collect::<Vec<_>>();
+    for tx in &transactions {
+        sandbox.recv(tx);
+    }
+
+    // A single transaction is proposed even if it does not fit into the budget.
+    let tx_hashes = tx_hashes(&transactions);
+    check_adaptive_propose(&sandbox, vec![tx_hashes[0]]);
+}
+
 #[test]
 fn custom_proposer_does_not_influence_external_proposes() {
     let keypair = KeyPair::random();
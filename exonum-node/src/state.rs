@@ -19,7 +19,7 @@ use bit_vec::BitVec;
 use exonum::{
     blockchain::{
         Block, BlockKind, BlockPatch, BlockchainMut, ConsensusConfig, PersistentPool,
-        TransactionCache, TxCheckCache, ValidatorKeys,
+        TransactionCache, TxCheckCache, TxLocation, ValidatorKeys,
     },
     crypto::{Hash, PublicKey},
     helpers::{byzantine_quorum, Height, Milliseconds, Round, ValidatorId},
@@ -31,16 +31,16 @@ use log::{error, trace};
 
 use std::{
     cmp::Reverse,
-    collections::{hash_map::Entry, BTreeMap, HashMap, HashSet},
+    collections::{btree_map, hash_map::Entry, BTreeMap, HashMap, HashSet},
     sync::{Arc, RwLock},
-    time::{Duration, SystemTime},
+    time::{Duration, Instant, SystemTime},
 };
 
 use crate::{
     connect_list::ConnectList,
     consensus::{PersistChanges, RoundAction},
     events::ConnectedPeerAddr,
-    messages::{Connect, Consensus as ConsensusMessage, Prevote, Propose, Status},
+    messages::{BlockResponse, Connect, Consensus as ConsensusMessage, Prevote, Propose, Status},
     Configuration, ConnectInfo, FlushPoolStrategy,
 };
 
@@ -54,12 +54,19 @@ pub const TRANSACTIONS_REQUEST_TIMEOUT: Milliseconds = 100;
 pub const PREVOTES_REQUEST_TIMEOUT: Milliseconds = 100;
 /// Timeout value for the `BlockRequest` message.
 pub const BLOCK_REQUEST_TIMEOUT: Milliseconds = 100;
+/// Number of epochs during which the transactions of our proposals are pushed to a peer
+/// after it has requested missing transactions from us.
+pub const PUSH_PROPOSE_TXS_EPOCHS: u64 = 10;
 
 /// Peer's state.
 #[derive(Debug, Clone, Copy)]
 pub struct PeerState {
     pub epoch: Height,
     pub blockchain_height: Height,
+    /// Height of the earliest block the peer can provide to us.
+    pub first_retained_height: Height,
+    /// Our epoch when the peer has last requested transactions from us.
+    pub txs_requested_at: Option<Height>,
 }
 
 impl PeerState {
@@ -67,8 +74,15 @@ impl PeerState {
         Self {
             epoch: status.epoch,
             blockchain_height: status.blockchain_height,
+            first_retained_height: status.first_retained_height,
+            txs_requested_at: None,
         }
     }
+
+    /// Checks whether the peer has not pruned the block at the specified height.
+    pub fn can_provide_block(&self, height: Height) -> bool {
+        self.first_retained_height <= height
+    }
 }
 
 impl Default for PeerState {
@@ -76,6 +90,8 @@ impl Default for PeerState {
         Self {
             epoch: Height::zero(),
             blockchain_height: Height::zero(),
+            first_retained_height: Height::zero(),
+            txs_requested_at: None,
         }
     }
 }
@@ -129,6 +145,10 @@ pub struct State {
     epoch_start_time: SystemTime,
     epoch: Height,
     blockchain_height: Height,
+    // Monotonic timestamps used in node metrics. Unlike `epoch_start_time`, they are
+    // not affected by the system time provider.
+    round_start: Instant,
+    first_propose_time: Option<Instant>,
 
     round: Round,
     locked_round: Round,
@@ -142,6 +162,10 @@ pub struct State {
     precommits: HashMap<(Round, Hash), Votes<Verified<Precommit>>>,
 
     queued: Vec<ConsensusMessage>,
+    // Blocks for future heights received as a part of a batched `BlockResponse`.
+    queued_blocks: BTreeMap<Height, Verified<BlockResponse>>,
+    // Maximum number of blocks requested from a peer at once.
+    block_sync_window: u32,
 
     // Unknown `Propose` messages confirmed by a majority of `Precommit`s.
     proposes_confirmed_by_majority: HashMap<Hash, (Round, Hash)>,
@@ -158,6 +182,7 @@ pub struct State {
     // Cache that stores transactions before adding to persistent pool.
     tx_cache: BTreeMap<Hash, Verified<AnyTx>>,
     flush_pool_strategy: FlushPoolStrategy,
+    push_propose_txs: bool,
     tx_check_cache: TxCheckCache,
 
     // An in-memory set of transaction hashes, rejected by a node
@@ -570,6 +595,8 @@ impl State {
             epoch: last_epoch.next(),
             epoch_start_time,
             blockchain_height: last_block.height.next(),
+            round_start: Instant::now(),
+            first_propose_time: None,
             round: Round::zero(),
             locked_round: Round::zero(),
             locked_propose: None,
@@ -581,6 +608,8 @@ impl State {
             precommits: HashMap::new(),
 
             queued: Vec::new(),
+            queued_blocks: BTreeMap::new(),
+            block_sync_window: config.network.block_sync_window,
 
             proposes_confirmed_by_majority: HashMap::new(),
 
@@ -595,6 +624,7 @@ impl State {
             incomplete_block: None,
             tx_cache: BTreeMap::new(),
             flush_pool_strategy: config.mempool.flush_pool_strategy,
+            push_propose_txs: config.mempool.push_propose_txs,
             tx_check_cache: TxCheckCache::new(),
             invalid_txs: HashSet::default(),
 
@@ -786,7 +816,10 @@ impl State {
         let current_state = self.peer_states.entry(key).or_default();
         if current_state.epoch < new_state.epoch {
             if current_state.blockchain_height <= new_state.blockchain_height {
-                *current_state = new_state;
+                *current_state = PeerState {
+                    txs_requested_at: current_state.txs_requested_at,
+                    ..new_state
+                };
             } else {
                 log::warn!(
                     "Node {:?} has provided inconsistent `Status`: previously known \
@@ -799,13 +832,58 @@ impl State {
         }
     }
 
+    /// Returns the blockchain height of the specified peer, if it is known.
+    pub(super) fn peer_height(&self, key: &PublicKey) -> Option<Height> {
+        self.peer_states
+            .get(key)
+            .map(|state| state.blockchain_height)
+    }
+
+    /// Remembers that the specified peer has requested transactions from us
+    /// in the current epoch. Requests from peers with unknown state are ignored.
+    pub(super) fn note_txs_request(&mut self, key: PublicKey) {
+        let epoch = self.epoch;
+        if let Some(state) = self.peer_states.get_mut(&key) {
+            state.txs_requested_at = Some(epoch);
+        }
+    }
+
+    /// Returns connected peers which should receive transactions of our proposals proactively,
+    /// i.e., peers that have requested transactions from us during the last
+    /// `PUSH_PROPOSE_TXS_EPOCHS` epochs. Returns an empty list if pushing transactions
+    /// is disabled in the node configuration.
+    pub(super) fn peers_lacking_txs(&self) -> Vec<PublicKey> {
+        if !self.push_propose_txs {
+            return vec![];
+        }
+
+        self.peer_states
+            .iter()
+            .filter(|(key, state)| {
+                let is_recent = state.txs_requested_at.map_or(false, |epoch| {
+                    epoch.0 + PUSH_PROPOSE_TXS_EPOCHS > self.epoch.0
+                });
+                is_recent && self.peers.contains_key(key)
+            })
+            .map(|(&key, _)| key)
+            .collect()
+    }
+
+    /// Returns the maximum number of blocks that can be requested from a peer at once.
+    pub(super) fn block_sync_window(&self) -> u32 {
+        self.block_sync_window
+    }
+
     /// Returns a list of nodes whose height is bigger than one of the current node.
     pub(super) fn advanced_peers(&self) -> AdvancedPeers {
         let mut peers_with_greater_height = vec![];
         let mut peers_with_greater_epoch = vec![];
         for (&key, state) in &self.peer_states {
             if state.blockchain_height > self.blockchain_height {
-                peers_with_greater_height.push(key);
+                // Peers which have pruned the next block cannot help us to catch up.
+                if state.can_provide_block(self.blockchain_height) {
+                    peers_with_greater_height.push(key);
+                }
             } else if state.epoch > self.epoch {
                 peers_with_greater_epoch.push(key);
             }
@@ -897,11 +975,23 @@ impl State {
     /// Updates mode's round.
     pub(super) fn jump_round(&mut self, round: Round) {
         self.round = round;
+        self.round_start = Instant::now();
     }
 
     /// Increments node's round by one.
     pub(super) fn new_round(&mut self) {
         self.round.increment();
+        self.round_start = Instant::now();
+    }
+
+    /// Returns the time elapsed since the current round has started.
+    pub(super) fn round_elapsed(&self) -> Duration {
+        self.round_start.elapsed()
+    }
+
+    /// Returns the moment when the first `Propose` for the current epoch became known.
+    pub(super) fn first_propose_time(&self) -> Option<Instant> {
+        self.first_propose_time
     }
 
     /// Return incomplete block.
@@ -922,6 +1012,8 @@ impl State {
 
         self.epoch = new_epoch;
         self.epoch_start_time = epoch_start_time;
+        self.round_start = Instant::now();
+        self.first_propose_time = None;
         self.round = Round::first();
         self.locked_round = Round::zero();
         self.locked_propose = None;
@@ -965,6 +1057,30 @@ impl State {
         self.queued.push(msg);
     }
 
+    /// Adds a block for a future height to the queue. Blocks which are too far ahead
+    /// of the current blockchain height are ignored. If a block for the same height is
+    /// already queued, the queued block is retained, so that a peer cannot replace it.
+    pub(super) fn add_queued_block(&mut self, msg: Verified<BlockResponse>) -> bool {
+        let height = msg.payload().block.height;
+        let max_height = Height(self.blockchain_height.0 + u64::from(self.block_sync_window));
+        if height <= self.blockchain_height || height >= max_height {
+            return false;
+        }
+        if let btree_map::Entry::Vacant(entry) = self.queued_blocks.entry(height) {
+            entry.insert(msg);
+            true
+        } else {
+            false
+        }
+    }
+
+    /// Takes a queued block for the current blockchain height, if any. Blocks for
+    /// the previous heights are removed from the queue.
+    pub(super) fn take_queued_block(&mut self) -> Option<Verified<BlockResponse>> {
+        self.queued_blocks = self.queued_blocks.split_off(&self.blockchain_height);
+        self.queued_blocks.remove(&self.blockchain_height)
+    }
+
     /// Checks whether some proposes are waiting for this transaction.
     /// Returns a list of proposes that don't contain unknown transactions.
     ///
@@ -1109,6 +1225,7 @@ impl State {
         );
 
         let propose_hash = msg.object_hash();
+        self.first_propose_time.get_or_insert_with(Instant::now);
         self.proposes.insert(
             propose_hash,
             ProposeState {
@@ -1129,7 +1246,7 @@ impl State {
         &mut self,
         msg: Verified<Propose>,
         transactions: &MapIndex<T, Hash, Verified<AnyTx>>,
-        transaction_pool: &KeySetIndex<T, Hash>,
+        transactions_locations: &MapIndex<T, Hash, TxLocation>,
     ) -> anyhow::Result<&ProposeState> {
         let propose_hash = msg.object_hash();
         match self.proposes.entry(propose_hash) {
@@ -1143,10 +1260,13 @@ impl State {
                         continue;
                     }
 
-                    if transactions.contains(hash) {
-                        if !transaction_pool.contains(hash) {
-                            bail!("Received propose with already committed transaction");
-                        }
+                    if transactions_locations.contains(hash) {
+                        // This check relies on locations rather than on transaction bodies,
+                        // since the latter may be pruned.
+                        bail!("Received propose with already committed transaction");
+                    } else if transactions.contains(hash) {
+                        // Tx with `hash` is in the persistent pool.
+                        continue;
                     } else if self.invalid_txs.contains(hash) {
                         // If the propose contains an invalid transaction,
                         // we don't stop processing, since we expect this propose to
@@ -1162,6 +1282,7 @@ impl State {
                     }
                 }
 
+                self.first_propose_time.get_or_insert_with(Instant::now);
                 Ok(e.insert(ProposeState {
                     propose: msg,
                     unknown_txs,
@@ -12,17 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-use criterion::{BatchSize, Bencher, Criterion};
+use criterion::{BatchSize, Bencher, Criterion, Throughput};
 use rand::{rngs::StdRng, Rng, SeedableRng};
 
+use std::thread;
+
 use exonum::{
     blockchain::{
         config::GenesisConfigBuilder, ApiSender, Blockchain, BlockchainBuilder, ConsensusConfig,
         TxCheckCache,
     },
     crypto::KeyPair,
-    merkledb::{Snapshot, TemporaryDB},
-    messages::{AnyTx, Verified},
+    merkledb::{BinaryValue, Snapshot, TemporaryDB},
+    messages::{AnyTx, SignedMessage, Verified},
     runtime::{
         migrations::{InitMigrationError, MigrationScript},
         oneshot::Receiver,
@@ -37,6 +39,9 @@ const TX_PER_BLOCK: usize = 128;
 #[cfg(feature = "long_benchmarks")]
 const TX_PER_BLOCK: usize = 2_048;
 
+/// Number of threads used to admit transactions in parallel.
+const ADMISSION_THREADS: usize = 4;
+
 #[derive(Debug)]
 struct DummyRuntime;
 
@@ -165,10 +170,77 @@ fn check_tx_cache(bencher: &mut Bencher) {
     )
 }
 
+/// Performs all checks of transactions received from the network: deserialization,
+/// signature verification and `check_tx` against a single snapshot. Returns the number
+/// of admitted transactions.
+fn admit_transactions(blockchain: &Blockchain, raw_transactions: &[Vec<u8>]) -> usize {
+    let snapshot = blockchain.snapshot();
+    let mut cache = TxCheckCache::new();
+    raw_transactions
+        .iter()
+        .filter_map(|raw| {
+            SignedMessage::from_bytes(raw.as_slice().into())
+                .and_then(SignedMessage::into_verified::<AnyTx>)
+                .ok()
+        })
+        .filter(|tx| Blockchain::check_tx_with_cache(&snapshot, tx, &mut cache).is_ok())
+        .count()
+}
+
+fn prepare_raw_transactions(count: usize) -> Vec<Vec<u8>> {
+    prepare_transactions(count)
+        .into_iter()
+        .map(|tx| tx.into_raw().into_bytes())
+        .collect()
+}
+
+fn admission_sequential(bencher: &mut Bencher) {
+    let blockchain = prepare_blockchain();
+    let transactions = prepare_raw_transactions(TX_PER_BLOCK);
+    bencher.iter(|| assert_eq!(admit_transactions(&blockchain, &transactions), TX_PER_BLOCK));
+}
+
+fn admission_parallel(bencher: &mut Bencher) {
+    let blockchain = prepare_blockchain();
+    let transactions = prepare_raw_transactions(TX_PER_BLOCK);
+    let chunk_size = (TX_PER_BLOCK + ADMISSION_THREADS - 1) / ADMISSION_THREADS;
+
+    bencher.iter_batched(
+        || {
+            transactions
+                .chunks(chunk_size)
+                .map(<[_]>::to_vec)
+                .collect::<Vec<_>>()
+        },
+        |chunks| {
+            let handles: Vec<_> = chunks
+                .into_iter()
+                .map(|chunk| {
+                    let blockchain = blockchain.clone();
+                    thread::spawn(move || admit_transactions(&blockchain, &chunk))
+                })
+                .collect();
+            let admitted: usize = handles
+                .into_iter()
+                .map(|handle| handle.join().unwrap())
+                .sum();
+            assert_eq!(admitted, TX_PER_BLOCK);
+        },
+        BatchSize::SmallInput,
+    )
+}
+
 pub fn bench_check_tx(c: &mut Criterion) {
     let mut group = c.benchmark_group("check_tx/single_service");
     group
         .bench_function("no_cache", check_tx_no_cache)
         .bench_function("cache", check_tx_cache);
     group.finish();
+
+    let mut group = c.benchmark_group("check_tx/admission");
+    group
+        .throughput(Throughput::Elements(TX_PER_BLOCK as u64))
+        .bench_function("sequential", admission_sequential)
+        .bench_function("parallel", admission_parallel);
+    group.finish();
 }
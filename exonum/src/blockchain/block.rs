@@ -16,12 +16,14 @@ use anyhow::ensure;
 use exonum_crypto::{Hash, PublicKey};
 use exonum_derive::{BinaryValue, ObjectHash};
 use exonum_merkledb::{
-    proof_map::MapProofError, BinaryValue, MapProof, ObjectHash, ValidationError,
+    proof_map::{CheckedMapProof, Hashed, MapProofError, ToProofPath},
+    BinaryValue, MapProof, ObjectHash, ValidationError,
 };
 use exonum_proto::ProtobufConvert;
+use protobuf::Message;
 use thiserror::Error;
 
-use std::borrow::Cow;
+use std::{borrow::Cow, collections::BTreeMap};
 
 use crate::{
     blockchain::CallInBlock,
@@ -301,7 +303,8 @@ impl BlockProof {
     }
 }
 
-/// Errors that can occur during verification of `BlockProof`s, `IndexProof`s and `CallProof`s.
+/// Errors that can occur during verification of `BlockProof`s, `IndexProof`s, `MultiIndexProof`s
+/// and `CallProof`s.
 #[derive(Debug, Error)]
 #[non_exhaustive]
 pub enum ProofError {
@@ -395,6 +398,160 @@ impl IndexProof {
     }
 }
 
+/// Proof of authenticity for entries of several `ProofMapIndex`es within the database.
+///
+/// The proof consists of three parts:
+///
+/// - `block_proof`: block header with the proof of authenticity
+/// - `index_proof`: a multiproof from the state aggregator for the full names of all
+///   proven indexes. Indexes missing from the aggregator are proven to be absent
+/// - `entry_proofs`: multiproofs for the requested keys, one per index present in
+///   `index_proof` and keyed by the full index name
+///
+/// Compared to a set of separate [`IndexProof`]s and [`MapProof`]s, the block header and
+/// its precommits are transferred and verified only once, and the nodes shared by the paths
+/// to several keys are included only once. All indexes covered by the proof must have
+/// the same key and value types.
+///
+/// The proof can be encoded either with `serde` (e.g., as JSON) or with Protobuf
+/// via `BinaryValue`; the latter is significantly more compact.
+///
+/// [`IndexProof`]: struct.IndexProof.html
+/// [`MapProof`]: ../../merkledb/struct.MapProof.html
+#[derive(Debug, Clone, Serialize, Deserialize)]
+#[serde(bound(
+    serialize = "K: serde::Serialize, V: serde::Serialize",
+    deserialize = "K: serde::Deserialize<'de>, V: serde::Deserialize<'de>"
+))]
+#[non_exhaustive]
+pub struct MultiIndexProof<K, V, KeyMode = Hashed> {
+    /// Proof of authenticity for the block header.
+    #[serde(flatten)]
+    pub block_proof: BlockProof,
+
+    /// Proof of authenticity for the indexes. Keys are full index names in the form
+    /// `$service_name.$name_within_service`, e.g., `cryptocurrency.wallets`.
+    /// The root hash of the proof must be equal to the `state_hash` mentioned in `block_proof`.
+    pub index_proof: MapProof<String, Hash>,
+
+    /// Proofs for the entries within the indexes, keyed by the full index name.
+    /// The root hash of each proof must be equal to the index hash from `index_proof`.
+    pub entry_proofs: BTreeMap<String, MapProof<K, V, KeyMode>>,
+}
+
+impl<K, V, KeyMode> MultiIndexProof<K, V, KeyMode> {
+    /// Creates a new `MultiIndexProof` object.
+    pub fn new(
+        block_proof: BlockProof,
+        index_proof: MapProof<String, Hash>,
+        entry_proofs: BTreeMap<String, MapProof<K, V, KeyMode>>,
+    ) -> Self {
+        Self {
+            block_proof,
+            index_proof,
+            entry_proofs,
+        }
+    }
+}
+
+impl<K, V, KeyMode> MultiIndexProof<K, V, KeyMode>
+where
+    V: BinaryValue,
+    KeyMode: ToProofPath<K>,
+{
+    /// Verifies this proof, returning checked entry proofs keyed by the full index name.
+    ///
+    /// The block header and the state aggregator proof are verified once for all indexes.
+    /// Indexes absent from the returned map are either proven to be missing from the state
+    /// aggregator, or have no entries requested.
+    pub fn verify(
+        &self,
+        validator_keys: &[PublicKey],
+    ) -> Result<BTreeMap<&str, CheckedMapProof<'_, K, V>>, ProofError> {
+        self.block_proof.verify(validator_keys)?;
+
+        let index_hashes: BTreeMap<_, _> = self
+            .index_proof
+            .check_against_hash(self.block_proof.block.state_hash)
+            .map_err(ProofError::IncorrectEntryProof)?
+            .entries()
+            .map(|(name, hash)| (name.as_str(), *hash))
+            .collect();
+
+        let mut checked_proofs = BTreeMap::new();
+        for (name, proof) in &self.entry_proofs {
+            // Entries may be proven only for the indexes present in the aggregator.
+            let index_hash = *index_hashes.get(name.as_str()).ok_or(ProofError::NoEntry)?;
+            let checked_proof = proof
+                .check_against_hash(index_hash)
+                .map_err(ProofError::IncorrectEntryProof)?;
+            checked_proofs.insert(name.as_str(), checked_proof);
+        }
+        Ok(checked_proofs)
+    }
+}
+
+impl<K, V, KeyMode> ProtobufConvert for MultiIndexProof<K, V, KeyMode>
+where
+    K: BinaryValue,
+    V: BinaryValue,
+{
+    type ProtoStruct = schema::proofs::MultiIndexProof;
+
+    fn to_pb(&self) -> Self::ProtoStruct {
+        let mut proto_struct = Self::ProtoStruct::new();
+        proto_struct.set_block_proof(self.block_proof.to_pb());
+        proto_struct.set_index_proof(self.index_proof.to_pb());
+        proto_struct.entry_proofs = self
+            .entry_proofs
+            .iter()
+            .map(|(name, proof)| {
+                let mut entry_proof = schema::proofs::IndexEntriesProof::new();
+                entry_proof.set_index_name(name.clone());
+                entry_proof.set_proof(proof.to_pb());
+                entry_proof
+            })
+            .collect::<Vec<_>>()
+            .into();
+        proto_struct
+    }
+
+    fn from_pb(mut proto_struct: Self::ProtoStruct) -> anyhow::Result<Self> {
+        let block_proof = BlockProof::from_pb(proto_struct.take_block_proof())?;
+        let index_proof = MapProof::from_pb(proto_struct.take_index_proof())?;
+
+        let mut entry_proofs = BTreeMap::new();
+        for mut entry_proof in proto_struct.take_entry_proofs() {
+            let proof = MapProof::from_pb(entry_proof.take_proof())?;
+            let name = entry_proof.take_index_name();
+            ensure!(
+                entry_proofs.insert(name, proof).is_none(),
+                "Duplicate index name in `MultiIndexProof`"
+            );
+        }
+        Ok(Self::new(block_proof, index_proof, entry_proofs))
+    }
+}
+
+//TODO: Add generic support to BinaryValue derive macro [ECR-3955].
+impl<K, V, KeyMode> BinaryValue for MultiIndexProof<K, V, KeyMode>
+where
+    K: BinaryValue,
+    V: BinaryValue,
+{
+    fn to_bytes(&self) -> Vec<u8> {
+        self.to_pb()
+            .write_to_bytes()
+            .expect("Error while serializing value")
+    }
+
+    fn from_bytes(bytes: Cow<'_, [u8]>) -> anyhow::Result<Self> {
+        let mut proto_struct = <Self as ProtobufConvert>::ProtoStruct::new();
+        proto_struct.merge_from_bytes(bytes.as_ref())?;
+        ProtobufConvert::from_pb(proto_struct)
+    }
+}
+
 /// Proof of authenticity for a single top-level call in a block, such as a [transaction].
 ///
 /// The proof consists of two parts:
@@ -580,11 +737,14 @@ mod tests {
 
     use super::{
         AdditionalHeaders, BinaryValue, Block, BlockHeaderKey, BlockProof, CallInBlock, CallProof,
-        Epoch, ExecutionError, ExecutionErrorAux, Hash, Height, IndexProof, MapProof, OrderedMap,
-        Precommit, ProofError, ProposerId, ProtobufConvert, ValidationError, ValidatorId, Verified,
+        Epoch, ExecutionError, ExecutionErrorAux, Hash, Height, IndexProof, MapProof,
+        MultiIndexProof, OrderedMap, Precommit, ProofError, ProposerId, ProtobufConvert,
+        ValidationError, ValidatorId, Verified,
     };
     use crate::{blockchain::Schema as CoreSchema, helpers::Round, runtime::InstanceId};
 
+    use std::collections::BTreeMap;
+
     impl BlockHeaderKey for Hash {
         const NAME: &'static str = "HASH";
         type Value = Self;
@@ -990,6 +1150,132 @@ mod tests {
         );
     }
 
+    fn create_multi_index_proof(keys: &[KeyPair]) -> MultiIndexProof<String, u64> {
+        let db = TemporaryDB::new();
+        let fork = db.fork();
+        {
+            let mut first = fork.get_proof_map("test.first");
+            let mut second = fork.get_proof_map("test.second");
+            for i in 0_u64..10 {
+                first.put(&i.to_string(), i);
+                second.put(&i.to_string(), i * 2);
+            }
+        }
+        let patch = fork.into_patch();
+
+        let index_names = vec!["test.first", "test.second", "test.missing"];
+        let system_schema = SystemSchema::new(&patch);
+        let state_hash = system_schema.state_hash();
+        let index_proof = system_schema
+            .state_aggregator()
+            .get_multiproof(index_names.into_iter().map(str::to_owned));
+
+        let requested_keys = || vec!["1".to_owned(), "5".to_owned(), "100".to_owned()];
+        let mut entry_proofs = BTreeMap::new();
+        for &index_name in &["test.first", "test.second"] {
+            let index = patch.get_proof_map::<_, String, u64>(index_name);
+            entry_proofs.insert(
+                index_name.to_owned(),
+                index.get_multiproof(requested_keys()),
+            );
+        }
+
+        let block_proof = create_block_proof(keys, state_hash, Hash::zero());
+        MultiIndexProof::new(block_proof, index_proof, entry_proofs)
+    }
+
+    #[test]
+    fn correct_multi_index_proof() {
+        let keys: Vec<_> = (0..4).map(|_| KeyPair::random()).collect();
+        let public_keys: Vec<_> = keys.iter().map(KeyPair::public_key).collect();
+        let proof = create_multi_index_proof(&keys);
+        let checked_proofs = proof.verify(&public_keys).unwrap();
+        assert_eq!(
+            checked_proofs.keys().collect::<Vec<_>>(),
+            vec![&"test.first", &"test.second"]
+        );
+
+        let entries = |index_name: &str| {
+            let mut entries: Vec<_> = checked_proofs[index_name]
+                .all_entries()
+                .map(|(key, value)| (key.as_str(), value.copied()))
+                .collect();
+            entries.sort();
+            entries
+        };
+        assert_eq!(
+            entries("test.first"),
+            vec![("1", Some(1)), ("100", None), ("5", Some(5))]
+        );
+        assert_eq!(
+            entries("test.second"),
+            vec![("1", Some(2)), ("100", None), ("5", Some(10))]
+        );
+    }
+
+    #[test]
+    fn multi_index_proof_binary_roundtrip() {
+        let keys: Vec<_> = (0..4).map(|_| KeyPair::random()).collect();
+        let public_keys: Vec<_> = keys.iter().map(KeyPair::public_key).collect();
+        let proof = create_multi_index_proof(&keys);
+
+        let bytes = proof.to_bytes();
+        let json = serde_json::to_string(&proof).unwrap();
+        assert!(bytes.len() < json.len());
+
+        let restored = MultiIndexProof::<String, u64>::from_bytes(bytes.into()).unwrap();
+        assert_eq!(restored.block_proof, proof.block_proof);
+        assert_eq!(restored.index_proof, proof.index_proof);
+        assert_eq!(restored.entry_proofs, proof.entry_proofs);
+        restored.verify(&public_keys).unwrap();
+
+        let mut pb = proof.to_pb();
+        let duplicate_entry = pb.entry_proofs[0].clone();
+        pb.entry_proofs.push(duplicate_entry);
+        let err = MultiIndexProof::<String, u64>::from_pb(pb).unwrap_err();
+        assert!(err.to_string().contains("Duplicate index name"));
+    }
+
+    #[test]
+    fn multi_index_proof_with_missing_index() {
+        let keys: Vec<_> = (0..4).map(|_| KeyPair::random()).collect();
+        let public_keys: Vec<_> = keys.iter().map(KeyPair::public_key).collect();
+        let mut proof = create_multi_index_proof(&keys);
+        let entry_proof = proof.entry_proofs["test.first"].clone();
+        proof
+            .entry_proofs
+            .insert("test.missing".to_owned(), entry_proof);
+
+        assert_matches!(proof.verify(&public_keys).unwrap_err(), ProofError::NoEntry);
+    }
+
+    #[test]
+    fn multi_index_proof_with_swapped_entry_proofs() {
+        let keys: Vec<_> = (0..4).map(|_| KeyPair::random()).collect();
+        let public_keys: Vec<_> = keys.iter().map(KeyPair::public_key).collect();
+        let mut proof = create_multi_index_proof(&keys);
+        let first = proof.entry_proofs.remove("test.first").unwrap();
+        let second = proof.entry_proofs.remove("test.second").unwrap();
+        proof.entry_proofs.insert("test.first".to_owned(), second);
+        proof.entry_proofs.insert("test.second".to_owned(), first);
+
+        assert_matches!(
+            proof.verify(&public_keys).unwrap_err(),
+            ProofError::IncorrectEntryProof(ValidationError::UnmatchedRootHash)
+        );
+    }
+
+    #[test]
+    fn multi_index_proof_with_incorrect_auth() {
+        let keys: Vec<_> = (0..4).map(|_| KeyPair::random()).collect();
+        let proof = create_multi_index_proof(&keys);
+        let other_keys: Vec<_> = (0..4).map(|_| KeyPair::random().public_key()).collect();
+        assert_matches!(
+            proof.verify(&other_keys).unwrap_err(),
+            ProofError::ValidatorKeyMismatch
+        );
+    }
+
     #[derive(Clone, Copy)]
     enum CallProofKind {
         Ok,
@@ -18,13 +18,13 @@ pub use self::{
     api_sender::{ApiSender, SendError},
     block::{
         AdditionalHeaders, Block, BlockHeaderKey, BlockProof, CallProof, Epoch, IndexProof,
-        ProofError, ProposerId, SkipFlag,
+        MultiIndexProof, ProofError, ProposerId, SkipFlag,
     },
     builder::BlockchainBuilder,
     config::{ConsensusConfig, ConsensusConfigBuilder, ValidatorKeys},
     schema::{CallErrorsIter, CallInBlock, CallRecords, Schema, TxLocation},
 };
-pub use crate::runtime::TxCheckCache;
+pub use crate::runtime::{ExecutionCosts, TxCheckCache};
 
 pub mod config;
 
@@ -37,13 +37,19 @@ use exonum_merkledb::{
     Snapshot, SystemSchema, TemporaryDB,
 };
 
-use std::{borrow::Cow, collections::BTreeMap, iter, sync::Arc};
+use std::{
+    borrow::Cow,
+    collections::BTreeMap,
+    fmt, iter,
+    sync::{Arc, RwLock},
+    time::Duration,
+};
 
 use crate::{
     blockchain::config::GenesisConfig,
     helpers::{Height, ValidateInput, ValidatorId},
     messages::{AnyTx, Precommit, Verified},
-    runtime::Dispatcher,
+    runtime::{CallInfo, Dispatcher},
 };
 
 mod api_sender;
@@ -167,6 +173,45 @@ where
     }
 }
 
+/// Snapshot of the latest database state shared among `Blockchain` instances.
+///
+/// The snapshot is created lazily and is reset each time changes are merged
+/// via `BlockchainMut`.
+#[derive(Default)]
+struct SharedSnapshot {
+    inner: RwLock<Option<Arc<dyn Snapshot>>>,
+}
+
+impl fmt::Debug for SharedSnapshot {
+    fn fmt(&self, formatter: &mut fmt::Formatter<'_>) -> fmt::Result {
+        formatter.debug_struct("SharedSnapshot").finish()
+    }
+}
+
+impl SharedSnapshot {
+    fn get(&self, db: &dyn Database) -> Arc<dyn Snapshot> {
+        if let Some(snapshot) = &*self.inner.read().expect("Shared snapshot lock is poisoned") {
+            return Arc::clone(snapshot);
+        }
+
+        // The snapshot is created under the write lock; since `reset()` is called
+        // after merging changes, a snapshot preceding the merge cannot outlive the reset.
+        let mut inner = self
+            .inner
+            .write()
+            .expect("Shared snapshot lock is poisoned");
+        let snapshot = inner.get_or_insert_with(|| db.snapshot().into());
+        Arc::clone(snapshot)
+    }
+
+    fn reset(&self) {
+        *self
+            .inner
+            .write()
+            .expect("Shared snapshot lock is poisoned") = None;
+    }
+}
+
 /// Shared Exonum blockchain instance.
 ///
 /// This is essentially a smart pointer to shared blockchain resources (storage,
@@ -179,6 +224,7 @@ pub struct Blockchain {
     api_sender: ApiSender,
     db: Arc<dyn Database>,
     service_keypair: KeyPair,
+    shared_snapshot: Arc<SharedSnapshot>,
 }
 
 impl Blockchain {
@@ -192,6 +238,7 @@ impl Blockchain {
             db: database.into(),
             service_keypair: service_keypair.into(),
             api_sender,
+            shared_snapshot: Arc::default(),
         }
     }
 
@@ -213,6 +260,20 @@ impl Blockchain {
         self.db.snapshot()
     }
 
+    /// Returns a read-only snapshot of the latest storage state shared among all clones
+    /// of this blockchain.
+    ///
+    /// Unlike [`snapshot()`](#method.snapshot), this method does not create a new database
+    /// snapshot on each call; the same snapshot is returned until changes are merged into
+    /// the storage via [`BlockchainMut`]. Thus, the method is suited for read-heavy code,
+    /// such as HTTP API handlers. Changes written to the database directly (bypassing
+    /// `BlockchainMut`) may not be reflected in the returned snapshot.
+    ///
+    /// [`BlockchainMut`]: struct.BlockchainMut.html
+    pub fn shared_snapshot(&self) -> Arc<dyn Snapshot> {
+        self.shared_snapshot.get(self.db.as_ref())
+    }
+
     /// Returns the hash of the latest committed block.
     /// If genesis block was not committed returns `Hash::zero()`.
     pub fn last_hash(&self) -> Hash {
@@ -471,6 +532,12 @@ impl BlockchainMut {
         self.inner.snapshot()
     }
 
+    /// Returns estimates of the transaction execution time based on the transactions
+    /// executed by this instance.
+    pub fn execution_costs(&self) -> ExecutionCosts {
+        self.dispatcher.execution_costs()
+    }
+
     /// Creates a snapshot of the current storage state that can be later committed into the storage
     /// via the `merge` method.
     pub fn fork(&self) -> Fork {
@@ -479,7 +546,48 @@ impl BlockchainMut {
 
     /// Commits changes from the `patch` to the blockchain storage.
     pub fn merge(&mut self, patch: Patch) -> StorageResult<()> {
-        self.inner.db.merge(patch)
+        let res = self.inner.db.merge(patch);
+        self.inner.shared_snapshot.reset();
+        res
+    }
+
+    /// Prunes historical data, so that transactions and precommits are stored only for
+    /// the latest `retained_blocks` blocks (at least one block is always retained).
+    /// Returns the height of the earliest block with the retained data; see
+    /// [`Schema::first_retained_height()`] for details what data is pruned.
+    ///
+    /// To bound the time spent on a single call, no more than 64 blocks are pruned at once.
+    /// The call should be repeated (e.g., after each block commit) to catch up with history
+    /// if pruning is enabled on an existing node.
+    ///
+    /// Pruning only affects non-aggregated indexes, hence it does not influence the blockchain
+    /// state hash and can be configured differently on different nodes. However, a node
+    /// cannot provide pruned data to its peers or to the clients.
+    ///
+    /// [`Schema::first_retained_height()`]: struct.Schema.html#method.first_retained_height
+    pub fn prune_history(&mut self, retained_blocks: u64) -> StorageResult<Height> {
+        const MAX_PRUNED_BLOCKS: u64 = 64;
+
+        let fork = self.fork();
+        let mut schema = Schema::new(&fork);
+        let first_retained_height = schema.first_retained_height();
+        let next_height = schema.next_height();
+        let target_height = next_height.0.saturating_sub(retained_blocks.max(1));
+        let target_height = target_height.min(first_retained_height.0 + MAX_PRUNED_BLOCKS);
+        if target_height <= first_retained_height.0 {
+            return Ok(first_retained_height);
+        }
+
+        let target_height = Height(target_height);
+        schema.prune_blocks(target_height);
+        self.merge(fork.into_patch())?;
+        Ok(target_height)
+    }
+
+    /// Resets the shared snapshot after the storage was modified bypassing this instance.
+    #[doc(hidden)] // used by testkit, should not be used anywhere else
+    pub fn reset_shared_snapshot(&self) {
+        self.inner.shared_snapshot.reset();
     }
 
     /// Creates and commits the genesis block with the given genesis configuration.
@@ -527,7 +635,7 @@ impl BlockchainMut {
         // We need to activate services before calling `create_patch()`; unlike all other blocks,
         // initial services are considered immediately active in the genesis block, i.e.,
         // their state should be included into `patch` created below.
-        let errors = self.dispatcher.after_transactions(&mut fork);
+        let errors = self.dispatcher.after_transactions(&mut fork, vec![]);
 
         // If there was at least one error during the genesis block creation, the block shouldn't be
         // created at all.
@@ -630,14 +738,31 @@ impl BlockchainMut {
             }
         }
 
+        // Retrieve all transactions before executing them. Transaction execution cannot
+        // modify the transaction pool or the `transactions` index, so this is equivalent
+        // to looking up each transaction right before its execution, but it avoids
+        // instantiating pool indexes and flushing the fork for every transaction.
+        let transactions = Self::get_transactions(&fork, tx_hashes, tx_cache);
+        fork.flush();
+
         // Save & execute transactions.
-        for (index, hash) in (0..).zip(tx_hashes) {
-            self.execute_transaction(*hash, height, index, &mut fork, tx_cache);
+        let mut execution_times = Vec::with_capacity(tx_hashes.len());
+        for ((index, hash), transaction) in (0..).zip(tx_hashes).zip(transactions) {
+            self.execute_transaction(
+                *hash,
+                transaction,
+                height,
+                index,
+                &mut fork,
+                &mut execution_times,
+            );
         }
 
         // During processing of the genesis block, this hook is already called in another method.
         if height > Height(0) {
-            let errors = self.dispatcher.after_transactions(&mut fork);
+            let errors = self
+                .dispatcher
+                .after_transactions(&mut fork, execution_times);
             let mut schema = Schema::new(&fork);
             for (location, error) in errors {
                 schema.save_error(height, location, error);
@@ -695,22 +820,35 @@ impl BlockchainMut {
         (patch, block)
     }
 
-    fn execute_transaction<C>(
+    fn get_transactions<C>(fork: &Fork, tx_hashes: &[Hash], tx_cache: &C) -> Vec<Verified<AnyTx>>
+    where
+        C: TransactionCache + ?Sized,
+    {
+        let pool = PersistentPool::new(fork.readonly(), tx_cache);
+        tx_hashes
+            .iter()
+            .map(|&tx_hash| {
+                pool.get_transaction(tx_hash).unwrap_or_else(|| {
+                    panic!("BUG: Cannot find transaction {:?} in database", tx_hash)
+                })
+            })
+            .collect()
+    }
+
+    fn execute_transaction(
         &self,
         tx_hash: Hash,
+        transaction: Verified<AnyTx>,
         height: Height,
         index: u32,
         fork: &mut Fork,
-        tx_cache: &C,
-    ) where
-        C: TransactionCache + ?Sized,
-    {
-        let transaction = PersistentPool::new(&*fork, tx_cache)
-            .get_transaction(tx_hash)
-            .unwrap_or_else(|| panic!("BUG: Cannot find transaction {:?} in database", tx_hash));
-        fork.flush();
-
-        let tx_result = self.dispatcher.execute(fork, tx_hash, index, &transaction);
+        execution_times: &mut Vec<(CallInfo, Duration)>,
+    ) {
+        // `Dispatcher::execute` either flushes transaction changes or rolls them back,
+        // so the fork does not need to be flushed beforehand.
+        let tx_result =
+            self.dispatcher
+                .execute(fork, tx_hash, index, &transaction, execution_times);
         let mut schema = Schema::new(&*fork);
 
         if let Err(e) = tx_result {
@@ -742,13 +880,12 @@ impl BlockchainMut {
                 self.merge(fork.into_patch())?;
             }
             BlockKind::Normal => {
+                // Transaction counters are updated within the block patch, so all changes
+                // related to the block are merged into the database atomically.
+                let latest_state = self.snapshot();
+                Schema::new(&fork).update_transaction_count(latest_state.as_ref());
                 let patch = self.dispatcher.commit_block_and_notify_runtimes(fork);
                 self.merge(patch)?;
-
-                // TODO: this makes `commit` non-atomic; can this be avoided? (ECR-4319)
-                let new_fork = self.fork();
-                Schema::new(&new_fork).update_transaction_count();
-                self.merge(new_fork.into_patch())?;
             }
         }
         Ok(())
@@ -779,11 +916,15 @@ impl BlockchainMut {
     ) {
         let fork = db.fork();
         let mut schema = Schema::new(&fork);
-        for transaction in transactions {
-            if !schema.transactions().contains(&transaction.object_hash()) {
-                schema.add_transaction_into_pool(transaction);
-            }
-        }
+        let new_transactions: BTreeMap<_, _> = {
+            let known_transactions = schema.transactions();
+            transactions
+                .into_iter()
+                .map(|transaction| (transaction.object_hash(), transaction))
+                .filter(|(tx_hash, _)| !known_transactions.contains(tx_hash))
+                .collect()
+        };
+        schema.add_transactions_into_pool(new_transactions.into_iter().map(|(_, tx)| tx));
         db.merge(fork.into_patch())
             .expect("Cannot update transaction pool");
     }
@@ -19,10 +19,11 @@ use exonum_merkledb::{
     impl_binary_key_for_binary_value,
     indexes::{Entries, Values},
     Entry, KeySetIndex, ListIndex, MapIndex, ObjectHash, ProofEntry, ProofListIndex, ProofMapIndex,
+    Snapshot,
 };
 use exonum_proto::ProtobufConvert;
 
-use std::fmt;
+use std::{fmt, iter};
 
 use crate::{
     blockchain::{Block, BlockProof, CallProof, ConsensusConfig},
@@ -58,6 +59,7 @@ define_names!(
     BLOCK_SKIP => "block_skip";
     PRECOMMITS => "precommits";
     CONSENSUS_CONFIG => "consensus_config";
+    FIRST_RETAINED_HEIGHT => "first_retained_height";
 );
 
 /// Transaction location in a block. Defines the block where the transaction was
@@ -240,6 +242,22 @@ impl<T: Access> Schema<T> {
         self.access.get_list((PRECOMMITS, hash))
     }
 
+    fn first_retained_height_entry(&self) -> Entry<T::Base, Height> {
+        self.access.get_entry(FIRST_RETAINED_HEIGHT)
+    }
+
+    /// Returns the height of the earliest block for which the node stores transactions
+    /// and precommits. Data of the earlier blocks was pruned by the node; `Height(0)` means
+    /// that the node stores the complete history of the blockchain.
+    ///
+    /// Block headers, lists of transaction hashes in blocks, transaction locations and
+    /// call errors are never pruned.
+    pub fn first_retained_height(&self) -> Height {
+        self.first_retained_height_entry()
+            .get()
+            .unwrap_or(Height(0))
+    }
+
     /// Returns an actual consensus configuration entry.
     #[doc(hidden)]
     pub fn consensus_config_entry(&self) -> ProofEntry<T::Base, ConsensusConfig> {
@@ -324,10 +342,32 @@ where
     /// be sure to decrement it when the transaction committed.
     #[doc(hidden)] // considered an implementation detail
     pub fn add_transaction_into_pool(&mut self, tx: Verified<AnyTx>) {
-        self.transactions_pool().insert(&tx.object_hash());
-        let x = self.transactions_pool_len_index().get().unwrap_or(0);
-        self.transactions_pool_len_index().set(x + 1);
-        self.transactions().put(&tx.object_hash(), tx);
+        self.add_transactions_into_pool(iter::once(tx));
+    }
+
+    /// Adds several transactions into the persistent pool. The caller must ensure that
+    /// the transactions are not already in the pool and do not repeat.
+    ///
+    /// Unlike calling `add_transaction_into_pool` for each transaction, this method
+    /// instantiates pool indexes and updates the number of transactions in the pool only once.
+    #[doc(hidden)] // considered an implementation detail
+    pub fn add_transactions_into_pool<I>(&mut self, transactions: I)
+    where
+        I: IntoIterator<Item = Verified<AnyTx>>,
+    {
+        let mut pool = self.transactions_pool();
+        let mut transactions_map = self.transactions();
+        let mut added_count = 0;
+        for tx in transactions {
+            let tx_hash = tx.object_hash();
+            pool.insert(&tx_hash);
+            transactions_map.put(&tx_hash, tx);
+            added_count += 1;
+        }
+
+        let mut pool_len_index = self.transactions_pool_len_index();
+        let pool_len = pool_len_index.get().unwrap_or(0);
+        pool_len_index.set(pool_len + added_count);
     }
 
     /// Removes transaction from the persistent transaction pool. The caller must ensure
@@ -370,23 +410,30 @@ where
         self.block_transactions(height).push(*hash);
     }
 
-    /// Updates transaction count of the blockchain.
-    pub(crate) fn update_transaction_count(&mut self) {
+    /// Updates transaction count of the blockchain and removes committed transactions
+    /// from the pool.
+    ///
+    /// Transactions may be added to the pool after the block patch was created, so
+    /// the pool-related indexes are read from `latest_state` (the current database state)
+    /// rather than from the base snapshot of the patch. The indexes are not aggregated,
+    /// hence writing them into the block patch keeps the block commit atomic.
+    pub(crate) fn update_transaction_count(&mut self, latest_state: &dyn Snapshot) {
+        let latest_schema = Schema::new(latest_state);
         let block_transactions = self.block_transactions(self.height());
         let count = block_transactions.len();
 
-        let mut len_index = self.transactions_len_index();
-        let new_len = len_index.get().unwrap_or(0) + count;
-        len_index.set(new_len);
+        let new_len = latest_schema.transactions_len() + count;
+        self.transactions_len_index().set(new_len);
 
         // Determine the number of committed transactions present in the pool (besides the pool,
         // transactions can be taken from the non-persistent cache). Remove the committed transactions
         // from the pool.
+        let latest_pool = latest_schema.transactions_pool();
         let mut pool = self.transactions_pool();
         let pool_count = block_transactions
             .iter()
             .filter(|tx_hash| {
-                if pool.contains(tx_hash) {
+                if latest_pool.contains(tx_hash) {
                     pool.remove(tx_hash);
                     true
                 } else {
@@ -395,9 +442,8 @@ where
             })
             .count();
 
-        let mut pool_len_index = self.transactions_pool_len_index();
-        let new_pool_len = pool_len_index.get().unwrap_or(0) - pool_count as u64;
-        pool_len_index.set(new_pool_len);
+        let new_pool_len = latest_schema.transactions_pool_len() - pool_count as u64;
+        self.transactions_pool_len_index().set(new_pool_len);
     }
 
     /// Saves an error to the blockchain.
@@ -412,6 +458,28 @@ where
         self.call_errors_aux(height).put(&call, aux);
     }
 
+    /// Removes transactions and precommits of blocks with heights lesser than `height`,
+    /// starting from the current `first_retained_height`. Hashes of the transactions
+    /// and their locations are retained, so that the transactions cannot be committed again.
+    pub(super) fn prune_blocks(&mut self, height: Height) {
+        let first_retained_height = self.first_retained_height();
+        if height <= first_retained_height {
+            return;
+        }
+
+        let mut transactions = self.transactions();
+        for pruned_height in first_retained_height.0..height.0 {
+            let pruned_height = Height(pruned_height);
+            for tx_hash in self.block_transactions(pruned_height).iter() {
+                transactions.remove(&tx_hash);
+            }
+            if let Some(block_hash) = self.block_hash_by_height(pruned_height) {
+                self.precommits(&block_hash).clear();
+            }
+        }
+        self.first_retained_height_entry().set(height);
+    }
+
     pub(super) fn clear_block_skip(&mut self) {
         if let Some(block_skip) = self.block_skip_entry().take() {
             let block_hash = block_skip.object_hash();
@@ -26,6 +26,7 @@ use std::{
     cell::RefCell,
     collections::{BTreeMap, VecDeque},
     panic,
+    sync::Arc,
 };
 
 use crate::{
@@ -456,6 +457,74 @@ fn handling_tx_panic_error() {
     assert_eq!(InspectorSchema::new(&snapshot).values.get(0), Some(10));
 }
 
+#[test]
+fn execution_costs_are_recorded() {
+    let keys = KeyPair::random();
+    let mut blockchain = create_blockchain(
+        RuntimeInspector::default(),
+        vec![InitAction::Noop.into_default_instance()],
+    );
+    assert_eq!(blockchain.execution_costs().average_cost(), None);
+
+    let tx = Transaction::AddValue(1).sign(TEST_SERVICE_ID, &keys);
+    let call_info = tx.payload().call_info.clone();
+    execute_transaction(&mut blockchain, tx).unwrap();
+
+    let costs = blockchain.execution_costs();
+    assert!(costs.method_cost(&call_info).is_some());
+    assert!(costs.average_cost().is_some());
+    // Methods without executions are estimated with the average cost.
+    let other_call_info = CallInfo::new(TEST_SERVICE_ID, 100);
+    assert_eq!(costs.method_cost(&other_call_info), None);
+    assert_eq!(
+        costs.estimate(&other_call_info),
+        costs.average_cost().unwrap()
+    );
+}
+
+#[test]
+fn pruning_history() {
+    let keys = KeyPair::random();
+    let mut blockchain = create_blockchain(
+        RuntimeInspector::default(),
+        vec![InitAction::Noop.into_default_instance()],
+    );
+
+    let tx_hashes: Vec<_> = (1..=3)
+        .map(|i| {
+            let tx = Transaction::AddValue(i).sign(TEST_SERVICE_ID, &keys);
+            let tx_hash = tx.object_hash();
+            execute_transaction(&mut blockchain, tx).unwrap();
+            tx_hash
+        })
+        .collect();
+    let last_block = blockchain.as_ref().last_block();
+
+    // Genesis block and blocks with the first two transactions are pruned.
+    let first_retained_height = blockchain.prune_history(1).unwrap();
+    assert_eq!(first_retained_height, Height(3));
+    // Repeated pruning is a no-op.
+    assert_eq!(blockchain.prune_history(1).unwrap(), Height(3));
+    // A greater number of retained blocks does not restore the pruned data.
+    assert_eq!(blockchain.prune_history(10).unwrap(), Height(3));
+
+    let snapshot = blockchain.snapshot();
+    let schema = Schema::new(&snapshot);
+    assert_eq!(schema.first_retained_height(), Height(3));
+    assert_eq!(schema.last_block(), last_block);
+    for (i, tx_hash) in tx_hashes.iter().enumerate() {
+        let location = schema.transactions_locations().get(tx_hash).unwrap();
+        assert_eq!(location.block_height(), Height(i as u64 + 1));
+        assert!(schema.transaction_result(location).is_some());
+        let is_retained = location.block_height() >= first_retained_height;
+        assert_eq!(schema.transactions().contains(tx_hash), is_retained);
+        assert_eq!(
+            schema.block_transactions(location.block_height()).get(0),
+            Some(*tx_hash)
+        );
+    }
+}
+
 #[test]
 #[should_panic]
 fn handling_tx_merkledb_error() {
@@ -644,6 +713,27 @@ fn test_check_tx() {
     );
 }
 
+/// Checks that the shared snapshot is reused by blockchain clones until changes are merged.
+#[test]
+fn shared_snapshot_is_reset_on_merge() {
+    let mut blockchain = create_blockchain(RuntimeInspector::default(), vec![]);
+    let immutable_view = blockchain.immutable_view();
+
+    let snapshot = immutable_view.shared_snapshot();
+    let other_snapshot = blockchain.as_ref().shared_snapshot();
+    assert!(Arc::ptr_eq(&snapshot, &other_snapshot));
+    assert_eq!(Schema::new(snapshot.as_ref()).height(), Height(0));
+
+    let patch = blockchain.create_patch(BlockParams::new(ValidatorId(0), Height(1), &[]), &());
+    blockchain.commit(patch, vec![]).unwrap();
+
+    let new_snapshot = immutable_view.shared_snapshot();
+    assert!(!Arc::ptr_eq(&snapshot, &new_snapshot));
+    assert_eq!(Schema::new(new_snapshot.as_ref()).height(), Height(1));
+    // The old snapshot is still usable.
+    assert_eq!(Schema::new(snapshot.as_ref()).height(), Height(0));
+}
+
 #[test]
 #[should_panic(expected = "Service with name `sample_instance` already exists")]
 fn finalize_duplicate_services() {
@@ -823,6 +913,61 @@ fn no_data_race_for_transaction_pool() {
     assert_eq!(schema.transactions_pool_len(), 0);
 }
 
+#[test]
+fn transactions_added_to_pool_during_commit_are_retained() {
+    let keys = KeyPair::random();
+    let mut blockchain = create_blockchain(
+        RuntimeInspector::default(),
+        vec![InitAction::Noop.into_default_instance()],
+    );
+
+    let tx = Transaction::AddValue(10).sign(TEST_SERVICE_ID, &keys);
+    let tx_hash = tx.object_hash();
+    blockchain.add_transactions_into_pool(vec![tx]);
+    let patch =
+        blockchain.create_patch(BlockParams::new(ValidatorId(0), Height(1), &[tx_hash]), &());
+
+    // Add another transaction into the pool after the block patch has been created.
+    let other_tx = Transaction::AddValue(20).sign(TEST_SERVICE_ID, &keys);
+    let other_tx_hash = other_tx.object_hash();
+    blockchain.add_transactions_into_pool(vec![other_tx]);
+
+    blockchain.commit(patch, vec![]).unwrap();
+    let snapshot = blockchain.snapshot();
+    let schema = Schema::new(&snapshot);
+    assert_eq!(schema.transactions_len(), 1);
+    assert_eq!(schema.transactions_pool_len(), 1);
+    assert!(!schema.transactions_pool().contains(&tx_hash));
+    assert!(schema.transactions_pool().contains(&other_tx_hash));
+}
+
+#[test]
+fn adding_transactions_into_pool_in_batch() {
+    let keys = KeyPair::random();
+    let mut blockchain = create_blockchain(
+        RuntimeInspector::default(),
+        vec![InitAction::Noop.into_default_instance()],
+    );
+
+    let transactions: Vec<_> = (0..5)
+        .map(|i| Transaction::AddValue(i).sign(TEST_SERVICE_ID, &keys))
+        .collect();
+    blockchain.add_transactions_into_pool(transactions[..3].to_vec());
+    // Known and repeated transactions should be ignored.
+    let mut more_transactions = transactions[1..].to_vec();
+    more_transactions.push(transactions[4].clone());
+    blockchain.add_transactions_into_pool(more_transactions);
+
+    let snapshot = blockchain.snapshot();
+    let schema = Schema::new(&snapshot);
+    assert_eq!(schema.transactions_pool_len(), 5);
+    for tx in &transactions {
+        let tx_hash = tx.object_hash();
+        assert!(schema.transactions_pool().contains(&tx_hash));
+        assert_eq!(schema.transactions().get(&tx_hash).as_ref(), Some(tx));
+    }
+}
+
 #[test]
 fn executing_block_skip() {
     let mut blockchain = create_blockchain(
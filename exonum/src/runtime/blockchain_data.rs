@@ -13,16 +13,19 @@
 // limitations under the License.
 
 use exonum_merkledb::{
-    access::{AsReadonly, FromAccess, Prefixed, RawAccess},
+    access::{AccessError, AsReadonly, FromAccess, Prefixed, RawAccess},
     generic::GenericRawAccess,
-    Snapshot, SystemSchema,
+    proof_map::ToProofPath,
+    BinaryKey, BinaryValue, IndexAddress, ProofMapIndex, Snapshot, SystemSchema,
 };
 
+use std::collections::BTreeMap;
+
 use super::{
     versioning::{ArtifactReqError, RequireArtifact},
     DispatcherSchema, InstanceQuery, InstanceSpec, InstanceState,
 };
-use crate::blockchain::{IndexProof, Schema as CoreSchema};
+use crate::blockchain::{IndexProof, MultiIndexProof, Schema as CoreSchema};
 
 /// Provides access to blockchain data for the executing service.
 #[derive(Debug, Clone)]
@@ -128,6 +131,31 @@ impl BlockchainData<&dyn Snapshot> {
         let full_index_name = [&self.instance_name, ".", index_name].concat();
         self.access.proof_for_index(&full_index_name)
     }
+
+    /// Returns a combined proof for entries of several `ProofMapIndex`es with the specified
+    /// names in the currently executing service. See [`SnapshotExt::proof_for_index_entries`]
+    /// for details.
+    ///
+    /// [`SnapshotExt::proof_for_index_entries`]: trait.SnapshotExt.html#tymethod.proof_for_index_entries
+    pub fn proof_for_service_index_entries<'a, K, V, KeyMode, I>(
+        &self,
+        entries: I,
+    ) -> Result<MultiIndexProof<K, V, KeyMode>, AccessError>
+    where
+        K: BinaryKey + Clone,
+        V: BinaryValue,
+        KeyMode: ToProofPath<K>,
+        I: IntoIterator<Item = (&'a str, Vec<K>)>,
+    {
+        let instance_name = self.instance_name.as_str();
+        let (full_index_names, keys): (Vec<_>, Vec<_>) = entries
+            .into_iter()
+            .map(|(name, keys)| ([instance_name, ".", name].concat(), keys))
+            .unzip();
+        let full_index_names = full_index_names.iter().map(String::as_str);
+        self.access
+            .proof_for_index_entries(full_index_names.zip(keys))
+    }
 }
 
 #[allow(clippy::use_self)] // false positive
@@ -198,6 +226,31 @@ pub trait SnapshotExt {
     #[doc(hidden)]
     fn proof_for_index(&self, index_name: &str) -> Option<IndexProof>;
 
+    /// Returns a combined proof for entries of several `ProofMapIndex`es with the specified
+    /// full names. The proof is rooted in the state hash of the latest committed block.
+    ///
+    /// Keys for the same index may be split among several items of `entries`. Compared to
+    /// separate proofs for each index and key, the combined proof includes the block header
+    /// and nodes shared by several keys only once.
+    ///
+    /// # Return value
+    ///
+    /// Indexes which do not exist or are not Merkelized are proven to be absent
+    /// from the state aggregator. For such indexes, entry proofs are not created.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if one of indexes is not a `ProofMapIndex`.
+    fn proof_for_index_entries<'a, K, V, KeyMode, I>(
+        &self,
+        entries: I,
+    ) -> Result<MultiIndexProof<K, V, KeyMode>, AccessError>
+    where
+        K: BinaryKey + Clone,
+        V: BinaryValue,
+        KeyMode: ToProofPath<K>,
+        I: IntoIterator<Item = (&'a str, Vec<K>)>;
+
     /// Retrieves schema for a service.
     ///
     /// # Errors
@@ -239,6 +292,41 @@ impl SnapshotExt for dyn Snapshot {
         Some(IndexProof::new(block_proof, index_proof))
     }
 
+    fn proof_for_index_entries<'a, K, V, KeyMode, I>(
+        &self,
+        entries: I,
+    ) -> Result<MultiIndexProof<K, V, KeyMode>, AccessError>
+    where
+        K: BinaryKey + Clone,
+        V: BinaryValue,
+        KeyMode: ToProofPath<K>,
+        I: IntoIterator<Item = (&'a str, Vec<K>)>,
+    {
+        let mut keys_by_index = BTreeMap::<_, Vec<K>>::new();
+        for (index_name, keys) in entries {
+            keys_by_index.entry(index_name).or_default().extend(keys);
+        }
+
+        let core_schema = self.for_core();
+        let height = core_schema.height();
+        let block_proof = core_schema.block_and_precommits(height).unwrap();
+
+        let aggregator = SystemSchema::new(self).state_aggregator();
+        let index_names = keys_by_index.keys().map(|&name| name.to_owned());
+        let index_proof = aggregator.get_multiproof(index_names);
+
+        let mut entry_proofs = BTreeMap::new();
+        for (index_name, keys) in keys_by_index {
+            if aggregator.get(index_name).is_none() || keys.is_empty() {
+                continue;
+            }
+            let addr = IndexAddress::from_root(index_name);
+            let index = ProofMapIndex::<_, K, V, KeyMode>::from_access(self, addr)?;
+            entry_proofs.insert(index_name.to_owned(), index.get_multiproof(keys));
+        }
+        Ok(MultiIndexProof::new(block_proof, index_proof, entry_proofs))
+    }
+
     fn service_schema<'s, 'q, S, I>(&'s self, service_id: I) -> Result<S, ArtifactReqError>
     where
         S: RequireArtifact + FromAccess<Prefixed<&'s dyn Snapshot>>,
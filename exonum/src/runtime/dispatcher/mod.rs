@@ -26,8 +26,9 @@ use semver::Version;
 use std::{
     collections::{BTreeMap, HashMap},
     fmt, panic,
-    sync::{mpsc, Arc},
+    sync::{mpsc, Arc, Mutex},
     thread,
+    time::{Duration, Instant},
 };
 
 use crate::{
@@ -42,9 +43,9 @@ use crate::{
             InstanceMigration, MigrationContext, MigrationError, MigrationScript, MigrationStatus,
             MigrationType,
         },
-        ArtifactId, ArtifactStatus, CoreError, InstanceDescriptor, InstanceId, InstanceQuery,
-        InstanceSpec, InstanceState, InstanceStatus, Runtime, RuntimeFeature, RuntimeIdentifier,
-        RuntimeInstance,
+        oneshot, ArtifactId, ArtifactStatus, CallInfo, CoreError, InstanceDescriptor, InstanceId,
+        InstanceQuery, InstanceSpec, InstanceState, InstanceStatus, MethodId, Runtime,
+        RuntimeFeature, RuntimeIdentifier, RuntimeInstance,
     },
 };
 
@@ -273,6 +274,79 @@ impl Migrations {
     }
 }
 
+/// Attributes an error reported by a runtime during artifact deployment to this runtime.
+fn with_runtime_id(
+    status: Result<(), ExecutionError>,
+    runtime_id: u32,
+) -> Result<(), ExecutionError> {
+    status.map_err(|mut err| {
+        err.set_runtime_id(runtime_id);
+        err
+    })
+}
+
+/// Artifact deployments started via `Action::StartDeploy`, which proceed in the background.
+#[derive(Debug, Default)]
+struct Deployments {
+    pending: HashMap<ArtifactId, oneshot::Receiver>,
+}
+
+impl Deployments {
+    /// Passes the deployment status to `then`. If the deployment is not completed yet,
+    /// spawns a thread waiting for the status, which is also reported to the dispatcher.
+    fn add(&mut self, artifact: ArtifactId, status: oneshot::Receiver, then: ThenFn) {
+        if let Some(status) = status.try_wait() {
+            // The runtime has completed the deployment synchronously.
+            Self::report_status(&artifact, status, then);
+            return;
+        }
+
+        let (status_tx, status_rx) = oneshot::channel();
+        let artifact_ = artifact.clone();
+        thread::Builder::new()
+            .name(format!("deploy-{}", artifact))
+            .spawn(move || {
+                let status = status.wait();
+                status_tx.send(status.clone());
+                Self::report_status(&artifact, status, then);
+            })
+            .expect("Cannot spawn thread for artifact deployment");
+
+        self.pending.insert(artifact_, status_rx);
+    }
+
+    fn report_status(artifact: &ArtifactId, status: Result<(), ExecutionError>, then: ThenFn) {
+        then(with_runtime_id(status, artifact.runtime_id)).unwrap_or_else(|e| {
+            log::error!("Deploying artifact {:?} failed: {}", artifact, e);
+        });
+    }
+
+    fn is_pending(&self, artifact: &ArtifactId) -> bool {
+        self.pending.contains_key(artifact)
+    }
+
+    /// Forgets about deployments completed in the background.
+    fn remove_completed(&mut self) {
+        self.pending
+            .retain(|artifact, status| match status.try_wait() {
+                None => true,
+                Some(Ok(())) => {
+                    log::info!("Artifact `{}` was deployed in the background", artifact);
+                    false
+                }
+                Some(Err(err)) => {
+                    log::warn!("Background deployment of `{}` failed: {}", artifact, err);
+                    false
+                }
+            });
+    }
+
+    /// Blocks until the background deployment of the artifact (if any) is completed.
+    fn wait(&mut self, artifact: &ArtifactId) -> Option<Result<(), ExecutionError>> {
+        self.pending.remove(artifact).map(oneshot::Receiver::wait)
+    }
+}
+
 /// Opaque cache used for transaction checking.
 ///
 /// A single cache object is only valid for a single blockchain height, which **MUST** be ensured
@@ -346,12 +420,80 @@ impl TxCheckCache {
     }
 }
 
+/// Estimates of the transaction execution time, aggregated by the called service method.
+///
+/// Estimates are exponential moving averages of the time spent by the dispatcher executing
+/// transactions, so they adapt to changes in the service state or the node load.
+/// The estimates are local to the node and **MUST NOT** influence the blockchain state;
+/// they are intended to be used as hints, e.g., when creating block proposals.
+///
+/// Estimates can be obtained via [`BlockchainMut::execution_costs()`].
+///
+/// [`BlockchainMut::execution_costs()`]: struct.BlockchainMut.html#method.execution_costs
+#[derive(Debug, Clone, Default)]
+pub struct ExecutionCosts {
+    methods: HashMap<(InstanceId, MethodId), Duration>,
+    average: Option<Duration>,
+}
+
+impl ExecutionCosts {
+    /// Weight of the older measurements in the moving average of execution time.
+    const SMOOTHING: u32 = 8;
+
+    fn update_average(average: &mut Duration, sample: Duration) {
+        *average = (*average * (Self::SMOOTHING - 1) + sample) / Self::SMOOTHING;
+    }
+
+    /// Creates empty estimates.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Records the execution time of a transaction calling the specified method.
+    pub fn record(&mut self, call_info: &CallInfo, duration: Duration) {
+        let key = (call_info.instance_id, call_info.method_id);
+        self.methods
+            .entry(key)
+            .and_modify(|average| Self::update_average(average, duration))
+            .or_insert(duration);
+        match self.average {
+            Some(ref mut average) => Self::update_average(average, duration),
+            None => self.average = Some(duration),
+        }
+    }
+
+    /// Returns the estimated execution time of a transaction calling the specified method,
+    /// or `None` if no transactions calling this method were executed by the node.
+    pub fn method_cost(&self, call_info: &CallInfo) -> Option<Duration> {
+        self.methods
+            .get(&(call_info.instance_id, call_info.method_id))
+            .copied()
+    }
+
+    /// Returns the average execution time of a transaction regardless of the called method,
+    /// or `None` if the node has not executed any transactions yet.
+    pub fn average_cost(&self) -> Option<Duration> {
+        self.average
+    }
+
+    /// Returns the estimated execution time of a transaction calling the specified method.
+    /// The average cost of a transaction is used for methods without recorded executions,
+    /// and zero if the node has not executed any transactions yet.
+    pub fn estimate(&self, call_info: &CallInfo) -> Duration {
+        self.method_cost(call_info)
+            .or(self.average)
+            .unwrap_or_default()
+    }
+}
+
 /// A collection of `Runtime`s capable of modifying the blockchain state.
 #[derive(Debug)]
 pub struct Dispatcher {
     runtimes: BTreeMap<u32, Box<dyn Runtime>>,
     service_infos: CommittedServices,
     migrations: Migrations,
+    deployments: Deployments,
+    execution_costs: Mutex<ExecutionCosts>,
 }
 
 impl Dispatcher {
@@ -367,6 +509,8 @@ impl Dispatcher {
                 .collect(),
             service_infos: CommittedServices::default(),
             migrations: Migrations::new(blockchain),
+            deployments: Deployments::default(),
+            execution_costs: Mutex::default(),
         };
         for runtime in this.runtimes.values_mut() {
             runtime.initialize(blockchain);
@@ -382,15 +526,27 @@ impl Dispatcher {
     pub(crate) fn restore_state(&mut self, snapshot: &dyn Snapshot) {
         let schema = Schema::new(snapshot);
 
-        // Restore information about the deployed services.
-        for (artifact, state) in schema.artifacts().iter() {
-            debug_assert_eq!(
-                state.status,
-                ArtifactStatus::Active,
-                "BUG: Artifact should not be in pending state."
-            );
+        // Restore information about the deployed services. All deployments are started
+        // before waiting for any of them, so that runtimes deploying artifacts asynchronously
+        // can restore them in parallel.
+        let deployments: Vec<_> = schema
+            .artifacts()
+            .iter()
+            .map(|(artifact, state)| {
+                debug_assert_eq!(
+                    state.status,
+                    ArtifactStatus::Active,
+                    "BUG: Artifact should not be in pending state."
+                );
+                let status = self.start_artifact_deploy(artifact.clone(), state.deploy_spec);
+                (artifact, status)
+            })
+            .collect();
 
-            self.deploy_artifact(artifact.clone(), state.deploy_spec)
+        for (artifact, status) in deployments {
+            let runtime_id = artifact.runtime_id;
+            status
+                .and_then(|status| with_runtime_id(status.wait(), runtime_id))
                 .unwrap_or_else(|err| {
                     panic!(
                         "BUG: Cannot restore blockchain state; artifact `{}` failed to deploy \
@@ -496,6 +652,18 @@ impl Dispatcher {
         artifact: ArtifactId,
         payload: Vec<u8>,
     ) -> Result<(), ExecutionError> {
+        let runtime_id = artifact.runtime_id;
+        let status = self.start_artifact_deploy(artifact, payload)?;
+        with_runtime_id(status.wait(), runtime_id)
+    }
+
+    /// Requests the runtime to deploy an artifact without waiting for the deployment
+    /// to complete.
+    fn start_artifact_deploy(
+        &mut self,
+        artifact: ArtifactId,
+        payload: Vec<u8>,
+    ) -> Result<oneshot::Receiver, ExecutionError> {
         // TODO: revise dispatcher integrity checks [ECR-3743]
         debug_assert!(artifact.validate().is_ok());
         log::info!(
@@ -505,14 +673,7 @@ impl Dispatcher {
         );
 
         if let Some(runtime) = self.runtimes.get_mut(&artifact.runtime_id) {
-            let runtime_id = artifact.runtime_id;
-            runtime
-                .deploy_artifact(artifact, payload)
-                .wait()
-                .map_err(move |mut err| {
-                    err.set_runtime_id(runtime_id);
-                    err
-                })
+            Ok(runtime.deploy_artifact(artifact, payload))
         } else {
             let msg = format!(
                 "Cannot deploy an artifact `{}` depending on the unknown runtime with ID {}",
@@ -674,6 +835,16 @@ impl Dispatcher {
     }
 
     fn block_until_deployed(&mut self, artifact: ArtifactId, payload: Vec<u8>) {
+        // If the artifact is being deployed in the background, wait for this deployment
+        // first. If it has failed, the deployment is retried below.
+        if self.deployments.is_pending(&artifact) {
+            log::info!(
+                "Blocking until background deployment of `{}` completes",
+                artifact
+            );
+            self.deployments.wait(&artifact);
+        }
+
         if !self.is_artifact_deployed(&artifact) {
             log::info!("Blocking until artifact `{}` is deployed", artifact);
             self.deploy_artifact(artifact, payload).unwrap_or_else(|e| {
@@ -750,13 +921,25 @@ impl Dispatcher {
         }
     }
 
+    /// Returns the current estimates of the transaction execution time.
+    pub(crate) fn execution_costs(&self) -> ExecutionCosts {
+        self.execution_costs
+            .lock()
+            .expect("Execution costs lock is poisoned")
+            .clone()
+    }
+
     /// Executes transaction with the specified ID with fork isolation.
+    ///
+    /// The execution time of the transaction is appended to `execution_times`. The times
+    /// collected for the block are recorded into the cost estimates by `after_transactions()`.
     pub(crate) fn execute(
         &self,
         fork: &mut Fork,
         tx_id: Hash,
         tx_index: u32,
         tx: &Verified<AnyTx>,
+        execution_times: &mut Vec<(CallInfo, Duration)>,
     ) -> Result<(), ExecutionError> {
         let call_info = &tx.as_ref().call_info;
         let (runtime_id, runtime) =
@@ -777,9 +960,11 @@ impl Dispatcher {
             CoreError::IncorrectInstanceId.with_description(msg)
         })?;
 
+        let start = Instant::now();
         let context = TopLevelContext::for_transaction(self, fork, instance, tx.author(), tx_id);
         let mut res =
             context.call(|ctx| runtime.execute(ctx, call_info.method_id, &tx.as_ref().arguments));
+        execution_times.push((call_info.clone(), start.elapsed()));
         if let Err(ref mut err) = res {
             fork.rollback();
 
@@ -844,12 +1029,33 @@ impl Dispatcher {
     /// Changes the status of pending artifacts and services to active in the merkelized
     /// indexes of the dispatcher information scheme. Thus, these statuses will be equally
     /// calculated for precommit and actually committed block.
-    pub(crate) fn after_transactions(&self, fork: &mut Fork) -> Vec<(CallInBlock, ExecutionError)> {
+    ///
+    /// Execution times of the block transactions collected by `execute()` are recorded
+    /// into the cost estimates at once.
+    pub(crate) fn after_transactions(
+        &self,
+        fork: &mut Fork,
+        execution_times: Vec<(CallInfo, Duration)>,
+    ) -> Vec<(CallInBlock, ExecutionError)> {
         let errors = self.call_service_hooks(fork, &CallType::AfterTransactions);
         Self::activate_pending(fork);
+        self.record_execution_times(execution_times);
         errors
     }
 
+    fn record_execution_times(&self, execution_times: Vec<(CallInfo, Duration)>) {
+        if execution_times.is_empty() {
+            return;
+        }
+        let mut costs = self
+            .execution_costs
+            .lock()
+            .expect("Execution costs lock is poisoned");
+        for (call_info, duration) in execution_times {
+            costs.record(&call_info, duration);
+        }
+    }
+
     /// Commits to service instances and artifacts marked as pending in the provided `fork`.
     pub(crate) fn commit_block(&mut self, mut fork: Fork) -> Patch {
         let mut schema = Schema::new(&fork);
@@ -1044,6 +1250,9 @@ impl Dispatcher {
 
     /// Notifies runtimes about a committed block.
     pub(crate) fn notify_runtimes_about_commit(&mut self, snapshot: &dyn Snapshot) {
+        // Forget about completed deployments, so that failed ones can be restarted.
+        self.deployments.remove_completed();
+
         let mut mailbox = Mailbox::default();
         for runtime in self.runtimes.values_mut() {
             runtime.after_commit(snapshot, &mut mailbox);
@@ -1166,6 +1375,10 @@ pub enum Action {
         spec: Vec<u8>,
         /// The actions that will be performed after the deployment is finished.
         /// For example, this closure may create a transaction with the deployment confirmation.
+        ///
+        /// The deployment proceeds in the background, and the closure is called from
+        /// a separate thread once it is completed. If the artifact is already being deployed,
+        /// the closure is dropped without being called.
         then: ThenFn,
     },
 }
@@ -1189,11 +1402,37 @@ impl Action {
                 artifact,
                 spec,
                 then,
-            } => {
-                then(dispatcher.deploy_artifact(artifact.clone(), spec)).unwrap_or_else(|e| {
-                    log::error!("Deploying artifact {:?} failed: {}", artifact, e);
-                });
-            }
+            } => Self::start_deploy(dispatcher, artifact, spec, then),
+        }
+    }
+
+    /// Starts the artifact deployment. The deployment proceeds in the background, so that
+    /// the node continues processing blocks; `then` is called from a background thread
+    /// once the deployment is completed.
+    fn start_deploy(
+        dispatcher: &mut Dispatcher,
+        artifact: ArtifactId,
+        spec: Vec<u8>,
+        then: ThenFn,
+    ) {
+        if dispatcher.deployments.is_pending(&artifact) {
+            // The status will be reported by the ongoing deployment.
+            log::trace!("Artifact `{}` is already being deployed", artifact);
+            return;
+        }
+
+        let status = if dispatcher.is_artifact_deployed(&artifact) {
+            // The runtime must not be asked to deploy the same artifact twice.
+            Ok(oneshot::Receiver::with_result(Ok(())))
+        } else {
+            dispatcher.start_artifact_deploy(artifact.clone(), spec)
+        };
+
+        match status {
+            Ok(status) => dispatcher.deployments.add(artifact, status, then),
+            Err(err) => then(Err(err)).unwrap_or_else(|e| {
+                log::error!("Deploying artifact {:?} failed: {}", artifact, e);
+            }),
         }
     }
 }
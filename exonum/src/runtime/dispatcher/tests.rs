@@ -25,7 +25,7 @@ use std::{
         mpsc, Arc, Mutex,
     },
     thread,
-    time::Duration,
+    time::{Duration, Instant},
 };
 
 use crate::{
@@ -33,14 +33,14 @@ use crate::{
     helpers::Height,
     messages::AnyTx,
     runtime::{
-        dispatcher::{Action, ArtifactStatus, Dispatcher, Mailbox},
+        dispatcher::{Action, ArtifactStatus, Dispatcher, Mailbox, ThenFn},
         execution_context::TopLevelContext,
         migrations::{InitMigrationError, MigrationScript},
         oneshot::{self, Receiver},
         ArtifactId, BlockchainData, CallInfo, CommonError, CoreError, DispatcherSchema, ErrorKind,
-        ErrorMatch, ExecutionContext, ExecutionError, InstanceDescriptor, InstanceId, InstanceSpec,
-        InstanceState, InstanceStatus, MethodId, Runtime, RuntimeFeature, RuntimeInstance,
-        SnapshotExt, TxCheckCache,
+        ErrorMatch, ExecutionContext, ExecutionCosts, ExecutionError, InstanceDescriptor,
+        InstanceId, InstanceSpec, InstanceState, InstanceStatus, MethodId, Runtime, RuntimeFeature,
+        RuntimeInstance, SnapshotExt, TxCheckCache,
     },
 };
 
@@ -929,8 +929,8 @@ fn delayed_deployment() {
 
     // Queue an artifact for deployment.
     let (artifact, spec) = runtime.deploy_test_artifact("good", "1.0.0", &mut dispatcher, &db);
-    // Note that deployment via `Mailbox` is currently blocking, so after the method completion
-    // the artifact should be immediately marked as deployed.
+    // Note that the test runtime marks the artifact as deployed immediately, although
+    // the deployment status is reported with a delay.
     assert!(dispatcher.is_artifact_deployed(&artifact));
     assert_eq!(runtime.deploy_attempts(&artifact), 1);
 
@@ -944,6 +944,57 @@ fn delayed_deployment() {
     assert_eq!(runtime.deploy_attempts(&artifact), 1);
 }
 
+#[test]
+fn deployment_does_not_block_commit() {
+    let db = Arc::new(TemporaryDB::new());
+    let blockchain = Blockchain::new(
+        Arc::clone(&db) as Arc<dyn Database>,
+        gen_keypair(),
+        ApiSender::closed(),
+    );
+    let runtime = DeploymentRuntime::default();
+    let mut dispatcher = DispatcherBuilder::new()
+        .with_runtime(2, runtime.clone())
+        .finalize(&blockchain);
+
+    let patch = create_genesis_block(&mut dispatcher, db.fork());
+    db.merge_sync(patch).unwrap();
+
+    let artifact = ArtifactId::from_raw_parts(2, "good".to_owned(), "1.0.0".parse().unwrap());
+    let spec = 1_000_u64.to_bytes();
+    let (status_tx, status_rx) = mpsc::channel();
+    let mut commit_block = |then: ThenFn| {
+        runtime
+            .mailbox_actions
+            .lock()
+            .unwrap()
+            .push(Action::StartDeploy {
+                artifact: artifact.clone(),
+                spec: spec.clone(),
+                then,
+            });
+        let fork = db.fork();
+        Dispatcher::activate_pending(&fork);
+        let patch = dispatcher.commit_block_and_notify_runtimes(fork);
+        db.merge_sync(patch).unwrap();
+    };
+
+    let start = Instant::now();
+    commit_block(Box::new(move |status| {
+        status_tx.send(status).unwrap();
+        Ok(())
+    }));
+    // Repeated requests to deploy the artifact should not reach the runtime.
+    commit_block(Box::new(|_| Ok(())));
+    assert!(start.elapsed() < Duration::from_millis(500));
+    assert!(status_rx.try_recv().is_err());
+
+    // The status is reported once the deployment is completed.
+    let status = status_rx.recv_timeout(Duration::from_secs(5)).unwrap();
+    assert!(status.is_ok());
+    assert_eq!(runtime.deploy_attempts(&artifact), 1);
+}
+
 fn test_failed_deployment(db: &Arc<TemporaryDB>, runtime: &DeploymentRuntime, artifact_name: &str) {
     let blockchain = Blockchain::new(
         Arc::clone(db) as Arc<dyn Database>,
@@ -1355,3 +1406,36 @@ fn check_tx_caching() {
         ErrorMatch::from_fail(&CoreError::IncorrectInstanceId).with_any_description()
     );
 }
+
+#[test]
+fn execution_costs_moving_average() {
+    let mut costs = ExecutionCosts::new();
+    let first_method = CallInfo::new(1, 0);
+    let second_method = CallInfo::new(1, 1);
+    assert_eq!(costs.estimate(&first_method), Duration::default());
+
+    costs.record(&first_method, Duration::from_millis(8));
+    assert_eq!(
+        costs.method_cost(&first_method),
+        Some(Duration::from_millis(8))
+    );
+    assert_eq!(costs.estimate(&second_method), Duration::from_millis(8));
+
+    // Newer measurements are taken into account with a weight of 1/8.
+    costs.record(&second_method, Duration::from_millis(16));
+    assert_eq!(
+        costs.method_cost(&first_method),
+        Some(Duration::from_millis(8))
+    );
+    assert_eq!(
+        costs.method_cost(&second_method),
+        Some(Duration::from_millis(16))
+    );
+    assert_eq!(costs.average_cost(), Some(Duration::from_millis(9)));
+
+    costs.record(&first_method, Duration::from_millis(0));
+    assert_eq!(
+        costs.method_cost(&first_method),
+        Some(Duration::from_millis(7))
+    );
+}
@@ -54,7 +54,8 @@
 //!   in a blocking manner. The supervisor usually first commands a node to deploy the artifact
 //!   asynchronously via [`Mailbox`], once the decision to start deployment is reached
 //!   by the blockchain administrators. Asynchronous deployment speed and outcome may differ among
-//!   nodes.
+//!   nodes. Asynchronous deployment proceeds in the background, so the node continues processing
+//!   blocks; the outcome is reported to the supervisor once the deployment is completed.
 //!
 //! 4. The supervisor translates the local deployment outcomes into a consensus-agreed result.
 //!   For example, the supervisor may collect confirmations from the validator nodes that have
@@ -202,7 +203,7 @@
 //! [blog:lifecycle]: https://medium.com/meetbitfury/about-service-lifecycles-in-exonum-58c67678c6bb
 
 #[doc(hidden)] // re-exported from the `blockchain` module
-pub use self::dispatcher::TxCheckCache;
+pub use self::dispatcher::{ExecutionCosts, TxCheckCache};
 pub use self::{
     blockchain_data::{BlockchainData, SnapshotExt},
     dispatcher::{
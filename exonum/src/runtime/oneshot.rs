@@ -42,12 +42,24 @@ impl Receiver {
     /// Attempts to wait for a value on this receiver, returning an error if the
     /// corresponding channel has hung up.
     pub(crate) fn wait(self) -> Result<(), ExecutionError> {
-        self.0.recv().unwrap_or_else(|_| {
-            Err(ExecutionError::new(
-                ErrorKind::Unexpected,
-                "An error during waiting for deployment status occurred",
-            ))
-        })
+        self.0.recv().unwrap_or_else(|_| Err(Self::hung_up_error()))
+    }
+
+    /// Attempts to return a value on this receiver without blocking. Returns `None`
+    /// if the value has not been sent yet.
+    pub(crate) fn try_wait(&self) -> Option<Result<(), ExecutionError>> {
+        match self.0.try_recv() {
+            Ok(status) => Some(status),
+            Err(mpsc::TryRecvError::Empty) => None,
+            Err(mpsc::TryRecvError::Disconnected) => Some(Err(Self::hung_up_error())),
+        }
+    }
+
+    fn hung_up_error() -> ExecutionError {
+        ExecutionError::new(
+            ErrorKind::Unexpected,
+            "An error during waiting for deployment status occurred",
+        )
     }
 }
 
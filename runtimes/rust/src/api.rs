@@ -97,8 +97,7 @@ where
 pub struct ServiceApiState {
     /// Transaction broadcaster.
     broadcaster: Broadcaster,
-    // TODO Think about avoiding of unnecessary snapshots creation. [ECR-3222]
-    snapshot: Box<dyn Snapshot>,
+    snapshot: Arc<dyn Snapshot>,
     /// Endpoint path relative to the service root.
     endpoint: String,
     /// Current status of the service.
@@ -113,7 +112,7 @@ impl ServiceApiState {
         expected_artifact: &ArtifactId,
         endpoint: S,
     ) -> Result<Self> {
-        let snapshot = blockchain.snapshot();
+        let snapshot = blockchain.shared_snapshot();
         let instance_state = snapshot
             .for_dispatcher()
             .get_instance(instance.id)
@@ -148,7 +147,7 @@ impl ServiceApiState {
 
     /// Returns readonly access to blockchain data.
     pub fn data(&self) -> BlockchainData<&dyn Snapshot> {
-        BlockchainData::new(&self.snapshot, &self.instance().name)
+        BlockchainData::new(self.snapshot.as_ref(), &self.instance().name)
     }
 
     /// Returns readonly access to the data of the executing service.
@@ -159,7 +158,7 @@ impl ServiceApiState {
     /// Returns the access to the entire blockchain snapshot. Use [`data`](#method.data)
     /// or [`service_data`](#method.service_data) for more structure snapshot presentations.
     pub fn snapshot(&self) -> &dyn Snapshot {
-        &self.snapshot
+        self.snapshot.as_ref()
     }
 
     /// Returns the service key of this node.
@@ -181,7 +180,7 @@ impl ServiceApiState {
     /// is active (i.e., can process transactions). If these conditions do not hold, returns `None`.
     pub fn broadcaster(&self) -> Option<Broadcaster> {
         if self.status.is_active() {
-            CoreSchema::new(&self.snapshot).validator_id(self.service_key())?;
+            CoreSchema::new(self.snapshot.as_ref()).validator_id(self.service_key())?;
             Some(self.broadcaster.clone())
         } else {
             None
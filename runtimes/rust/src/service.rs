@@ -441,6 +441,10 @@ pub struct SupervisorExtensions<'a> {
 impl SupervisorExtensions<'_> {
     /// Starts the deployment of an artifact. The provided callback is executed after
     /// the deployment is completed.
+    ///
+    /// The node does not wait for the deployment to complete; the callback is executed
+    /// in a separate thread. If the artifact is already being deployed, the callback
+    /// is not executed.
     pub fn start_deploy(
         &mut self,
         artifact: ArtifactId,
@@ -19,6 +19,7 @@
 //!
 //! - [List blocks](#list-blocks)
 //! - [Get specific block](#get-specific-block)
+//! - [Export blocks](#export-blocks)
 //! - [Get transaction by hash](#transaction-by-hash)
 //! - Call status:
 //!
@@ -142,6 +143,54 @@
 //! # }
 //! ```
 //!
+//! # Export Blocks
+//!
+//! | Property    | Value |
+//! |-------------|-------|
+//! | Path        | `/api/explorer/v1/blocks/export` |
+//! | Method      | GET   |
+//! | Query type  | [`BlocksExportQuery`] |
+//! | Return type | [`ExportedBlock`] stream |
+//!
+//! Streams blocks in the `earliest..=latest` range in ascending order together with
+//! their precommits, transactions and execution statuses. The response is
+//! newline-delimited JSON (`application/x-ndjson`): each line contains a single block.
+//! Unlike [listing blocks](#list-blocks), the number of exported blocks is not limited;
+//! blocks are read from a single snapshot and serialized one by one as the client
+//! consumes the response, so exporting a long range does not require buffering it
+//! on the node. If `with_proofs` is set, each transaction is accompanied by the proof
+//! of its inclusion into the block. If the node prunes history, the export starts
+//! from the earliest block with the retained transactions.
+//!
+//! [`BlocksExportQuery`]: struct.BlocksExportQuery.html
+//! [`ExportedBlock`]: struct.ExportedBlock.html
+//!
+//! ```
+//! # use exonum::helpers::Height;
+//! # use exonum_explorer_service::{api::ExportedBlock, ExplorerFactory};
+//! # use exonum_testkit::{Spec, TestKitBuilder};
+//! #
+//! # #[tokio::main]
+//! # async fn main() -> anyhow::Result<()> {
+//! # let mut testkit = TestKitBuilder::validator()
+//! #    .with(Spec::new(ExplorerFactory).with_default_instance())
+//! #    .build();
+//! testkit.create_blocks_until(Height(5));
+//!
+//! let api = testkit.api();
+//! let url = api.public_url("api/explorer/v1/blocks/export?earliest=2&latest=4");
+//! let response = reqwest::get(&url).await?.error_for_status()?.text().await?;
+//! let blocks = response
+//!     .lines()
+//!     .map(serde_json::from_str)
+//!     .collect::<Result<Vec<ExportedBlock>, _>>()?;
+//! assert_eq!(blocks.len(), 3);
+//! assert_eq!(blocks[0].header.height, Height(2));
+//! assert_eq!(blocks[2].header.height, Height(4));
+//! # Ok(())
+//! # }
+//! ```
+//!
 //! # Transaction by Hash
 //!
 //! | Property    | Value |
@@ -426,11 +475,11 @@ pub use exonum_explorer::{
         CommittedTransactionSummary, Notification, SubscriptionType, TransactionFilter,
     },
     api::{
-        BlockInfo, BlockQuery, BlocksQuery, BlocksRange, CallStatusQuery, CallStatusResponse,
-        TransactionHex, TransactionQuery, TransactionResponse, TransactionStatusQuery,
-        MAX_BLOCKS_PER_REQUEST,
+        BlockInfo, BlockQuery, BlocksExportQuery, BlocksQuery, BlocksRange, CallStatusQuery,
+        CallStatusResponse, TransactionHex, TransactionQuery, TransactionResponse,
+        TransactionStatusQuery, MAX_BLOCKS_PER_REQUEST,
     },
-    TransactionInfo,
+    ExportedBlock, ExportedTransaction, TransactionInfo,
 };
 
 use exonum::{
@@ -448,6 +497,7 @@ use serde_json::json;
 
 use std::{cell::RefCell, ops::Bound};
 
+mod export;
 pub mod websocket;
 
 #[derive(Debug)]
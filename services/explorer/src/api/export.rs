@@ -0,0 +1,117 @@
+// Copyright 2020 The Exonum Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Streaming export of blocks and transactions.
+
+use actix_web::{
+    http,
+    web::{Bytes, Query},
+    HttpResponse,
+};
+use exonum::{
+    blockchain::{Blockchain, Schema},
+    helpers::Height,
+};
+use exonum_api::{
+    self as api,
+    backends::actix::{HttpRequest, RawHandler, RequestHandler},
+    ApiBackend,
+};
+use exonum_explorer::BlockchainExplorer;
+use exonum_rust_runtime::api::ServiceApiScope;
+use futures::{future, stream, FutureExt};
+
+use std::sync::Arc;
+
+use super::{BlocksExportQuery, ExplorerApi};
+
+/// MIME type of newline-delimited JSON.
+const NDJSON_CONTENT_TYPE: &str = "application/x-ndjson";
+
+impl ExplorerApi {
+    /// Streams exported blocks as newline-delimited JSON, one block per line. All blocks
+    /// are read from a single snapshot. Each block is read and serialized only when
+    /// the client is ready to receive it.
+    fn export_blocks(
+        blockchain: &Blockchain,
+        query: &BlocksExportQuery,
+    ) -> api::Result<HttpResponse> {
+        let snapshot = blockchain.shared_snapshot();
+        let schema = Schema::new(snapshot.as_ref());
+        let height = schema.height();
+        let first_retained_height = schema.first_retained_height();
+        let latest = query.latest.unwrap_or(height);
+        if latest > height {
+            let detail = format!(
+                "Requested latest height {} is greater than the current blockchain height {}",
+                latest, height
+            );
+            return Err(api::Error::not_found()
+                .title("Block not found")
+                .detail(detail));
+        }
+
+        let end = latest.next();
+        let with_proofs = query.with_proofs;
+        // Blocks with the pruned transactions cannot be exported.
+        let start = query
+            .earliest
+            .unwrap_or(Height(0))
+            .max(first_retained_height);
+        let blocks = stream::unfold((snapshot, start), move |(snapshot, mut height)| {
+            let line = {
+                let explorer = BlockchainExplorer::new(snapshot.as_ref());
+                loop {
+                    if height >= end {
+                        return future::ready(None);
+                    }
+                    // Blocks that cannot be exported are skipped instead of breaking the stream.
+                    if let Some(block) = explorer.export_block(height, with_proofs) {
+                        let mut line = serde_json::to_vec(&block).expect("Cannot serialize block");
+                        line.push(b'\n');
+                        break line;
+                    }
+                    height = height.next();
+                }
+            };
+            let item = Ok::<_, api::Error>(Bytes::from(line));
+            future::ready(Some((item, (snapshot, height.next()))))
+        });
+
+        Ok(HttpResponse::Ok()
+            .content_type(NDJSON_CONTENT_TYPE)
+            .streaming(blocks))
+    }
+
+    pub fn wire_export(&self, api_scope: &mut ServiceApiScope) -> &Self {
+        let blockchain = self.blockchain.clone();
+        let handler = move |request: HttpRequest| -> Result<HttpResponse, actix_web::Error> {
+            let query =
+                Query::<BlocksExportQuery>::from_query(request.query_string()).map_err(|e| {
+                    api::Error::bad_request()
+                        .title("Invalid query")
+                        .detail(e.to_string())
+                })?;
+            Self::export_blocks(&blockchain, &query).map_err(From::from)
+        };
+        let raw_handler = move |request, _stream| future::ready(handler(request)).boxed_local();
+
+        api_scope.web_backend().raw_handler(RequestHandler {
+            name: "v1/blocks/export".to_owned(),
+            method: http::Method::GET,
+            inner: Arc::from(raw_handler) as Arc<RawHandler>,
+        });
+        self
+    }
+}
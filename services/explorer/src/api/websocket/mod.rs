@@ -281,6 +281,9 @@ enum Message {
     Data(String),
     /// This message will terminate a client session.
     Close,
+    /// This message will terminate a client session which does not read notifications
+    /// fast enough.
+    CloseLagging,
 }
 
 /// This message will terminate server.
@@ -327,8 +330,17 @@ struct Broadcast {
 #[rtype("anyhow::Result<TransactionResponse>")]
 struct Transaction(TransactionHex);
 
+/// Client of the server together with its subscriptions.
+struct Client {
+    address: Recipient<Message>,
+    subscriptions: Vec<SubscriptionType>,
+}
+
 pub(crate) struct Server {
+    /// Subscribers indexed by the subscription type. Since transaction filters are a part
+    /// of the subscription type, finding subscribers for a transaction is just a lookup.
     subscribers: BTreeMap<SubscriptionType, HashMap<u64, Recipient<Message>>>,
+    clients: HashMap<u64, Client>,
     blockchain: Blockchain,
     next_id: u64,
 }
@@ -338,6 +350,7 @@ impl fmt::Debug for Server {
         formatter
             .debug_struct("Server")
             .field("subscribers", &self.subscribers.keys().collect::<Vec<_>>())
+            .field("clients", &self.clients.len())
             .field("blockchain", &self.blockchain)
             .finish()
     }
@@ -350,47 +363,66 @@ impl Server {
     fn new(blockchain: Blockchain) -> Self {
         Self {
             subscribers: BTreeMap::new(),
+            clients: HashMap::new(),
             blockchain,
             next_id: 0,
         }
     }
 
-    fn remove_subscriber(&mut self, id: u64) {
-        for subscriber_group in self.subscribers.values_mut() {
-            subscriber_group.remove(&id);
+    fn remove_subscriber(&mut self, id: u64) -> Option<Recipient<Message>> {
+        let client = self.clients.remove(&id)?;
+        for sub_type in &client.subscriptions {
+            let is_empty = self.subscribers.get_mut(sub_type).map_or(false, |group| {
+                group.remove(&id);
+                group.is_empty()
+            });
+            if is_empty {
+                self.subscribers.remove(sub_type);
+            }
         }
+        Some(client.address)
     }
 
     fn set_subscriptions(
         &mut self,
         id: u64,
-        addr: &Recipient<Message>,
+        addr: Recipient<Message>,
         subscriptions: Vec<SubscriptionType>,
     ) {
-        for sub_type in subscriptions {
+        for sub_type in &subscriptions {
             self.subscribers
-                .entry(sub_type)
+                .entry(sub_type.to_owned())
                 .or_insert_with(HashMap::new)
-                .insert(id, addr.to_owned());
+                .insert(id, addr.clone());
         }
+        let client = Client {
+            address: addr,
+            subscriptions,
+        };
+        self.clients.insert(id, client);
     }
 
     fn disconnect_all(&mut self) {
-        let subscribers = mem::replace(&mut self.subscribers, BTreeMap::new());
-        for (_, subscriber_group) in subscribers {
-            for (_, recipient) in subscriber_group {
-                if recipient.connected() {
-                    if let Err(err) = recipient.do_send(Message::Close) {
-                        log::warn!(
-                            "Can't send `Close` message to a websocket client: {:?}",
-                            err
-                        );
-                    }
+        self.subscribers.clear();
+        let clients = mem::replace(&mut self.clients, HashMap::new());
+        for client in clients.values() {
+            if client.address.connected() {
+                if let Err(err) = client.address.do_send(Message::Close) {
+                    log::warn!(
+                        "Can't send `Close` message to a websocket client: {:?}",
+                        err
+                    );
                 }
             }
         }
     }
 
+    fn has_transaction_subscribers(&self) -> bool {
+        self.subscribers
+            .keys()
+            .any(|sub_type| matches!(sub_type, SubscriptionType::Transactions { .. }))
+    }
+
     fn check_transaction(&self, message: &Transaction) -> anyhow::Result<Verified<AnyTx>> {
         let signed = SignedMessage::from_hex(message.0.tx_body.as_bytes())?;
         let verified = signed.into_verified()?;
@@ -432,7 +464,7 @@ impl Handler<Subscribe> for Server {
     fn handle(&mut self, message: Subscribe, _ctx: &mut Self::Context) -> u64 {
         let id = self.next_id;
         self.next_id += 1;
-        self.set_subscriptions(id, &message.address, message.subscriptions);
+        self.set_subscriptions(id, message.address, message.subscriptions);
         id
     }
 }
@@ -449,26 +481,10 @@ impl Handler<UpdateSubscriptions> for Server {
     type Result = ();
 
     fn handle(&mut self, message: UpdateSubscriptions, _ctx: &mut Self::Context) {
-        // Find address of subscriber. If id not found, assume that subscriber doesn't exist
-        // and return.
-        let maybe_addr =
-            self.subscribers
-                .values()
-                .flat_map(HashMap::iter)
-                .find_map(|(id, addr)| {
-                    if *id == message.id {
-                        Some(addr.clone())
-                    } else {
-                        None
-                    }
-                });
-        let addr = if let Some(addr) = maybe_addr {
-            addr
-        } else {
-            return;
-        };
-        self.remove_subscriber(message.id);
-        self.set_subscriptions(message.id, &addr, message.subscriptions);
+        // If id not found, assume that subscriber doesn't exist and return.
+        if let Some(addr) = self.remove_subscriber(message.id) {
+            self.set_subscriptions(message.id, addr, message.subscriptions);
+        }
     }
 }
 
@@ -487,12 +503,17 @@ impl Handler<Broadcast> for Server {
             return;
         };
         let height = block.height;
-        let block_header = Notification::Block(block);
 
         // Notify about block
-        self.broadcast_message(SubscriptionType::Blocks, &block_header);
+        if self.subscribers.contains_key(&SubscriptionType::Blocks) {
+            let block_header = serialize_notification(&Notification::Block(block));
+            self.broadcast_message(&SubscriptionType::Blocks, &block_header);
+        }
 
         // Get list of transactions in block and notify about each of them.
+        if !self.has_transaction_subscribers() {
+            return;
+        }
         let tx_hashes_table = schema.block_transactions(height);
         let tx_infos = tx_hashes_table.iter().map(|hash| {
             CommittedTransactionSummary::new(&schema, &hash).unwrap_or_else(|| {
@@ -508,20 +529,27 @@ impl Handler<Broadcast> for Server {
         for tx_info in tx_infos {
             let instance_id = tx_info.instance_id;
             let method_id = tx_info.method_id;
-            let data = Notification::Transaction(tx_info);
-            self.broadcast_message(SubscriptionType::Transactions { filter: None }, &data);
-            self.broadcast_message(
+            let sub_types = [
+                SubscriptionType::Transactions { filter: None },
                 SubscriptionType::Transactions {
                     filter: Some(TransactionFilter::new(instance_id, None)),
                 },
-                &data,
-            );
-            self.broadcast_message(
                 SubscriptionType::Transactions {
                     filter: Some(TransactionFilter::new(instance_id, Some(method_id))),
                 },
-                &data,
-            );
+            ];
+            if !sub_types
+                .iter()
+                .any(|sub_type| self.subscribers.contains_key(sub_type))
+            {
+                continue;
+            }
+
+            // The notification is serialized once for all matching subscribers.
+            let data = serialize_notification(&Notification::Transaction(tx_info));
+            for sub_type in &sub_types {
+                self.broadcast_message(sub_type, &data);
+            }
         }
     }
 }
@@ -543,19 +571,41 @@ impl Handler<Terminate> for Server {
     }
 }
 
+fn serialize_notification(notification: &Notification) -> String {
+    serde_json::to_string(notification).expect("Cannot serialize notification")
+}
+
 impl Server {
-    fn broadcast_message<T>(&mut self, sub_type: SubscriptionType, data: &T)
-    where
-        T: serde::Serialize,
-    {
-        let subscriber_group = self
-            .subscribers
-            .entry(sub_type)
-            .or_insert_with(HashMap::new);
-
-        let serialized = serde_json::to_string(data).unwrap();
-        for addr in subscriber_group.values() {
-            addr.do_send(Message::Data(serialized.clone())).ok();
+    /// Sends a serialized notification to the subscribers of the specified type.
+    ///
+    /// Messages are put into the bounded mailboxes of the client sessions. If the mailbox
+    /// of a client is full, i.e., the client does not read notifications fast enough,
+    /// the client is disconnected instead of buffering further notifications.
+    fn broadcast_message(&mut self, sub_type: &SubscriptionType, data: &str) {
+        let subscriber_group = if let Some(group) = self.subscribers.get(sub_type) {
+            group
+        } else {
+            return;
+        };
+
+        let mut disconnected = vec![];
+        for (&id, addr) in subscriber_group {
+            match addr.try_send(Message::Data(data.to_owned())) {
+                Ok(()) => {}
+                Err(SendError::Full(_)) => {
+                    log::warn!(
+                        "Disconnecting websocket client {} since it does not read notifications",
+                        id
+                    );
+                    // `do_send` ignores the mailbox capacity.
+                    addr.do_send(Message::CloseLagging).ok();
+                    disconnected.push(id);
+                }
+                Err(SendError::Closed(_)) => disconnected.push(id),
+            }
+        }
+        for id in disconnected {
+            self.remove_subscriber(id);
         }
     }
 }
@@ -567,6 +617,10 @@ pub(crate) struct Session {
 }
 
 impl Session {
+    /// Capacity of the session mailbox. The capacity is large enough to fit notifications
+    /// about a block with the default maximum number of transactions.
+    const MAILBOX_CAPACITY: usize = 4_096;
+
     pub fn new(server_address: Addr<Server>, subscriptions: Vec<SubscriptionType>) -> Self {
         Self {
             id: 0,
@@ -604,6 +658,7 @@ impl Actor for Session {
     type Context = ws::WebsocketContext<Self>;
 
     fn started(&mut self, ctx: &mut Self::Context) {
+        ctx.set_mailbox_capacity(Self::MAILBOX_CAPACITY);
         let address: Recipient<_> = ctx.address().recipient();
         self.server_address
             .send(Subscribe {
@@ -642,6 +697,13 @@ impl Handler<Message> for Session {
                 }));
                 ctx.stop();
             }
+            Message::CloseLagging => {
+                ctx.close(Some(ws::CloseReason {
+                    code: ws::CloseCode::Policy,
+                    description: Some("Client does not read notifications".into()),
+                }));
+                ctx.stop();
+            }
         }
     }
 }
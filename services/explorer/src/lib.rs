@@ -137,6 +137,7 @@ impl Service for ExplorerService {
             .public_scope();
         ExplorerApi::new(blockchain)
             .wire_rest(scope)
+            .wire_export(scope)
             .wire_ws(self.shared_state.get_ref(), scope);
     }
 }
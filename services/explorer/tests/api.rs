@@ -21,7 +21,7 @@ use exonum::{
     runtime::{ErrorKind, ExecutionError, ExecutionStatus},
 };
 use exonum_api as api;
-use exonum_explorer::{api::*, BlockchainExplorer, TransactionInfo};
+use exonum_explorer::{api::*, BlockchainExplorer, ExportedBlock, TransactionInfo};
 use exonum_testkit::{ApiKind, Spec, TestKit, TestKitApi, TestKitBuilder};
 use serde_json::{json, Value};
 
@@ -339,6 +339,135 @@ async fn test_explorer_blocks_bounds() {
     assert!(result.is_err());
 }
 
+#[tokio::test]
+async fn test_explorer_blocks_export() {
+    let (mut testkit, api) = init_testkit();
+    for _ in 0..6 {
+        create_sample_block(&mut testkit).await;
+    }
+
+    let export = |query: &str| {
+        let url = api.public_url(&format!("api/explorer/v1/blocks/export{}", query));
+        async move {
+            let response = reqwest::get(&url).await.unwrap();
+            let status = response.status();
+            let body = response.text().await.unwrap();
+            (status, body)
+        }
+    };
+
+    let (status, body) = export("").await;
+    assert!(status.is_success());
+    let blocks = body
+        .lines()
+        .map(|line| serde_json::from_str(line).unwrap())
+        .collect::<Vec<ExportedBlock>>();
+    assert_eq!(blocks.len(), 7);
+    for (i, block) in blocks.iter().enumerate() {
+        assert_eq!(block.header.height, Height(i as u64));
+        assert_eq!(block.transactions.len(), block.header.tx_count as usize);
+        assert!(block
+            .transactions
+            .iter()
+            .all(|tx| tx.location_proof.is_none()));
+    }
+    assert_eq!(blocks[2].transactions.len(), 1);
+    assert_eq!(blocks[5].transactions.len(), 1);
+
+    let (status, body) = export("?earliest=2&latest=5&with_proofs=true").await;
+    assert!(status.is_success());
+    let blocks = body
+        .lines()
+        .map(|line| serde_json::from_str(line).unwrap())
+        .collect::<Vec<ExportedBlock>>();
+    let heights: Vec<_> = blocks.iter().map(|block| block.header.height).collect();
+    assert_eq!(heights, vec![Height(2), Height(3), Height(4), Height(5)]);
+    let tx = &blocks[0].transactions[0];
+    let proof = tx.location_proof.as_ref().unwrap();
+    let entries = proof
+        .check_against_hash(blocks[0].header.tx_hash)
+        .unwrap()
+        .entries()
+        .to_vec();
+    assert_eq!(entries, vec![(0, tx.message.object_hash())]);
+
+    // Check `latest` param is exceed the height.
+    let (status, _) = export("?latest=7").await;
+    assert_eq!(status, reqwest::StatusCode::NOT_FOUND);
+    let (status, _) = export("?earliest=foo").await;
+    assert_eq!(status, reqwest::StatusCode::BAD_REQUEST);
+}
+
+#[tokio::test]
+async fn test_explorer_blocks_export_with_pruned_history() {
+    let (mut testkit, api) = init_testkit();
+    for _ in 0..6 {
+        create_sample_block(&mut testkit).await;
+    }
+    let first_retained_height = testkit.prune_history(3);
+    assert_eq!(first_retained_height, Height(4));
+
+    let export = |query: &str| {
+        let url = api.public_url(&format!("api/explorer/v1/blocks/export{}", query));
+        async move {
+            let response = reqwest::get(&url).await.unwrap();
+            assert!(response.status().is_success());
+            let body = response.text().await.unwrap();
+            body.lines()
+                .map(|line| serde_json::from_str(line).unwrap())
+                .map(|block: ExportedBlock| block.header.height)
+                .collect::<Vec<_>>()
+        }
+    };
+
+    // Pruned blocks are not exported.
+    assert_eq!(export("").await, vec![Height(4), Height(5), Height(6)]);
+    assert_eq!(
+        export("?earliest=1&latest=5").await,
+        vec![Height(4), Height(5)]
+    );
+    assert_eq!(export("?latest=2").await, Vec::<Height>::new());
+}
+
+#[tokio::test]
+async fn test_explorer_pruned_block() {
+    let (mut testkit, api) = init_testkit();
+    for _ in 0..6 {
+        create_sample_block(&mut testkit).await;
+    }
+    testkit.prune_history(3);
+
+    // Transactions of the pruned block are not reported as an empty list.
+    let info: BlockInfo = api
+        .public(ApiKind::Explorer)
+        .get("v1/block?height=2")
+        .await
+        .unwrap();
+    assert!(info.pruned);
+    assert!(info.txs.is_none());
+    let info: BlockInfo = api
+        .public(ApiKind::Explorer)
+        .get("v1/block?height=5")
+        .await
+        .unwrap();
+    assert!(!info.pruned);
+    assert_eq!(info.txs.unwrap().len(), 1);
+
+    let snapshot = testkit.snapshot();
+    let explorer = BlockchainExplorer::new(snapshot.as_ref());
+    let block_info = explorer.block(Height(2)).unwrap();
+    assert!(block_info.is_pruned());
+    assert_eq!(block_info.transaction_hashes().len(), 1);
+    assert!(block_info.transaction(0).is_none());
+    let block = block_info.with_transactions();
+    assert!(block.pruned);
+    assert!(block.transactions.is_empty());
+
+    let block = explorer.block_with_txs(Height(5)).unwrap();
+    assert!(!block.pruned);
+    assert_eq!(block.transactions.len(), 1);
+}
+
 #[tokio::test]
 async fn test_explorer_blocks_loaded_info() {
     let (mut testkit, api) = init_testkit();
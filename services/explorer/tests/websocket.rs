@@ -17,7 +17,9 @@
 use actix_web_actors::ws::CloseCode;
 use assert_matches::assert_matches;
 use exonum::{
-    crypto::KeyPair, helpers::Height, merkledb::ObjectHash,
+    crypto::{Hash, KeyPair},
+    helpers::Height,
+    merkledb::ObjectHash,
     runtime::SUPERVISOR_INSTANCE_ID as SUPERVISOR_ID,
 };
 use exonum_explorer::api::websocket::Notification;
@@ -31,7 +33,7 @@ use websocket::{
     OwnedMessage,
 };
 
-use std::{thread, time::Duration};
+use std::{collections::HashSet, thread, time::Duration};
 
 use exonum_explorer_service::ExplorerFactory;
 
@@ -83,6 +85,13 @@ fn assert_closure(mut client: Client<TcpStream>) {
     client.shutdown().ok();
 }
 
+fn receive_tx_hash(client: &mut Client<TcpStream>) -> Hash {
+    match receive_message(client).unwrap() {
+        Notification::Transaction(summary) => summary.tx_hash,
+        notification => panic!("Unexpected notification: {:?}", notification),
+    }
+}
+
 fn init_testkit() -> (TestKit, TestKitApi) {
     let mut testkit = TestKitBuilder::validator()
         .with(Spec::new(CounterService).with_default_instance())
@@ -272,6 +281,86 @@ fn test_transactions_subscribe_with_bad_filter() {
     assert_no_message(&mut client);
 }
 
+/// Checks that notifications are delivered to many subscribers with different filters.
+#[test]
+fn test_many_subscribers() {
+    const CLIENTS_PER_SUBSCRIPTION: usize = 20;
+
+    let (mut testkit, api) = init_testkit();
+    let all_txs_url = api.public_url("api/explorer/v1/transactions/subscribe");
+    let filtered_url = format!(
+        "api/explorer/v1/transactions/subscribe?instance_id={}&method_id=0",
+        SERVICE_ID
+    );
+    let filtered_url = api.public_url(&filtered_url);
+
+    let mut all_txs_clients: Vec<_> = (0..CLIENTS_PER_SUBSCRIPTION)
+        .map(|_| create_ws_client(&all_txs_url))
+        .collect();
+    let mut filtered_clients: Vec<_> = (0..CLIENTS_PER_SUBSCRIPTION)
+        .map(|_| create_ws_client(&filtered_url))
+        .collect();
+
+    // Even transactions call method 0 (`increment`), odd ones call method 1 (`reset`).
+    let txs: Vec<_> = (0..10)
+        .map(|i| {
+            let keypair = KeyPair::random();
+            if i % 2 == 0 {
+                keypair.increment(SERVICE_ID, i + 1)
+            } else {
+                keypair.reset(SERVICE_ID, ())
+            }
+        })
+        .collect();
+    testkit.create_block_with_transactions(txs.clone());
+
+    // The order of transactions in the block may differ from the order of `txs`.
+    let all_hashes: HashSet<_> = txs.iter().map(ObjectHash::object_hash).collect();
+    let filtered_hashes: HashSet<_> = txs.iter().step_by(2).map(ObjectHash::object_hash).collect();
+
+    for client in &mut all_txs_clients {
+        let hashes: HashSet<_> = (0..txs.len()).map(|_| receive_tx_hash(client)).collect();
+        assert_eq!(hashes, all_hashes);
+    }
+    for client in &mut filtered_clients {
+        let hashes: HashSet<_> = (0..filtered_hashes.len())
+            .map(|_| receive_tx_hash(client))
+            .collect();
+        assert_eq!(hashes, filtered_hashes);
+    }
+    // Checking a single client is enough, since all clients have the same subscription.
+    assert_no_message(&mut filtered_clients[0]);
+}
+
+/// Checks that a client is disconnected if notifications overflow its mailbox.
+#[test]
+fn test_lagging_subscriber_is_disconnected() {
+    // Exceeds the mailbox capacity of a client session (4_096 messages). Notifications
+    // about the block are sent at once, so the session cannot drain its mailbox in between.
+    const TX_COUNT: u64 = 4_500;
+
+    let (mut testkit, api) = init_testkit();
+    let url = api.public_url("api/explorer/v1/transactions/subscribe");
+    let mut client = create_ws_client(&url);
+
+    let txs = (0..TX_COUNT).map(|i| KeyPair::random().increment(SERVICE_ID, i + 1));
+    testkit.create_block_with_transactions(txs);
+
+    let mut notification_count = 0;
+    loop {
+        match client.recv_message().expect("Cannot receive WS message") {
+            OwnedMessage::Text(_) => notification_count += 1,
+            OwnedMessage::Close(Some(data)) => {
+                assert_eq!(data.status_code, CloseCode::Policy.into());
+                break;
+            }
+            other => panic!("Unexpected WS response: {:?}", other),
+        }
+    }
+    assert!(notification_count < TX_COUNT);
+    client.shutdown().ok();
+}
+
 #[test]
 fn test_dynamic_subscriptions() {
     let (mut testkit, api) = init_testkit();
@@ -0,0 +1,650 @@
+// Copyright 2020 The Exonum Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+use anyhow::{bail, format_err};
+use exonum::{
+    crypto::{Hash, KeyPair},
+    helpers::Height,
+    merkledb::{BinaryValue, Database, DbOptions, ObjectHash, RocksDB, TemporaryDB},
+    messages::{AnyTx, Verified},
+    runtime::SnapshotExt,
+};
+use exonum_rust_runtime::{
+    spec::{Deploy, Spec},
+    DefaultInstance,
+};
+use futures::future;
+use serde_derive::{Deserialize, Serialize};
+use structopt::StructOpt;
+use tokio::time::delay_for;
+
+use std::{
+    collections::HashMap,
+    fs,
+    path::PathBuf,
+    process,
+    sync::Arc,
+    time::{Duration, Instant},
+};
+
+use exonum_soak_tests::{
+    services::{MainConfig, MainService, MainServiceInterface},
+    NetworkBuilder, RunHandle,
+};
+
+/// Runs a network with a service and subjects it to an open-loop transaction load,
+/// measuring the commit latency and the resource usage of the nodes.
+///
+/// Transactions are sent on schedule regardless of whether the previous transactions
+/// are committed. Latency is measured from the scheduled submission time, so that
+/// the delays introduced by the node do not reduce the load.
+#[derive(Debug, StructOpt)]
+#[structopt(name = "bench", set_term_width = 80)]
+struct Args {
+    /// Number of nodes in the network.
+    #[structopt(name = "nodes", default_value = "4")]
+    node_count: u16,
+
+    /// Duration of the load phase in seconds.
+    #[structopt(name = "duration", long, short = "d", default_value = "30")]
+    duration: u64,
+
+    /// Initial intensity of the load, in transactions per second.
+    #[structopt(name = "tps", long, short = "t", default_value = "100")]
+    tps: f64,
+
+    /// Final intensity of the load, in transactions per second. The intensity is increased
+    /// linearly from `tps` during the load phase. If not specified, the intensity is constant.
+    #[structopt(name = "ramp-to", long, short = "r")]
+    ramp_to: Option<f64>,
+
+    /// Mix of the generated transactions as comma-separated `kind:weight` pairs, where
+    /// `kind` is either `timestamp` or `store=<payload size in bytes>`
+    /// (e.g., `timestamp:2,store=1024:1`).
+    #[structopt(
+        name = "mix",
+        long,
+        short = "m",
+        default_value = "timestamp:1",
+        parse(try_from_str = parse_mix)
+    )]
+    mix: TxMix,
+
+    /// Maximum time in seconds to wait for the committing of sent transactions
+    /// after the load phase.
+    #[structopt(name = "drain", long, default_value = "10")]
+    drain: u64,
+
+    /// Directory to store `RocksDB` databases of the nodes in. If not specified, nodes use
+    /// in-memory databases. The directory should not contain data from the previous runs.
+    #[structopt(name = "db-dir", long)]
+    db_dir: Option<PathBuf>,
+
+    /// Path to write the JSON report to.
+    #[structopt(name = "report", long, short = "o")]
+    report: Option<PathBuf>,
+
+    /// Path to the JSON report of a previous run to compare the results with.
+    #[structopt(name = "baseline", long, short = "b")]
+    baseline: Option<PathBuf>,
+
+    /// Allowed regression against the baseline in percent. If the throughput decreases or
+    /// the 99th percentile of latency increases by a greater amount, the process exits
+    /// with a non-zero code.
+    #[structopt(name = "max-regression", long, default_value = "10")]
+    max_regression: f64,
+}
+
+#[derive(Debug, Clone, Copy, PartialEq)]
+enum TxKind {
+    Timestamp,
+    Store(usize),
+}
+
+/// Weighted mix of the generated transactions.
+#[derive(Debug, Clone)]
+struct TxMix {
+    kinds: Vec<(TxKind, u32)>,
+    total_weight: u32,
+}
+
+fn parse_mix(s: &str) -> anyhow::Result<TxMix> {
+    let mut kinds = vec![];
+    for entry in s.split(',') {
+        let mut parts = entry.trim().splitn(2, ':');
+        let kind = match parts.next().unwrap_or_default() {
+            "timestamp" => TxKind::Timestamp,
+            kind if kind.starts_with("store=") => {
+                // 6 is the length of "store=".
+                let size: usize = kind[6..].parse()?;
+                // The payload starts with an 8-byte counter ensuring transaction uniqueness.
+                TxKind::Store(size.max(8))
+            }
+            kind => bail!("Invalid transaction kind: {}", kind),
+        };
+        let weight: u32 = match parts.next() {
+            Some(weight) => weight.parse()?,
+            None => 1,
+        };
+        kinds.push((kind, weight));
+    }
+
+    let total_weight = kinds.iter().map(|(_, weight)| weight).sum();
+    if total_weight == 0 {
+        return Err(format_err!("Transaction mix should have positive weight"));
+    }
+    Ok(TxMix {
+        kinds,
+        total_weight,
+    })
+}
+
+impl TxMix {
+    /// Deterministically selects the kind of the transaction with the specified index.
+    fn kind(&self, index: u64) -> TxKind {
+        let mut position = (index % u64::from(self.total_weight)) as u32;
+        for &(kind, weight) in &self.kinds {
+            if position < weight {
+                return kind;
+            }
+            position -= weight;
+        }
+        unreachable!("`position` is lesser than total weight")
+    }
+
+    fn create_tx(&self, keys: &KeyPair, index: u64) -> Verified<AnyTx> {
+        match self.kind(index) {
+            TxKind::Timestamp => keys.timestamp(MainService::INSTANCE_ID, Height(index)),
+            TxKind::Store(size) => {
+                let mut data = vec![0; size];
+                data[..8].copy_from_slice(&index.to_le_bytes());
+                keys.store(MainService::INSTANCE_ID, data)
+            }
+        }
+    }
+}
+
+/// Linearly changing load intensity.
+#[derive(Debug, Clone, Copy)]
+struct LoadProfile {
+    start_tps: f64,
+    end_tps: f64,
+    duration: Duration,
+}
+
+impl LoadProfile {
+    fn tps_at(&self, elapsed: Duration) -> f64 {
+        let progress = elapsed.as_secs_f64() / self.duration.as_secs_f64();
+        self.start_tps + (self.end_tps - self.start_tps) * progress.min(1.0)
+    }
+
+    /// Returns the number of transactions that should be sent by the `elapsed` time,
+    /// i.e., the integral of the load intensity.
+    fn txs_due(&self, elapsed: Duration) -> u64 {
+        let elapsed = elapsed.min(self.duration).as_secs_f64();
+        let duration = self.duration.as_secs_f64();
+        let txs = self.start_tps * elapsed
+            + (self.end_tps - self.start_tps) * elapsed * elapsed / (2.0 * duration);
+        txs as u64
+    }
+
+    /// Returns the time since the start of the load at which the transaction with
+    /// the specified zero-based index is due, i.e., the inverse of `txs_due()`.
+    fn scheduled_time(&self, index: u64) -> Duration {
+        let duration = self.duration.as_secs_f64();
+        let txs = (index + 1) as f64;
+        // Root of `start_tps * t + (end_tps - start_tps) * t^2 / (2 * duration) = txs`
+        // in the form that is numerically stable and handles the constant intensity.
+        let slope = (self.end_tps - self.start_tps) / duration;
+        let discriminant = (self.start_tps * self.start_tps + 2.0 * slope * txs).max(0.0);
+        let elapsed = 2.0 * txs / (self.start_tps + discriminant.sqrt());
+        let mut scheduled_time = Duration::from_secs_f64(elapsed.min(duration));
+        // Compensate for rounding errors, so that the transaction is due at the returned time.
+        while self.txs_due(scheduled_time) <= index && scheduled_time < self.duration {
+            scheduled_time += Duration::from_nanos(1);
+        }
+        scheduled_time
+    }
+}
+
+/// Resource usage of the benchmark process. The nodes are run within a single process,
+/// thus the values are aggregated among all nodes. Values are only available on Linux.
+#[derive(Debug, Clone, Copy, Default, Serialize, Deserialize)]
+struct ResourceUsage {
+    /// Processor time consumed by the process (both in user and kernel mode) in seconds.
+    cpu_secs: Option<f64>,
+    /// Resident set size in bytes.
+    rss_bytes: Option<u64>,
+    /// Peak resident set size in bytes.
+    peak_rss_bytes: Option<u64>,
+    /// Number of bytes the process has caused to be sent to the storage layer.
+    disk_write_bytes: Option<u64>,
+}
+
+impl ResourceUsage {
+    /// Number of clock ticks per second. This value is fixed for all mainstream Linux
+    /// architectures.
+    const CLOCK_TICKS_PER_SEC: f64 = 100.0;
+
+    fn current() -> Self {
+        Self {
+            cpu_secs: Self::cpu_secs(),
+            rss_bytes: Self::status_field("VmRSS:"),
+            peak_rss_bytes: Self::status_field("VmHWM:"),
+            disk_write_bytes: Self::disk_write_bytes(),
+        }
+    }
+
+    fn cpu_secs() -> Option<f64> {
+        let stat = fs::read_to_string("/proc/self/stat").ok()?;
+        // The process name may contain spaces, so the fields are counted from its end.
+        let fields: Vec<_> = stat[stat.rfind(')')? + 1..].split_whitespace().collect();
+        // `utime` and `stime` are the 14th and 15th fields of the file.
+        let user_ticks: u64 = fields.get(11)?.parse().ok()?;
+        let system_ticks: u64 = fields.get(12)?.parse().ok()?;
+        Some((user_ticks + system_ticks) as f64 / Self::CLOCK_TICKS_PER_SEC)
+    }
+
+    fn status_field(name: &str) -> Option<u64> {
+        let status = fs::read_to_string("/proc/self/status").ok()?;
+        let line = status.lines().find(|line| line.starts_with(name))?;
+        let kilobytes: u64 = line[name.len()..]
+            .trim()
+            .trim_end_matches("kB")
+            .trim()
+            .parse()
+            .ok()?;
+        Some(kilobytes * 1_024)
+    }
+
+    fn disk_write_bytes() -> Option<u64> {
+        let io = fs::read_to_string("/proc/self/io").ok()?;
+        let line = io.lines().find(|line| line.starts_with("write_bytes:"))?;
+        line["write_bytes:".len()..].trim().parse().ok()
+    }
+}
+
+#[derive(Debug, Clone, Copy, Default, Serialize, Deserialize)]
+struct LatencyPercentiles {
+    mean_ms: f64,
+    p50_ms: f64,
+    p90_ms: f64,
+    p99_ms: f64,
+    max_ms: f64,
+}
+
+impl LatencyPercentiles {
+    fn new(latencies: &mut [Duration]) -> Self {
+        if latencies.is_empty() {
+            return Self::default();
+        }
+
+        latencies.sort();
+        let millis = |duration: Duration| duration.as_secs_f64() * 1_000.0;
+        let percentile = |p: usize| millis(latencies[(latencies.len() - 1) * p / 100]);
+        let total: Duration = latencies.iter().sum();
+        Self {
+            mean_ms: millis(total) / latencies.len() as f64,
+            p50_ms: percentile(50),
+            p90_ms: percentile(90),
+            p99_ms: percentile(99),
+            max_ms: millis(latencies[latencies.len() - 1]),
+        }
+    }
+}
+
+/// Periodic sample of the benchmark state.
+#[derive(Debug, Clone, Serialize, Deserialize)]
+struct Sample {
+    elapsed_secs: f64,
+    target_tps: f64,
+    submitted: u64,
+    committed: u64,
+    height: u64,
+    resources: ResourceUsage,
+}
+
+/// Machine-readable results of a benchmark run.
+#[derive(Debug, Clone, Serialize, Deserialize)]
+struct Report {
+    nodes: u16,
+    duration_secs: f64,
+    submitted: u64,
+    committed: u64,
+    blocks: u64,
+    blocks_per_sec: f64,
+    committed_tps: f64,
+    latency: LatencyPercentiles,
+    resources: ResourceUsage,
+    /// Total size of the committed transactions in bytes.
+    committed_tx_bytes: u64,
+    /// Ratio of bytes written to the storage per node to the size of committed transactions.
+    /// Only available if nodes use `RocksDB`.
+    write_amplification: Option<f64>,
+    samples: Vec<Sample>,
+}
+
+impl Report {
+    /// Compares the report with a baseline, returning descriptions of found regressions.
+    fn regressions(&self, baseline: &Self, max_regression: f64) -> Vec<String> {
+        let mut regressions = vec![];
+        let allowed = 1.0 + max_regression / 100.0;
+        if self.committed_tps * allowed < baseline.committed_tps {
+            regressions.push(format!(
+                "throughput: {:.1} tps, baseline: {:.1} tps",
+                self.committed_tps, baseline.committed_tps
+            ));
+        }
+        if self.latency.p99_ms > baseline.latency.p99_ms * allowed {
+            regressions.push(format!(
+                "p99 latency: {:.1} ms, baseline: {:.1} ms",
+                self.latency.p99_ms, baseline.latency.p99_ms
+            ));
+        }
+        regressions
+    }
+}
+
+/// Tracks commits of the submitted transactions.
+#[derive(Debug, Default)]
+struct CommitTracker {
+    pending: HashMap<Hash, (Instant, usize)>,
+    latencies: Vec<Duration>,
+    committed_tx_bytes: u64,
+    checked_height: Height,
+}
+
+impl CommitTracker {
+    fn submit(&mut self, tx_hash: Hash, submit_time: Instant, tx_len: usize) {
+        self.pending.insert(tx_hash, (submit_time, tx_len));
+    }
+
+    /// Processes blocks committed since the last call.
+    fn update(&mut self, handle: &RunHandle) {
+        let snapshot = handle.blockchain().snapshot();
+        let schema = snapshot.for_core();
+        let now = Instant::now();
+        let next_height = schema.next_height();
+        while self.checked_height < next_height {
+            for tx_hash in schema.block_transactions(self.checked_height).iter() {
+                if let Some((submit_time, tx_len)) = self.pending.remove(&tx_hash) {
+                    self.latencies.push(now - submit_time);
+                    self.committed_tx_bytes += tx_len as u64;
+                }
+            }
+            self.checked_height.increment();
+        }
+    }
+
+    fn committed(&self) -> u64 {
+        self.latencies.len() as u64
+    }
+}
+
+fn create_databases(db_dir: Option<PathBuf>) -> impl FnMut(u16) -> Arc<dyn Database> {
+    move |i| match db_dir {
+        Some(ref db_dir) => {
+            let path = db_dir.join(format!("node-{}", i));
+            let db = RocksDB::open(&path, &DbOptions::default()).unwrap_or_else(|e| {
+                panic!("Cannot open database at {}: {}", path.display(), e);
+            });
+            Arc::new(db) as Arc<dyn Database>
+        }
+        None => Arc::new(TemporaryDB::new()) as Arc<dyn Database>,
+    }
+}
+
+fn print_sample(sample: &Sample, latency: &LatencyPercentiles) {
+    println!(
+        "[{:.0}s] target: {:.0} tps, submitted: {}, committed: {}, height: {}, \
+         p50: {:.1} ms, p99: {:.1} ms",
+        sample.elapsed_secs,
+        sample.target_tps,
+        sample.submitted,
+        sample.committed,
+        sample.height,
+        latency.p50_ms,
+        latency.p99_ms,
+    );
+}
+
+#[tokio::main]
+async fn main() -> anyhow::Result<()> {
+    /// Interval between checks of the load schedule and the committed blocks.
+    const TICK: Duration = Duration::from_millis(5);
+    /// Interval between samples of the benchmark state.
+    const SAMPLE_INTERVAL: Duration = Duration::from_secs(1);
+
+    exonum::crypto::init();
+    exonum::helpers::init_logger().ok();
+
+    let args = Args::from_args();
+    println!("Running benchmark with {:?}", args);
+
+    let baseline = match args.baseline {
+        Some(ref path) => Some(serde_json::from_slice::<Report>(&fs::read(path)?)?),
+        None => None,
+    };
+
+    let config = MainConfig {
+        generate_tx_in_after_commit: false,
+    };
+    let main_service = Spec::new(MainService).with_instance(
+        MainService::INSTANCE_ID,
+        MainService::INSTANCE_NAME,
+        config,
+    );
+    let uses_rocksdb = args.db_dir.is_some();
+    let nodes = NetworkBuilder::new(args.node_count, 2_000)
+        .init_node(|genesis, rt| main_service.clone().deploy(genesis, rt))
+        .with_database(create_databases(args.db_dir.clone()))
+        .build();
+
+    loop {
+        let height = nodes[0].blockchain().last_block().height;
+        if height > Height(0) {
+            break;
+        }
+        delay_for(Duration::from_millis(200)).await;
+    }
+    log::info!("Started sending transactions");
+
+    let profile = LoadProfile {
+        start_tps: args.tps,
+        end_tps: args.ramp_to.unwrap_or(args.tps),
+        duration: Duration::from_secs(args.duration),
+    };
+    let keys = KeyPair::random();
+    // Transactions are sent to the first node and their commitment is checked
+    // on the last one, so that the latency includes transaction propagation.
+    let sender = nodes[0].blockchain().sender().to_owned();
+    let observer = nodes.last().unwrap();
+
+    let initial_resources = ResourceUsage::current();
+    let initial_height = observer.blockchain().last_block().height;
+    let mut tracker = CommitTracker {
+        checked_height: initial_height.next(),
+        ..CommitTracker::default()
+    };
+    let mut samples = vec![];
+    let mut submitted = 0;
+    let start = Instant::now();
+    let mut next_sample_time = start + SAMPLE_INTERVAL;
+    let drain_deadline = start + profile.duration + Duration::from_secs(args.drain);
+
+    loop {
+        let now = Instant::now();
+        let elapsed = now - start;
+        if elapsed >= profile.duration && (tracker.pending.is_empty() || now >= drain_deadline) {
+            break;
+        }
+
+        let txs_due = profile.txs_due(elapsed);
+        while submitted < txs_due {
+            let tx = args.mix.create_tx(&keys, submitted);
+            let tx_len = tx.as_raw().to_bytes().len();
+            // The transaction is stamped with its scheduled time rather than the current one,
+            // so that delays of the benchmark loop are included into the measured latency.
+            let scheduled_time = (start + profile.scheduled_time(submitted)).min(now);
+            tracker.submit(tx.object_hash(), scheduled_time, tx_len);
+            sender.broadcast_transaction(tx).await?;
+            submitted += 1;
+        }
+        tracker.update(observer);
+
+        if now >= next_sample_time {
+            next_sample_time += SAMPLE_INTERVAL;
+            let sample = Sample {
+                elapsed_secs: elapsed.as_secs_f64(),
+                target_tps: if elapsed < profile.duration {
+                    profile.tps_at(elapsed)
+                } else {
+                    0.0
+                },
+                submitted,
+                committed: tracker.committed(),
+                height: observer.blockchain().last_block().height.0,
+                resources: ResourceUsage::current(),
+            };
+            let mut latencies = tracker.latencies.clone();
+            print_sample(&sample, &LatencyPercentiles::new(&mut latencies));
+            samples.push(sample);
+        }
+
+        delay_for(TICK).await;
+    }
+
+    let duration = start.elapsed();
+    let final_resources = ResourceUsage::current();
+    let blocks = observer.blockchain().last_block().height.0 - initial_height.0;
+    future::join_all(nodes.into_iter().map(RunHandle::join)).await;
+
+    let committed = tracker.committed();
+    let committed_tx_bytes = tracker.committed_tx_bytes;
+    let delta = |end: Option<u64>, start: Option<u64>| Some(end?.saturating_sub(start?));
+    let disk_write_bytes = delta(
+        final_resources.disk_write_bytes,
+        initial_resources.disk_write_bytes,
+    );
+    let write_amplification = match disk_write_bytes {
+        Some(bytes) if uses_rocksdb && committed_tx_bytes > 0 => {
+            let bytes_per_node = bytes as f64 / f64::from(args.node_count);
+            Some(bytes_per_node / committed_tx_bytes as f64)
+        }
+        _ => None,
+    };
+
+    let report = Report {
+        nodes: args.node_count,
+        duration_secs: duration.as_secs_f64(),
+        submitted,
+        committed,
+        blocks,
+        blocks_per_sec: blocks as f64 / duration.as_secs_f64(),
+        committed_tps: committed as f64 / duration.as_secs_f64(),
+        latency: LatencyPercentiles::new(&mut tracker.latencies),
+        resources: ResourceUsage {
+            cpu_secs: final_resources
+                .cpu_secs
+                .and_then(|end| Some(end - initial_resources.cpu_secs?)),
+            disk_write_bytes,
+            ..final_resources
+        },
+        committed_tx_bytes,
+        write_amplification,
+        samples,
+    };
+
+    println!("\nOverall results:");
+    println!(
+        "Transactions: {} submitted, {} committed ({:.1} tps)",
+        report.submitted, report.committed, report.committed_tps
+    );
+    println!(
+        "Blocks: {} ({:.2} blocks/sec)",
+        report.blocks, report.blocks_per_sec
+    );
+    println!(
+        "Latency: mean {:.1} ms, p50 {:.1} ms, p90 {:.1} ms, p99 {:.1} ms, max {:.1} ms",
+        report.latency.mean_ms,
+        report.latency.p50_ms,
+        report.latency.p90_ms,
+        report.latency.p99_ms,
+        report.latency.max_ms
+    );
+    println!("Resources: {:?}", report.resources);
+    if let Some(write_amplification) = report.write_amplification {
+        println!("Write amplification: {:.2}", write_amplification);
+    }
+
+    if let Some(ref path) = args.report {
+        fs::write(path, serde_json::to_string_pretty(&report)?)?;
+        println!("Report is written to {}", path.display());
+    }
+
+    if let Some(baseline) = baseline {
+        let regressions = report.regressions(&baseline, args.max_regression);
+        if !regressions.is_empty() {
+            println!("\nRegressions against the baseline:");
+            for regression in regressions {
+                println!("- {}", regression);
+            }
+            process::exit(1);
+        }
+        println!("No regressions against the baseline");
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn assert_scheduled_times(profile: LoadProfile) {
+        let total_txs = profile.txs_due(profile.duration);
+        assert!(total_txs > 0);
+        for index in 0..total_txs {
+            let scheduled_time = profile.scheduled_time(index);
+            assert_eq!(profile.txs_due(scheduled_time), index + 1, "{:?}", profile);
+        }
+    }
+
+    #[test]
+    fn scheduled_time_with_constant_load() {
+        assert_scheduled_times(LoadProfile {
+            start_tps: 100.0,
+            end_tps: 100.0,
+            duration: Duration::from_secs(10),
+        });
+    }
+
+    #[test]
+    fn scheduled_time_with_ramped_load() {
+        assert_scheduled_times(LoadProfile {
+            start_tps: 10.0,
+            end_tps: 1_000.0,
+            duration: Duration::from_secs(30),
+        });
+        assert_scheduled_times(LoadProfile {
+            start_tps: 0.0,
+            end_tps: 200.0,
+            duration: Duration::from_secs(5),
+        });
+        assert_scheduled_times(LoadProfile {
+            start_tps: 500.0,
+            end_tps: 50.0,
+            duration: Duration::from_secs(10),
+        });
+    }
+}
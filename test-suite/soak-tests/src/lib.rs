@@ -64,6 +64,7 @@ impl RunHandle {
 }
 
 type ManagerGen = Box<dyn Fn() -> Box<dyn ManagePool>>;
+type DatabaseGen<'a> = Box<dyn FnMut(u16) -> Arc<dyn Database> + 'a>;
 
 pub struct NetworkBuilder<'a> {
     count: u16,
@@ -71,6 +72,7 @@ pub struct NetworkBuilder<'a> {
     modify_cfg: Option<Box<dyn FnMut(&mut NodeConfig) + 'a>>,
     init_node: Option<Box<dyn FnMut(&mut GenesisConfigBuilder, &mut RustRuntimeBuilder) + 'a>>,
     pool_manager: Option<ManagerGen>,
+    database: Option<DatabaseGen<'a>>,
 }
 
 impl fmt::Debug for NetworkBuilder<'_> {
@@ -92,6 +94,7 @@ impl<'a> NetworkBuilder<'a> {
             modify_cfg: None,
             init_node: None,
             pool_manager: None,
+            database: None,
         }
     }
 
@@ -123,12 +126,22 @@ impl<'a> NetworkBuilder<'a> {
         self
     }
 
+    /// Customizes databases used by the nodes. The closure receives the zero-based index
+    /// of the node. By default, nodes use `TemporaryDB`.
+    pub fn with_database<F>(mut self, database: F) -> Self
+    where
+        F: FnMut(u16) -> Arc<dyn Database> + 'a,
+    {
+        self.database = Some(Box::new(database));
+        self
+    }
+
     /// Builds the network and returns handles for all nodes.
     pub fn build(mut self) -> Vec<RunHandle> {
         let mut node_handles = Vec::with_capacity(self.count as usize);
 
         let configs = generate_testnet_config(self.count, self.start_port);
-        for (mut node_cfg, node_keys) in configs {
+        for (i, (mut node_cfg, node_keys)) in configs.into_iter().enumerate() {
             if let Some(modify_cfg) = self.modify_cfg.as_mut() {
                 modify_cfg(&mut node_cfg);
             }
@@ -139,7 +152,10 @@ impl<'a> NetworkBuilder<'a> {
                 init_node(&mut genesis_cfg, &mut rt);
             }
 
-            let db = Arc::new(TemporaryDB::new()) as Arc<dyn Database>;
+            let db = match self.database.as_mut() {
+                Some(database) => database(i as u16),
+                None => Arc::new(TemporaryDB::new()) as Arc<dyn Database>,
+            };
             let mut node_builder = NodeBuilder::new(db, node_cfg, node_keys)
                 .with_genesis_config(genesis_cfg.build())
                 .with_runtime_fn(|channel| rt.build(channel.endpoints_sender()));
@@ -14,6 +14,7 @@
 
 use exonum::runtime::SUPERVISOR_INSTANCE_ID;
 use exonum::{
+    crypto::{self, Hash},
     helpers::Height,
     merkledb::{access::AccessExt, BinaryValue},
     runtime::{CommonError, ExecutionContext, ExecutionError, InstanceId},
@@ -27,6 +28,8 @@ pub trait MainServiceInterface<Ctx> {
     type Output;
 
     fn timestamp(&self, context: Ctx, height: Height) -> Self::Output;
+
+    fn store(&self, context: Ctx, data: Vec<u8>) -> Self::Output;
 }
 
 #[derive(Debug, Clone, Serialize, Deserialize, BinaryValue)]
@@ -53,6 +56,15 @@ impl MainServiceInterface<ExecutionContext<'_>> for MainService {
 
         Ok(())
     }
+
+    fn store(&self, context: ExecutionContext<'_>, data: Vec<u8>) -> Self::Output {
+        let data_hash = crypto::hash(&data);
+        context
+            .service_data()
+            .get_proof_map::<_, Hash, Vec<u8>>("data")
+            .put(&data_hash, data);
+        Ok(())
+    }
 }
 
 impl Service for MainService {
@@ -451,7 +451,21 @@ impl TestKit {
     /// testkit.rollback();
     /// ```
     pub fn rollback(&mut self) {
-        self.db_handler.rollback()
+        self.db_handler.rollback();
+        self.blockchain.reset_shared_snapshot();
+    }
+
+    /// Prunes transactions and precommits of old blocks, retaining the data only
+    /// for the specified number of the latest blocks, similar to a node with pruning enabled.
+    /// Returns the height of the earliest block with the retained data.
+    ///
+    /// See [`BlockchainMut::prune_history()`] for details.
+    ///
+    /// [`BlockchainMut::prune_history()`]: https://docs.rs/exonum/latest/exonum/blockchain/struct.BlockchainMut.html#method.prune_history
+    pub fn prune_history(&mut self, retained_blocks: u64) -> Height {
+        self.blockchain
+            .prune_history(retained_blocks)
+            .expect("Cannot prune blockchain history")
     }
 
     /// Creates a block with the specified transaction hashes.